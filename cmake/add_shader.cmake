@@ -1,13 +1,18 @@
 function(add_shader shader_files output_spv_names)
+    cmake_parse_arguments(SHADER "" "" "INCLUDE_DIRS;DEPENDS" ${ARGN})
     find_program(GLSLC "glslc")
     if (NOT GLSLC)
         message(FATAL_ERROR "glslc не найден. Убедитесь, что он установлен и доступен в PATH.")
     endif()
+    set(include_flags)
+    foreach(include_dir ${SHADER_INCLUDE_DIRS})
+        list(APPEND include_flags -I ${include_dir})
+    endforeach()
     set(spv_names)
     foreach(shader_file ${shader_files})
         add_custom_command(PRE_BUILD
-            COMMAND ${GLSLC} ${CMAKE_SOURCE_DIR}/${shader_file} -o ${CMAKE_SOURCE_DIR}/${shader_file}.spv
-            DEPENDS ${shader_file}
+            COMMAND ${GLSLC} ${include_flags} ${CMAKE_SOURCE_DIR}/${shader_file} -o ${CMAKE_SOURCE_DIR}/${shader_file}.spv
+            DEPENDS ${shader_file} ${SHADER_DEPENDS}
             OUTPUT ${shader_file}.spv
             COMMENT "Copmiling shader: ${shader_file} -> ${shader_file}.spv"
             VERBATIM
@@ -0,0 +1,15 @@
+function(cook_mesh mesh_files output_mesh_names)
+    set(mesh_names)
+    foreach(mesh_file ${mesh_files})
+        string(REGEX REPLACE "\\.[^.]*$" ".mesh" mesh_name ${mesh_file})
+        add_custom_command(
+            COMMAND vk_cooker mesh ${CMAKE_SOURCE_DIR}/${mesh_file} ${CMAKE_BINARY_DIR}/${mesh_name}
+            DEPENDS ${mesh_file} vk_cooker
+            OUTPUT ${CMAKE_BINARY_DIR}/${mesh_name}
+            COMMENT "Cooking mesh: ${mesh_file} -> ${mesh_name}"
+            VERBATIM
+        )
+        list(APPEND mesh_names ${CMAKE_BINARY_DIR}/${mesh_name})
+    endforeach()
+    set(${output_mesh_names} ${mesh_names} PARENT_SCOPE)
+endfunction()
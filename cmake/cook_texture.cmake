@@ -0,0 +1,15 @@
+function(cook_texture texture_files format output_texture_names)
+    set(texture_names)
+    foreach(texture_file ${texture_files})
+        string(REGEX REPLACE "\\.[^.]*$" ".ktx2" texture_name ${texture_file})
+        add_custom_command(
+            COMMAND vk_cooker texture ${CMAKE_SOURCE_DIR}/${texture_file} ${CMAKE_BINARY_DIR}/${texture_name} ${format}
+            DEPENDS ${texture_file} vk_cooker
+            OUTPUT ${CMAKE_BINARY_DIR}/${texture_name}
+            COMMENT "Cooking texture: ${texture_file} -> ${texture_name}"
+            VERBATIM
+        )
+        list(APPEND texture_names ${CMAKE_BINARY_DIR}/${texture_name})
+    endforeach()
+    set(${output_texture_names} ${texture_names} PARENT_SCOPE)
+endfunction()
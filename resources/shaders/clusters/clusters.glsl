@@ -0,0 +1,82 @@
+// Shared by the binning pass and the shading passes. CLUSTER_SET picks the descriptor set,
+// CLUSTER_ACCESS is writeonly for the binning pass and readonly everywhere else
+
+struct LocalLight
+{
+    vec3 position;
+    float range;
+    vec3 color;
+    float spotCosOuter; // -1 for point lights
+    vec3 direction;
+    float spotCosInner;
+};
+
+layout(set = CLUSTER_SET, binding = 0) uniform Clusters
+{
+    mat4 view;
+    mat4 invProj;
+    uvec4 grid;   // xyz - cluster counts, w - lights per cluster
+    vec4 screen;  // xy - render size in pixels, z - near plane, w - far plane
+    uint lightCount;
+} clusters;
+
+layout(std430, set = CLUSTER_SET, binding = 1) readonly buffer Lights
+{
+    LocalLight lights[];
+};
+
+layout(std430, set = CLUSTER_SET, binding = 2) CLUSTER_ACCESS buffer ClusterCounts
+{
+    uint clusterCounts[];
+};
+
+layout(std430, set = CLUSTER_SET, binding = 3) CLUSTER_ACCESS buffer ClusterIndices
+{
+    uint clusterIndices[];
+};
+
+// Depth slices are exponential so clusters stay roughly cubic in view space
+float clusterSliceDepth(uint slice)
+{
+    return clusters.screen.z * pow(clusters.screen.w / clusters.screen.z, float(slice) / float(clusters.grid.z));
+}
+
+uint clusterIndex(vec2 fragCoord, float viewDepth)
+{
+    uvec2 tile = min(uvec2(fragCoord / clusters.screen.xy * vec2(clusters.grid.xy)), clusters.grid.xy - 1u);
+    float slice = log(max(viewDepth, clusters.screen.z) / clusters.screen.z) / log(clusters.screen.w / clusters.screen.z) * float(clusters.grid.z);
+    uint z = min(uint(slice), clusters.grid.z - 1u);
+    return tile.x + tile.y * clusters.grid.x + z * clusters.grid.x * clusters.grid.y;
+}
+
+// Only the lights binned into the fragment's cluster are visited, not available to the binning pass itself
+#ifndef CLUSTER_BINNING
+vec3 shadeLocalLights(vec2 fragCoord, vec3 position, vec3 normal, vec3 viewDir, vec3 albedo, vec3 specularColor, float shininess)
+{
+    float viewDepth = -(clusters.view * vec4(position, 1.0)).z;
+    uint cluster = clusterIndex(fragCoord, viewDepth);
+    uint count = clusterCounts[cluster];
+
+    vec3 result = vec3(0.0);
+    for (uint i = 0; i < count; i++)
+    {
+        LocalLight local = lights[clusterIndices[cluster * clusters.grid.w + i]];
+        vec3 toLight = local.position - position;
+        float dist = length(toLight);
+        if (dist >= local.range)
+            continue;
+        vec3 lightDir = toLight / dist;
+
+        // Windowed inverse square falloff that reaches zero at the light's range
+        float window = clamp(1.0 - pow(dist / local.range, 4.0), 0.0, 1.0);
+        float attenuation = window * window / (dist * dist + 1.0);
+        if (local.spotCosOuter > -1.0)
+            attenuation *= smoothstep(local.spotCosOuter, local.spotCosInner, dot(-lightDir, local.direction));
+
+        float diff = max(dot(normal, lightDir), 0.0);
+        float spec = pow(max(dot(normal, normalize(lightDir + viewDir)), 0.0), shininess);
+        result += local.color * attenuation * (albedo * diff + specularColor * spec);
+    }
+    return result;
+}
+#endif
\ No newline at end of file
@@ -6,15 +6,112 @@ layout(set = 1, binding = 0) uniform Global
 {
     float gamma;
     float exposure;
+    uint upscale;
+    vec4 viewport; // xy - scene size in pixels, zw - 1 / scene texture size
 } global;
 
 layout(location = 0) in vec2 fragTexCoord;
 
 layout(location = 0) out vec4 outColor;
 
+float luma(vec3 color)
+{
+    return dot(color, vec3(0.299, 0.587, 0.114));
+}
+
+vec3 fetchScene(vec2 pixel)
+{
+    pixel = clamp(pixel, vec2(0.5), global.viewport.xy - 0.5);
+    return texture(frameTexture, pixel * global.viewport.zw).rgb;
+}
+
+// Polynomial approximation of the lanczos2 window
+float lanczos2(float d2, float lobe)
+{
+    float wb = (2.0 / 5.0) * d2 - 1.0;
+    float wa = lobe * d2 - 1.0;
+    wb *= wb;
+    wa *= wa;
+    return (25.0 / 16.0 * wb - (25.0 / 16.0 - 1.0)) * wa;
+}
+
+void accumulate(inout vec3 color, inout float weight, vec3 tap, vec2 offset, vec2 dir, float stretch, float lobe, float clip)
+{
+    vec2 v = vec2(dot(offset, dir), dot(offset, vec2(-dir.y, dir.x)) * stretch);
+    float w = lanczos2(min(dot(v, v), clip), lobe);
+    color += tap * w;
+    weight += w;
+}
+
+// Edge adaptive upscale: a 12 tap lanczos kernel that is stretched along
+// the local edge direction, clamped to the nearest 2x2 texels to avoid ringing
+vec3 upscale(vec2 uv)
+{
+    vec2 pixel = uv * global.viewport.xy;
+    vec2 base = floor(pixel - 0.5) + 0.5;
+    vec2 f = pixel - base;
+
+    //    b c
+    //  e f g h
+    //  i j k l
+    //    n o
+    vec3 b = fetchScene(base + vec2( 0.0, -1.0));
+    vec3 c = fetchScene(base + vec2( 1.0, -1.0));
+    vec3 e = fetchScene(base + vec2(-1.0,  0.0));
+    vec3 F = fetchScene(base);
+    vec3 g = fetchScene(base + vec2( 1.0,  0.0));
+    vec3 h = fetchScene(base + vec2( 2.0,  0.0));
+    vec3 i = fetchScene(base + vec2(-1.0,  1.0));
+    vec3 j = fetchScene(base + vec2( 0.0,  1.0));
+    vec3 k = fetchScene(base + vec2( 1.0,  1.0));
+    vec3 l = fetchScene(base + vec2( 2.0,  1.0));
+    vec3 n = fetchScene(base + vec2( 0.0,  2.0));
+    vec3 o = fetchScene(base + vec2( 1.0,  2.0));
+
+    float lb = luma(b), lc = luma(c), le = luma(e), lf = luma(F), lg = luma(g), lh = luma(h);
+    float li = luma(i), lj = luma(j), lk = luma(k), ll = luma(l), ln = luma(n), lo = luma(o);
+
+    vec4 bilinear = vec4((1.0 - f.x) * (1.0 - f.y), f.x * (1.0 - f.y), (1.0 - f.x) * f.y, f.x * f.y);
+    vec2 dir = vec2(0.0);
+    dir += vec2(lg - le, lj - lb) * bilinear.x;
+    dir += vec2(lh - lf, lk - lc) * bilinear.y;
+    dir += vec2(lk - li, ln - lf) * bilinear.z;
+    dir += vec2(ll - lj, lo - lg) * bilinear.w;
+
+    float minLuma = min(min(lf, lg), min(lj, lk));
+    float maxLuma = max(max(lf, lg), max(lj, lk));
+    float dirLength = length(dir);
+    float edge = clamp(dirLength / (maxLuma - minLuma + 1.0 / 64.0) * 0.5, 0.0, 1.0);
+    edge *= edge;
+    dir = dirLength > 1.0 / 1024.0 ? dir / dirLength : vec2(1.0, 0.0);
+
+    float stretch = 1.0 - 0.5 * edge;
+    float lobe = 0.5 - 0.29 * edge;
+    float clip = 1.0 / lobe;
+
+    vec3 color = vec3(0.0);
+    float weight = 0.0;
+    accumulate(color, weight, b, vec2( 0.0, -1.0) - f, dir, stretch, lobe, clip);
+    accumulate(color, weight, c, vec2( 1.0, -1.0) - f, dir, stretch, lobe, clip);
+    accumulate(color, weight, e, vec2(-1.0,  0.0) - f, dir, stretch, lobe, clip);
+    accumulate(color, weight, F, vec2( 0.0,  0.0) - f, dir, stretch, lobe, clip);
+    accumulate(color, weight, g, vec2( 1.0,  0.0) - f, dir, stretch, lobe, clip);
+    accumulate(color, weight, h, vec2( 2.0,  0.0) - f, dir, stretch, lobe, clip);
+    accumulate(color, weight, i, vec2(-1.0,  1.0) - f, dir, stretch, lobe, clip);
+    accumulate(color, weight, j, vec2( 0.0,  1.0) - f, dir, stretch, lobe, clip);
+    accumulate(color, weight, k, vec2( 1.0,  1.0) - f, dir, stretch, lobe, clip);
+    accumulate(color, weight, l, vec2( 2.0,  1.0) - f, dir, stretch, lobe, clip);
+    accumulate(color, weight, n, vec2( 0.0,  2.0) - f, dir, stretch, lobe, clip);
+    accumulate(color, weight, o, vec2( 1.0,  2.0) - f, dir, stretch, lobe, clip);
+
+    vec3 minColor = min(min(F, g), min(j, k));
+    vec3 maxColor = max(max(F, g), max(j, k));
+    return clamp(color / max(weight, 1.0 / 64.0), minColor, maxColor);
+}
+
 void main()
 {
-    vec4 color = texture(frameTexture, fragTexCoord);
-    vec3 mapped = vec3(1.0) - exp(-color.rgb * global.exposure);
-    outColor = vec4(pow(mapped, vec3(1.0 / global.gamma)), color.a);
+    vec3 color = global.upscale != 0 ? upscale(fragTexCoord) : fetchScene(fragTexCoord * global.viewport.xy);
+    vec3 mapped = vec3(1.0) - exp(-color * global.exposure);
+    outColor = vec4(pow(mapped, vec3(1.0 / global.gamma)), 1.0);
 }
@@ -0,0 +1,39 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "common/octahedral.glsl"
+
+layout(set = 2, binding = 0) uniform Material 
+{
+	vec3 ambient;
+	vec3 diffuse;
+	vec3 specular;
+	vec3 color;
+	float shininess;
+} material;
+
+layout(set = 3, binding = 0) uniform sampler2D diffuseMap;
+layout(set = 4, binding = 0) uniform sampler2D specularMap;
+
+layout(set = 8, binding = 0) uniform Temporal {
+    mat4 viewProj;
+    mat4 prevViewProj;
+    float mipBias;
+} temporal;
+
+layout(location = 0) in vec4 fragPosition;
+layout(location = 2) in vec3 fragNormal;
+layout(location = 3) in vec2 fragTexCoord;
+layout(location = 4) in vec4 fragCurrentClip;
+layout(location = 5) in vec4 fragPrevClip;
+
+layout(location = 0) out vec4 outAlbedo; // rgb - albedo, a - specular intensity
+layout(location = 1) out vec4 outNormal; // rg - octahedral normal, b - shininess / 128
+layout(location = 2) out vec2 outMotion;
+
+void main()
+{
+    outAlbedo = vec4(texture(diffuseMap, fragTexCoord, temporal.mipBias).rgb, texture(specularMap, fragTexCoord, temporal.mipBias).r);
+    outNormal = vec4(octEncode(normalize(fragNormal)) * 0.5 + 0.5, clamp(material.shininess / 128.0, 0.0, 1.0), 0.0);
+    outMotion = (fragCurrentClip.xy / fragCurrentClip.w - fragPrevClip.xy / fragPrevClip.w) * 0.5;
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+#define CLUSTER_SET 9
+#define CLUSTER_ACCESS readonly
+#include "clusters/clusters.glsl"
+#include "common/octahedral.glsl"
+#include "common/shadow.glsl"
+
+layout(set = 0, binding = 0) uniform sampler2D albedoTexture;
+layout(set = 1, binding = 0) uniform sampler2D normalTexture;
+layout(set = 2, binding = 0) uniform sampler2D motionTexture;
+layout(set = 3, binding = 0) uniform sampler2D depthTexture;
+
+layout(set = 4, binding = 0) uniform Light
+{
+    vec3 direction;
+    vec3 viewPosition;
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+} light;
+
+layout(set = 5, binding = 0) uniform LigthSpace
+{
+	mat4 space;
+} lightSpace;
+
+layout(set = 6, binding = 0) uniform sampler2D shadowMap;
+layout(set = 7, binding = 0) uniform samplerCube skybox;
+
+layout(set = 8, binding = 0) uniform DeferredParams
+{
+    mat4 invViewProj; // jittered, the depth buffer was rasterized with it
+    vec4 viewport;    // xy - render size in pixels
+} params;
+
+layout(location = 0) out vec4 outColor0;
+layout(location = 1) out vec2 outMotion;
+
+void main()
+{
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(depthTexture, texel, 0).r;
+    // Background pixels keep the skybox drawn underneath
+    if (depth >= 1.0)
+        discard;
+
+    vec4 albedoSpecular = texelFetch(albedoTexture, texel, 0);
+    vec4 normalShininess = texelFetch(normalTexture, texel, 0);
+    vec3 albedo = albedoSpecular.rgb;
+    vec3 specularColor = vec3(albedoSpecular.a);
+    vec3 norm = octDecode(normalShininess.xy * 2.0 - 1.0);
+    float shininess = max(normalShininess.z * 128.0, 0.5);
+
+    vec4 clip = params.invViewProj * vec4(gl_FragCoord.xy / params.viewport.xy * 2.0 - 1.0, depth, 1.0);
+    vec4 fragPosition = vec4(clip.xyz / clip.w, 1.0);
+
+    // Same terms as the forward path, fed from the g-buffer
+    vec3 ambient = light.ambient * albedo;
+
+    vec3 lightDir = normalize(-light.direction);
+    float diff = max(dot(norm, lightDir), 0.0);
+    vec3 diffuse = light.diffuse * diff * albedo;
+
+    vec3 I = normalize(vec3(fragPosition) - light.viewPosition);
+    vec3 R = reflect(I, norm);
+    vec3 env = texture(skybox, R).rgb;
+
+    vec3 viewDir = normalize(light.viewPosition - vec3(fragPosition));
+    vec3 reflectDir = reflect(-lightDir, norm);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+    vec3 specular = env * spec * specularColor;
+
+    float shadow = ShadowCalculation(shadowMap, lightSpace.space * fragPosition);
+    if (shadow == 1.0) {specular = vec3(1.0);}
+    vec4 result = vec4((ambient + (1.0 - shadow) * (diffuse + specular * (1.0 - shadow))), 1.0);
+    result.rgb += shadeLocalLights(gl_FragCoord.xy, vec3(fragPosition), norm, viewDir, albedo, specularColor, shininess);
+
+    outColor0 = result;
+    outMotion = texelFetch(motionTexture, texel, 0).rg;
+    gl_FragDepth = depth;
+}
\ No newline at end of file
@@ -1,4 +1,7 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "vertex.glsl"
 
 layout(set = 0, binding = 0) uniform MVP {
     mat4 model;
@@ -6,13 +9,7 @@ layout(set = 0, binding = 0) uniform MVP {
     mat4 proj;
 } mvp;
 
-layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inColor;
-layout(location = 2) in vec3 inNormal;
-layout(location = 3) in vec2 inTexCoord;
-
-
 void main()
 {
-    gl_Position = mvp.proj * mvp.view * mvp.model * vec4(inPosition, 1.0);
+    gl_Position = mvp.proj * mvp.view * mvp.model * vec4(decodePosition(), 1.0);
 }
\ No newline at end of file
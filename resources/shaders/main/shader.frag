@@ -1,6 +1,12 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
 //?#extension GL_KHR_vulkan_glsl: enable
 
+#define CLUSTER_SET 9
+#define CLUSTER_ACCESS readonly
+#include "clusters/clusters.glsl"
+#include "common/shadow.glsl"
+
 layout(set = 1, binding = 0) uniform Light
 {
     vec3 direction;
@@ -28,50 +34,35 @@ layout(set = 3, binding = 0) uniform sampler2D diffuseMap;
 layout(set = 4, binding = 0) uniform sampler2D specularMap;
 layout(set = 5, binding = 0) uniform sampler2D shadowMap;
 layout(set = 7, binding = 0) uniform samplerCube skybox;
+layout(set = 8, binding = 0) uniform Temporal {
+    mat4 viewProj;
+    mat4 prevViewProj;
+    float mipBias;
+} temporal;
 
 layout(location = 0) in vec4 fragPosition;
-layout(location = 1) in vec3 fragColor;
 layout(location = 2) in vec3 fragNormal;
 layout(location = 3) in vec2 fragTexCoord;
+layout(location = 4) in vec4 fragCurrentClip;
+layout(location = 5) in vec4 fragPrevClip;
 
 layout(location = 0) out vec4 outColor0;
-//layout(location = 1) out vec4 outColor1;
+layout(location = 1) out vec2 outMotion;
  
-float ShadowCalculation(vec4 fragPosLightSpace)
-{
-    vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
-    projCoords = vec3(projCoords.xy * 0.5 + 0.5, projCoords.z);
-    if(projCoords.z > 1.0)
-        return 0.0;
-
-    float closestDepth = texture(shadowMap, projCoords.xy).r; 
-    float currentDepth = projCoords.z;
-    float shadow = currentDepth - 0.005 > closestDepth ? 1.0 : 0.0;
-
-    vec2 texelSize = 1.0 / textureSize(shadowMap, 0);
-    for(int x = -1; x <= 1; ++x)
-    {
-        for(int y = -1; y <= 1; ++y)
-        {
-            float pcfDepth = texture(shadowMap, projCoords.xy + vec2(x, y) * texelSize).r; 
-            shadow += currentDepth > pcfDepth ? 1.0 : 0.0;        
-        }    
-    }
-    shadow /= 9.0;
-
-    return shadow;
-}
-
 void main()
 {
+    // Materials are sampled for the output resolution, the temporal resolve brings their detail back
+    vec3 albedo = texture(diffuseMap, fragTexCoord, temporal.mipBias).rgb;
+    vec3 specularMask = texture(specularMap, fragTexCoord, temporal.mipBias).rgb;
+
     // ambient
-    vec3 ambient = light.ambient * vec3(texture(diffuseMap, fragTexCoord));
+    vec3 ambient = light.ambient * albedo;
 
     // diffuse
     vec3 norm = fragNormal;
     vec3 lightDir = normalize(-light.direction);
     float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = light.diffuse * diff * texture(diffuseMap, fragTexCoord).rgb;
+    vec3 diffuse = light.diffuse * diff * albedo;
     
     // skybox
     vec3 I = normalize(vec3(fragPosition) - light.viewPosition);
@@ -82,13 +73,15 @@ void main()
     vec3 viewDir = normalize(light.viewPosition - vec3(fragPosition));
     vec3 reflectDir = reflect(-lightDir, norm);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    vec3 specular = env * spec * vec3(texture(specularMap, fragTexCoord));  
+    vec3 specular = env * spec * specularMask;  
 
     // result
-    float shadow = ShadowCalculation(lightSpace.space * fragPosition);
+    float shadow = ShadowCalculation(shadowMap, lightSpace.space * fragPosition);
     if (shadow == 1.0) {specular = vec3(1.0);}
     vec4 result = vec4((ambient + (1.0 - shadow) * (diffuse + specular * (1.0 - shadow))), 1.0);
+    result.rgb += shadeLocalLights(gl_FragCoord.xy, vec3(fragPosition), normalize(norm), viewDir, albedo, specularMask, material.shininess);
     
     outColor0 = result;
+    outMotion = (fragCurrentClip.xy / fragCurrentClip.w - fragPrevClip.xy / fragPrevClip.w) * 0.5;
     //outColor0 = vec4(texture(skybox, R).rgb, 1.0);
 }
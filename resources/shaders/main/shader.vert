@@ -1,25 +1,32 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "vertex.glsl"
 
 layout(set = 0, binding = 0) uniform UniformBufferObject {
     mat4 model;
     mat4 view;
     mat4 proj;
+    mat4 prevModel;
 } ubo;
 
-layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inColor;
-layout(location = 2) in vec3 inNormal;
-layout(location = 3) in vec2 inTexCoord;
+layout(set = 8, binding = 0) uniform Temporal {
+    mat4 viewProj;
+    mat4 prevViewProj;
+} temporal;
 
 layout(location = 0) out vec4 fragPosition;
-layout(location = 1) out vec3 fragColor;
 layout(location = 2) out vec3 fragNormal;
 layout(location = 3) out vec2 fragTexCoord;
+layout(location = 4) out vec4 fragCurrentClip;
+layout(location = 5) out vec4 fragPrevClip;
 
 void main() {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
-    fragPosition = ubo.model * vec4(inPosition, 1.0);
-    fragColor = inColor;
-    fragNormal = inNormal;
-    fragTexCoord = inTexCoord;
+    vec4 position = vec4(decodePosition(), 1.0);
+    gl_Position = ubo.proj * ubo.view * ubo.model * position;
+    fragPosition = ubo.model * position;
+    fragNormal = decodeNormal();
+    fragTexCoord = decodeTexCoord();
+    fragCurrentClip = temporal.viewProj * fragPosition;
+    fragPrevClip = temporal.prevViewProj * ubo.prevModel * position;
 }
\ No newline at end of file
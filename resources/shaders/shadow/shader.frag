@@ -1,9 +1,4 @@
 #version 450
 //?#extension GL_KHR_vulkan_glsl: enable
 
-layout(location = 0) in vec3 fragPosition;
-layout(location = 1) in vec3 fragColor;
-layout(location = 2) in vec3 fragNormal;
-layout(location = 3) in vec2 fragTexCoord;
-
-void main() {}
+void main() {}
\ No newline at end of file
@@ -1,4 +1,8 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
+
+#define VERTEX_POSITION_ONLY
+#include "vertex.glsl"
 
 layout(set = 0, binding = 0) uniform MVP {
     mat4 model;
@@ -6,20 +10,6 @@ layout(set = 0, binding = 0) uniform MVP {
     mat4 proj;
 } mvp;
 
-layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inColor;
-layout(location = 2) in vec3 inNormal;
-layout(location = 3) in vec2 inTexCoord;
-
-layout(location = 0) out vec3 fragPosition;
-layout(location = 1) out vec3 fragColor;
-layout(location = 2) out vec3 fragNormal;
-layout(location = 3) out vec2 fragTexCoord;
-
 void main() {
-    gl_Position = mvp.proj * mvp.view * mvp.model * vec4(inPosition, 1.0);
-    fragPosition = inPosition;
-    fragColor = inColor;
-    fragNormal = inNormal;
-    fragTexCoord = inTexCoord;
+    gl_Position = mvp.proj * mvp.view * mvp.model * vec4(decodePosition(), 1.0);
 }
\ No newline at end of file
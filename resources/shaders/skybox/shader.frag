@@ -4,10 +4,14 @@
 layout(set = 1, binding = 0) uniform samplerCube skybox;
 
 layout(location = 0) in vec4 fragPosition;
+layout(location = 1) in vec4 fragCurrentClip;
+layout(location = 2) in vec4 fragPrevClip;
 
 layout(location = 0) out vec4 outColor0;
+layout(location = 1) out vec2 outMotion;
 
 void main()
 {
     outColor0 = vec4(texture(skybox, fragPosition.xyz).rgb, 1.0);
+    outMotion = (fragCurrentClip.xy / fragCurrentClip.w - fragPrevClip.xy / fragPrevClip.w) * 0.5;
 }
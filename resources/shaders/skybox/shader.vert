@@ -1,4 +1,7 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "vertex.glsl"
 
 layout(set = 0, binding = 0) uniform UniformBufferObject {
     mat4 model;
@@ -6,15 +9,21 @@ layout(set = 0, binding = 0) uniform UniformBufferObject {
     mat4 proj;
 } ubo;
 
-layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inColor;
-layout(location = 2) in vec3 inNormal;
-layout(location = 3) in vec2 inTexCoord;
+layout(set = 2, binding = 0) uniform Temporal {
+    mat4 viewProj;
+    mat4 prevViewProj;
+} temporal;
 
 layout(location = 0) out vec4 fragPosition;
+layout(location = 1) out vec4 fragCurrentClip;
+layout(location = 2) out vec4 fragPrevClip;
 
 void main() {
-    vec4 pos = ubo.proj * ubo.view * vec4(inPosition, 1.0);
+    vec3 position = (ubo.model * vec4(decodePosition(), 1.0)).xyz;
+    vec4 pos = ubo.proj * ubo.view * vec4(position, 1.0);
     gl_Position = pos;
-    fragPosition = vec4(inPosition, 1.0);
+    fragPosition = vec4(position, 1.0);
+    // Directions have w = 0, so only the camera rotation contributes to the sky motion
+    fragCurrentClip = temporal.viewProj * vec4(position, 0.0);
+    fragPrevClip = temporal.prevViewProj * vec4(position, 0.0);
 }
\ No newline at end of file
@@ -0,0 +1,134 @@
+#version 450
+//?#extension GL_KHR_vulkan_glsl: enable
+
+layout(set = 0, binding = 0) uniform sampler2D sceneTexture;
+layout(set = 1, binding = 0) uniform sampler2D motionTexture;
+layout(set = 2, binding = 0) uniform sampler2D depthTexture;
+layout(set = 3, binding = 0) uniform sampler2D historyTexture;
+layout(set = 4, binding = 0) uniform TemporalResolve
+{
+    vec4 sceneViewport;   // xy - scene size in pixels, zw - 1 / scene texture size
+    vec4 historyViewport; // xy - output size in pixels, zw - 1 / history texture size
+    vec2 jitter;          // subpixel offset of the current frame in scene pixels
+    float blend;
+    uint reset;
+} resolve;
+
+layout(location = 0) in vec2 fragTexCoord;
+
+layout(location = 0) out vec4 outColor;
+
+vec3 toYCoCg(vec3 color)
+{
+    return vec3(
+         0.25 * color.r + 0.5 * color.g + 0.25 * color.b,
+         0.5  * color.r                 - 0.5  * color.b,
+        -0.25 * color.r + 0.5 * color.g - 0.25 * color.b);
+}
+
+vec3 toRgb(vec3 color)
+{
+    return vec3(color.x + color.y - color.z, color.x + color.z, color.x - color.y - color.z);
+}
+
+ivec2 clampTexel(ivec2 texel)
+{
+    return clamp(texel, ivec2(0), ivec2(resolve.sceneViewport.xy) - 1);
+}
+
+// Tonemapped weights keep single bright samples from dominating the filters
+float lumaWeight(vec3 color)
+{
+    return 1.0 / (1.0 + color.x);
+}
+
+vec3 sampleHistory(vec2 uv)
+{
+    // 5 tap Catmull-Rom, the corner taps of the 4x4 kernel contribute too little to be worth fetching
+    vec2 size = resolve.historyViewport.xy;
+    vec2 position = uv * size;
+    vec2 center = floor(position - 0.5) + 0.5;
+    vec2 f = position - center;
+
+    vec2 w0 = f * (-0.5 + f * (1.0 - 0.5 * f));
+    vec2 w1 = 1.0 + f * f * (-2.5 + 1.5 * f);
+    vec2 w2 = f * (0.5 + f * (2.0 - 1.5 * f));
+    vec2 w3 = f * f * (-0.5 + 0.5 * f);
+    vec2 w12 = w1 + w2;
+
+    vec2 tc0 = clamp(center - 1.0, vec2(0.5), size - 0.5) * resolve.historyViewport.zw;
+    vec2 tc12 = clamp(center + w2 / w12, vec2(0.5), size - 0.5) * resolve.historyViewport.zw;
+    vec2 tc3 = clamp(center + 2.0, vec2(0.5), size - 0.5) * resolve.historyViewport.zw;
+
+    vec4 color = vec4(0.0);
+    color += vec4(texture(historyTexture, vec2(tc12.x, tc0.y)).rgb, 1.0) * (w12.x * w0.y);
+    color += vec4(texture(historyTexture, vec2(tc0.x, tc12.y)).rgb, 1.0) * (w0.x * w12.y);
+    color += vec4(texture(historyTexture, vec2(tc12.x, tc12.y)).rgb, 1.0) * (w12.x * w12.y);
+    color += vec4(texture(historyTexture, vec2(tc3.x, tc12.y)).rgb, 1.0) * (w3.x * w12.y);
+    color += vec4(texture(historyTexture, vec2(tc12.x, tc3.y)).rgb, 1.0) * (w12.x * w3.y);
+    return max(color.rgb / color.a, vec3(0.0));
+}
+
+vec3 clipToBox(vec3 history, vec3 center, vec3 extents)
+{
+    vec3 offset = history - center;
+    vec3 units = abs(offset / max(extents, vec3(1.0 / 1024.0)));
+    float maxUnit = max(units.x, max(units.y, units.z));
+    return maxUnit > 1.0 ? center + offset / maxUnit : history;
+}
+
+void main()
+{
+    vec2 position = fragTexCoord * resolve.sceneViewport.xy;
+    ivec2 base = ivec2(floor(position));
+
+    // Reconstruct the current frame at the output pixel from the jittered 3x3 neighbourhood,
+    // gathering color moments and the closest depth for the motion vector on the way
+    vec3 color = vec3(0.0);
+    float weight = 0.0;
+    vec3 m1 = vec3(0.0);
+    vec3 m2 = vec3(0.0);
+    float closestDepth = 1.0;
+    ivec2 closestTexel = clampTexel(base);
+    for (int y = -1; y <= 1; y++)
+    {
+        for (int x = -1; x <= 1; x++)
+        {
+            ivec2 texel = clampTexel(base + ivec2(x, y));
+            vec3 tap = toYCoCg(texelFetch(sceneTexture, texel, 0).rgb);
+            vec2 offset = vec2(base + ivec2(x, y)) + 0.5 - resolve.jitter - position;
+            float w = exp(-2.29 * dot(offset, offset)) * lumaWeight(tap);
+            color += tap * w;
+            weight += w;
+            m1 += tap;
+            m2 += tap * tap;
+
+            float depth = texelFetch(depthTexture, texel, 0).r;
+            if (depth < closestDepth)
+            {
+                closestDepth = depth;
+                closestTexel = texel;
+            }
+        }
+    }
+    color /= max(weight, 1.0 / 1024.0);
+
+    vec2 motion = texelFetch(motionTexture, closestTexel, 0).rg;
+    vec2 historyUv = fragTexCoord - motion;
+    if (resolve.reset != 0 || any(lessThan(historyUv, vec2(0.0))) || any(greaterThan(historyUv, vec2(1.0))))
+    {
+        outColor = vec4(toRgb(color), 1.0);
+        return;
+    }
+
+    vec3 mean = m1 / 9.0;
+    vec3 sigma = sqrt(max(m2 / 9.0 - mean * mean, vec3(0.0)));
+    vec3 history = toYCoCg(sampleHistory(historyUv));
+    history = clipToBox(history, mean, sigma * 1.25);
+
+    // Blend in a tonemapped space to suppress flickering of bright subpixel details
+    float currentWeight = resolve.blend * lumaWeight(color);
+    float historyWeight = (1.0 - resolve.blend) * lumaWeight(history);
+    vec3 result = (color * currentWeight + history * historyWeight) / (currentWeight + historyWeight);
+    outColor = vec4(max(toRgb(result), vec3(0.0)), 1.0);
+}
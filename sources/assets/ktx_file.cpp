@@ -0,0 +1,197 @@
+#include "assets/ktx_file.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+static_assert(sizeof(KtxHeader) == 80);
+static_assert(sizeof(KtxLevel) == 24);
+
+static const uint8_t IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+enum DfdModel : uint32_t { RGBSDA = 1, BC1A = 128, BC5 = 132, BC7 = 134 };
+enum DfdTransfer : uint32_t { Linear = 1, Srgb = 2 };
+
+struct DfdSample
+{
+	uint32_t channel;
+	uint32_t bitOffset;
+	uint32_t bitLength;
+	uint32_t upper;
+};
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+static bool isSrgb(VkFormat format)
+{
+	return format == VK_FORMAT_BC1_RGB_SRGB_BLOCK || format == VK_FORMAT_BC7_SRGB_BLOCK || format == VK_FORMAT_R8G8B8A8_SRGB;
+}
+
+// Basic data format descriptor, required by the spec even though the loader only looks at vkFormat
+static std::vector<uint32_t> createDfd(VkFormat format)
+{
+	auto model = uint32_t{};
+	auto blockSize = KtxFile::getBlockSize(format);
+	auto compressed = format != VK_FORMAT_R8G8B8A8_SRGB && format != VK_FORMAT_R8G8B8A8_UNORM;
+	auto samples = std::vector<DfdSample>{};
+	switch (format)
+	{
+	case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+		model = BC1A;
+		samples = { { 0, 0, 64, UINT32_MAX } };
+		break;
+	case VK_FORMAT_BC5_UNORM_BLOCK:
+		model = BC5;
+		samples = { { 0, 0, 64, UINT32_MAX }, { 1, 64, 64, UINT32_MAX } };
+		break;
+	case VK_FORMAT_BC7_UNORM_BLOCK:
+	case VK_FORMAT_BC7_SRGB_BLOCK:
+		model = BC7;
+		samples = { { 0, 0, 128, UINT32_MAX } };
+		break;
+	default:
+		model = RGBSDA;
+		// Alpha is never sRGB encoded, mark it linear
+		samples = { { 0, 0, 8, 255 }, { 1, 8, 8, 255 }, { 2, 16, 8, 255 }, { 15 | (isSrgb(format) ? 0x10u : 0u), 24, 8, 255 } };
+		break;
+	}
+
+	auto blockWords = 6 + 4 * static_cast<uint32_t>(samples.size());
+	auto dfd = std::vector<uint32_t>{};
+	dfd.push_back((1 + blockWords) * 4);
+	dfd.push_back(0);
+	dfd.push_back(2 | (blockWords * 4) << 16);
+	dfd.push_back(model | 1 << 8 | (isSrgb(format) ? Srgb : Linear) << 16);
+	dfd.push_back(compressed ? 3 | 3 << 8 : 0);
+	dfd.push_back(blockSize);
+	dfd.push_back(0);
+	for (auto& sample : samples)
+	{
+		dfd.push_back(sample.bitOffset | (sample.bitLength - 1) << 16 | sample.channel << 24);
+		dfd.push_back(0);
+		dfd.push_back(0);
+		dfd.push_back(sample.upper);
+	}
+	return dfd;
+}
+
+uint32_t KtxFile::getBlockSize(VkFormat format)
+{
+	switch (format)
+	{
+	case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+		return 8;
+	case VK_FORMAT_BC5_UNORM_BLOCK:
+	case VK_FORMAT_BC7_UNORM_BLOCK:
+	case VK_FORMAT_BC7_SRGB_BLOCK:
+		return 16;
+	case VK_FORMAT_R8G8B8A8_UNORM:
+	case VK_FORMAT_R8G8B8A8_SRGB:
+		return 4;
+	default:
+		throw std::runtime_error{ "unsupported ktx format" };
+	}
+}
+
+void KtxFile::write(const std::string& path, const TextureData& data)
+{
+	auto levelCount = static_cast<uint32_t>(data.levels.size());
+	auto dfd = createDfd(data.format);
+
+	auto header = KtxHeader{};
+	memcpy(header.identifier, IDENTIFIER, sizeof(IDENTIFIER));
+	header.vkFormat = data.format;
+	header.typeSize = 1;
+	header.pixelWidth = data.width;
+	header.pixelHeight = data.height;
+	header.faceCount = 1;
+	header.levelCount = levelCount;
+	header.dfdByteOffset = static_cast<uint32_t>(sizeof(KtxHeader) + sizeof(KtxLevel) * levelCount);
+	header.dfdByteLength = static_cast<uint32_t>(dfd.size() * sizeof(uint32_t));
+
+	// Mip data is stored smallest level first, as the spec requires
+	auto levels = std::vector<KtxLevel>(levelCount);
+	auto offset = uint64_t{ header.dfdByteOffset + header.dfdByteLength };
+	for (auto i = levelCount; i-- > 0;)
+	{
+		offset = alignUp(offset, 16);
+		levels[i].byteOffset = offset;
+		levels[i].byteLength = data.levels[i].size();
+		levels[i].uncompressedByteLength = data.levels[i].size();
+		offset += data.levels[i].size();
+	}
+
+	auto blob = std::string(offset, '\0');
+	memcpy(blob.data(), &header, sizeof(header));
+	memcpy(blob.data() + sizeof(header), levels.data(), sizeof(KtxLevel) * levels.size());
+	memcpy(blob.data() + header.dfdByteOffset, dfd.data(), header.dfdByteLength);
+	for (uint32_t i = 0; i < levelCount; i++)
+		memcpy(blob.data() + levels[i].byteOffset, data.levels[i].data(), data.levels[i].size());
+
+	auto file = std::ofstream{ path, std::ios::binary | std::ios::trunc };
+	if (!file.write(blob.data(), blob.size()))
+		throw std::runtime_error{ "failed to write ktx file " + path };
+}
+
+void KtxFile::init(std::span<const char> file)
+{
+	assert(!m_initialized);
+	m_initialized = true;
+	m_file = file;
+
+	if (file.size() < sizeof(KtxHeader))
+		throw std::runtime_error{ "ktx file is truncated" };
+	memcpy(&m_header, file.data(), sizeof(KtxHeader));
+	if (memcmp(m_header.identifier, IDENTIFIER, sizeof(IDENTIFIER)) != 0)
+		throw std::runtime_error{ "not a ktx2 file" };
+	if (m_header.supercompressionScheme != 0 || m_header.faceCount != 1 || m_header.layerCount > 1 || m_header.pixelDepth > 1)
+		throw std::runtime_error{ "unsupported ktx2 layout" };
+	if (sizeof(KtxLevel) * uint64_t{ getLevelCount() } > file.size() - sizeof(KtxHeader))
+		throw std::runtime_error{ "ktx file is truncated" };
+
+	m_levels.resize(getLevelCount());
+	memcpy(m_levels.data(), file.data() + sizeof(KtxHeader), sizeof(KtxLevel) * m_levels.size());
+	for (auto& level : m_levels)
+	{
+		if (level.byteOffset > file.size() || level.byteLength > file.size() - level.byteOffset)
+			throw std::runtime_error{ "ktx file is truncated" };
+	}
+}
+
+VkFormat KtxFile::getFormat() const
+{
+	assert(m_initialized);
+	return m_header.vkFormat;
+}
+
+uint32_t KtxFile::getWidth() const
+{
+	assert(m_initialized);
+	return m_header.pixelWidth;
+}
+
+uint32_t KtxFile::getHeight() const
+{
+	assert(m_initialized);
+	return m_header.pixelHeight;
+}
+
+uint32_t KtxFile::getLevelCount() const
+{
+	assert(m_initialized);
+	return std::max(m_header.levelCount, 1u);
+}
+
+std::span<const char> KtxFile::getLevel(uint32_t level) const
+{
+	assert(m_initialized);
+	assert(level < getLevelCount());
+	return m_file.subspan(m_levels[level].byteOffset, m_levels[level].byteLength);
+}
\ No newline at end of file
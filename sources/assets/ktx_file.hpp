@@ -0,0 +1,60 @@
+#pragma once
+
+#include "assets/texture_data.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+struct KtxHeader
+{
+	uint8_t identifier[12];
+	VkFormat vkFormat;
+	uint32_t typeSize;
+	uint32_t pixelWidth;
+	uint32_t pixelHeight;
+	uint32_t pixelDepth;
+	uint32_t layerCount;
+	uint32_t faceCount;
+	uint32_t levelCount;
+	uint32_t supercompressionScheme;
+	uint32_t dfdByteOffset;
+	uint32_t dfdByteLength;
+	uint32_t kvdByteOffset;
+	uint32_t kvdByteLength;
+	uint64_t sgdByteOffset;
+	uint64_t sgdByteLength;
+};
+
+struct KtxLevel
+{
+	uint64_t byteOffset;
+	uint64_t byteLength;
+	uint64_t uncompressedByteLength;
+};
+
+// Minimal KTX2 reader/writer: single face, single layer 2D textures
+// without supercompression, which is all the cooker produces
+class KtxFile
+{
+public:
+	static void write(const std::string& path, const TextureData& data);
+	static uint32_t getBlockSize(VkFormat format);
+
+	void init(std::span<const char> file);
+
+	VkFormat getFormat() const;
+	uint32_t getWidth() const;
+	uint32_t getHeight() const;
+	uint32_t getLevelCount() const;
+	std::span<const char> getLevel(uint32_t level) const;
+
+private:
+	bool m_initialized = false;
+	std::span<const char> m_file{};
+	KtxHeader m_header{};
+	std::vector<KtxLevel> m_levels{};
+};
\ No newline at end of file
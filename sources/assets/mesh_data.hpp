@@ -0,0 +1,61 @@
+#pragma once
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/glm.hpp>
+#include <glm/gtx/hash.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+struct MeshVertex
+{
+	glm::vec3 pos;
+	glm::vec3 normal;
+	glm::vec2 texCoord;
+
+	inline bool operator==(const MeshVertex& other) const {
+		return pos == other.pos && normal == other.normal && texCoord == other.texCoord;
+	}
+};
+
+namespace std {
+	template<> struct hash<MeshVertex> {
+		size_t operator()(MeshVertex const& vertex) const {
+			return ((hash<glm::vec3>()(vertex.pos) ^
+				(hash<glm::vec3>()(vertex.normal) << 1)) >> 1) ^
+				(hash<glm::vec2>()(vertex.texCoord) << 1);
+		}
+	};
+}
+
+struct Bounds
+{
+	glm::vec3 min;
+	glm::vec3 max;
+};
+
+struct Submesh
+{
+	uint32_t indexOffset;
+	uint32_t indexCount;
+	Bounds bounds;
+};
+
+// Index range of one detail level, error is the object space deviation from the full mesh
+struct MeshLod
+{
+	uint32_t indexOffset;
+	uint32_t indexCount;
+	float error;
+};
+
+// Submeshes index into lod 0, coarser lods follow it in the same index buffer
+struct MeshData
+{
+	std::vector<MeshVertex> vertices;
+	std::vector<uint32_t> indices;
+	std::vector<Submesh> submeshes;
+	std::vector<MeshLod> lods;
+	Bounds bounds;
+};
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include "assets/mesh_file.hpp"
+#include "assets/mesh_packer.hpp"
+
+#include <fstream>
+#include <cstring>
+#include <stdexcept>
+#include <cassert>
+
+static_assert(sizeof(MeshFileHeader) == 104);
+static_assert(sizeof(Submesh) == 32);
+static_assert(sizeof(MeshLod) == 12);
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+void MeshFile::write(const std::string& path, const MeshData& data)
+{
+	auto packed = MeshPacker::pack(data);
+	auto lods = data.lods;
+	if (lods.empty()) lods.push_back({ 0, static_cast<uint32_t>(data.indices.size()), 0.0f });
+
+	auto header = MeshFileHeader{};
+	header.magic = MAGIC;
+	header.version = VERSION;
+	header.positionStride = sizeof(VertexPosition);
+	header.attributeStride = sizeof(VertexAttributes);
+	header.vertexCount = static_cast<uint32_t>(packed.positions.size());
+	header.indexCount = static_cast<uint32_t>(data.indices.size());
+	header.indexSize = packed.indexSize;
+	header.submeshCount = static_cast<uint32_t>(data.submeshes.size());
+	header.bounds = data.bounds;
+	header.lodCount = static_cast<uint32_t>(lods.size());
+	header.submeshOffset = alignUp(sizeof(MeshFileHeader), ALIGNMENT);
+	header.lodOffset = alignUp(header.submeshOffset + sizeof(Submesh) * data.submeshes.size(), ALIGNMENT);
+	header.positionOffset = alignUp(header.lodOffset + sizeof(MeshLod) * lods.size(), ALIGNMENT);
+	header.attributeOffset = alignUp(header.positionOffset + sizeof(VertexPosition) * packed.positions.size(), ALIGNMENT);
+	header.indexOffset = alignUp(header.attributeOffset + sizeof(VertexAttributes) * packed.attributes.size(), ALIGNMENT);
+	auto fileSize = header.indexOffset + packed.indices.size();
+
+	auto blob = std::string(fileSize, '\0');
+	memcpy(blob.data(), &header, sizeof(header));
+	memcpy(blob.data() + header.submeshOffset, data.submeshes.data(), sizeof(Submesh) * data.submeshes.size());
+	memcpy(blob.data() + header.lodOffset, lods.data(), sizeof(MeshLod) * lods.size());
+	memcpy(blob.data() + header.positionOffset, packed.positions.data(), sizeof(VertexPosition) * packed.positions.size());
+	memcpy(blob.data() + header.attributeOffset, packed.attributes.data(), sizeof(VertexAttributes) * packed.attributes.size());
+	memcpy(blob.data() + header.indexOffset, packed.indices.data(), packed.indices.size());
+
+	auto file = std::ofstream{ path, std::ios::binary | std::ios::trunc };
+	if (!file.write(blob.data(), blob.size()))
+		throw std::runtime_error{ "failed to write mesh file " + path };
+}
+
+static bool isInFile(std::span<const char> file, uint64_t offset, uint64_t count, uint64_t stride)
+{
+	return offset <= file.size() && count * stride <= file.size() - offset;
+}
+
+void MeshFile::init(std::span<const char> file)
+{
+	assert(!m_initialized);
+	m_initialized = true;
+	m_file = file;
+
+	if (file.size() < sizeof(MeshFileHeader))
+		throw std::runtime_error{ "mesh file is truncated" };
+	memcpy(&m_header, file.data(), sizeof(MeshFileHeader));
+	if (m_header.magic != MAGIC)
+		throw std::runtime_error{ "not a mesh file" };
+	if (m_header.version != VERSION || m_header.positionStride != sizeof(VertexPosition) || m_header.attributeStride != sizeof(VertexAttributes))
+		throw std::runtime_error{ "mesh file was cooked for a different vertex layout, rerun vk_cooker" };
+	if (m_header.indexSize != 2 && m_header.indexSize != 4)
+		throw std::runtime_error{ "mesh file has an invalid index size" };
+	if (m_header.lodCount == 0)
+		throw std::runtime_error{ "mesh file has no lods" };
+	if (!isInFile(file, m_header.submeshOffset, m_header.submeshCount, sizeof(Submesh))
+		|| !isInFile(file, m_header.lodOffset, m_header.lodCount, sizeof(MeshLod))
+		|| !isInFile(file, m_header.positionOffset, m_header.vertexCount, m_header.positionStride)
+		|| !isInFile(file, m_header.attributeOffset, m_header.vertexCount, m_header.attributeStride)
+		|| !isInFile(file, m_header.indexOffset, m_header.indexCount, m_header.indexSize))
+		throw std::runtime_error{ "mesh file is truncated" };
+
+	// the tables are not guaranteed to be aligned inside the embedded blob, so copy them out
+	m_submeshes.resize(m_header.submeshCount);
+	memcpy(m_submeshes.data(), file.data() + m_header.submeshOffset, sizeof(Submesh) * m_submeshes.size());
+	m_lods.resize(m_header.lodCount);
+	memcpy(m_lods.data(), file.data() + m_header.lodOffset, sizeof(MeshLod) * m_lods.size());
+}
+
+const MeshFileHeader& MeshFile::getHeader() const
+{
+	assert(m_initialized);
+	return m_header;
+}
+
+std::span<const Submesh> MeshFile::getSubmeshes() const
+{
+	assert(m_initialized);
+	return m_submeshes;
+}
+
+std::span<const MeshLod> MeshFile::getLods() const
+{
+	assert(m_initialized);
+	return m_lods;
+}
+
+std::span<const char> MeshFile::getPositionData() const
+{
+	assert(m_initialized);
+	return m_file.subspan(m_header.positionOffset, static_cast<size_t>(m_header.positionStride) * m_header.vertexCount);
+}
+
+std::span<const char> MeshFile::getAttributeData() const
+{
+	assert(m_initialized);
+	return m_file.subspan(m_header.attributeOffset, static_cast<size_t>(m_header.attributeStride) * m_header.vertexCount);
+}
+
+std::span<const char> MeshFile::getIndexData() const
+{
+	assert(m_initialized);
+	return m_file.subspan(m_header.indexOffset, static_cast<size_t>(m_header.indexSize) * m_header.indexCount);
+}
\ No newline at end of file
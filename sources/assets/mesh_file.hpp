@@ -0,0 +1,56 @@
+#pragma once
+
+#include "assets/mesh_data.hpp"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+struct MeshFileHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t positionStride;
+	uint32_t attributeStride;
+	uint32_t vertexCount;
+	uint32_t indexCount;
+	uint32_t indexSize;
+	uint32_t submeshCount;
+	Bounds bounds;
+	uint32_t lodCount;
+	uint32_t reserved;
+	uint64_t submeshOffset;
+	uint64_t lodOffset;
+	uint64_t positionOffset;
+	uint64_t attributeOffset;
+	uint64_t indexOffset;
+};
+
+// Cooked mesh layout: header, submesh and lod tables, then the position, attribute and index blobs
+// in their GPU layout, each aligned so they can be copied to staging as is
+class MeshFile
+{
+public:
+	static constexpr uint32_t MAGIC = 0x534d4b56; // "VKMS"
+	static constexpr uint32_t VERSION = 4;
+	static constexpr uint64_t ALIGNMENT = 16;
+
+	static void write(const std::string& path, const MeshData& data);
+
+	void init(std::span<const char> file);
+
+	const MeshFileHeader& getHeader() const;
+	std::span<const Submesh> getSubmeshes() const;
+	std::span<const MeshLod> getLods() const;
+	std::span<const char> getPositionData() const;
+	std::span<const char> getAttributeData() const;
+	std::span<const char> getIndexData() const;
+
+private:
+	bool m_initialized = false;
+	std::span<const char> m_file{};
+	MeshFileHeader m_header{};
+	std::vector<Submesh> m_submeshes{};
+	std::vector<MeshLod> m_lods{};
+};
\ No newline at end of file
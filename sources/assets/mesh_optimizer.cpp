@@ -0,0 +1,285 @@
+#include "assets/mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+
+// Vertex scoring from Tom Forsyth's linear-speed vertex cache optimisation, tabulated since it runs for
+// every cache entry of every emitted triangle
+static constexpr uint32_t MAX_VALENCE = 32;
+
+static float vertexScore(int32_t cachePosition, uint32_t valence)
+{
+	static const auto tables = [] {
+		auto tables = std::pair<std::array<float, MeshOptimizer::CACHE_SIZE>, std::array<float, MAX_VALENCE>>{};
+		for (uint32_t i = 0; i < MeshOptimizer::CACHE_SIZE; i++)
+			tables.first[i] = i < 3 ? 0.75f : std::pow(1.0f - static_cast<float>(i - 3) / (MeshOptimizer::CACHE_SIZE - 3), 1.5f);
+		for (uint32_t i = 1; i < MAX_VALENCE; i++)
+			tables.second[i] = 2.0f / std::sqrt(static_cast<float>(i));
+		return tables;
+	}();
+
+	if (valence == 0) return -1.0f;
+	auto score = cachePosition >= 0 ? tables.first[cachePosition] : 0.0f;
+	return score + tables.second[std::min(valence, MAX_VALENCE - 1)];
+}
+
+// Returns how many of the triangle's vertices missed a FIFO cache of the given size
+static uint32_t simulateTriangle(const uint32_t* triangle, std::vector<uint32_t>& cacheTime, uint32_t& time, uint32_t cacheSize)
+{
+	auto misses = 0u;
+	for (uint32_t k = 0; k < 3; k++)
+	{
+		auto vertex = triangle[k];
+		if (time - cacheTime[vertex] > cacheSize)
+		{
+			cacheTime[vertex] = time++;
+			misses++;
+		}
+	}
+	return misses;
+}
+
+void MeshOptimizer::optimize(MeshData& data)
+{
+	for (auto& submesh : data.submeshes)
+	{
+		auto indices = std::span<uint32_t>{ data.indices }.subspan(submesh.indexOffset, submesh.indexCount);
+		optimizeVertexCache(indices, data.vertices.size());
+		optimizeOverdraw(indices, data.vertices, OVERDRAW_THRESHOLD);
+	}
+	for (size_t lod = 1; lod < data.lods.size(); lod++)
+	{
+		auto indices = std::span<uint32_t>{ data.indices }.subspan(data.lods[lod].indexOffset, data.lods[lod].indexCount);
+		optimizeVertexCache(indices, data.vertices.size());
+		optimizeOverdraw(indices, data.vertices, OVERDRAW_THRESHOLD);
+	}
+	optimizeVertexFetch(data);
+}
+
+void MeshOptimizer::optimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount)
+{
+	auto triangleCount = indices.size() / 3;
+	if (triangleCount == 0) return;
+
+	// Triangles adjacent to each vertex in one flat array, the live ones are kept at the front of each range
+	auto valence = std::vector<uint32_t>(vertexCount, 0);
+	for (auto index : indices) valence[index]++;
+	auto offsets = std::vector<uint32_t>(vertexCount + 1, 0);
+	std::partial_sum(valence.begin(), valence.end(), offsets.begin() + 1);
+	auto adjacency = std::vector<uint32_t>(indices.size());
+	auto cursor = std::vector<uint32_t>(offsets.begin(), offsets.end() - 1);
+	for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+		for (uint32_t k = 0; k < 3; k++)
+			adjacency[cursor[indices[triangle * 3 + k]]++] = triangle;
+
+	auto cachePosition = std::vector<int32_t>(vertexCount, -1);
+	auto vertexScores = std::vector<float>(vertexCount);
+	for (size_t vertex = 0; vertex < vertexCount; vertex++)
+		vertexScores[vertex] = vertexScore(-1, valence[vertex]);
+
+	auto triangleScores = std::vector<float>(triangleCount);
+	auto best = uint32_t{};
+	for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+	{
+		auto* vertices = &indices[triangle * 3];
+		triangleScores[triangle] = vertexScores[vertices[0]] + vertexScores[vertices[1]] + vertexScores[vertices[2]];
+		if (triangleScores[triangle] > triangleScores[best]) best = triangle;
+	}
+
+	auto emitted = std::vector<bool>(triangleCount, false);
+	auto result = std::vector<uint32_t>{};
+	result.reserve(indices.size());
+	auto cache = std::vector<uint32_t>{};
+	auto nextCache = std::vector<uint32_t>{};
+	auto nextTriangle = uint32_t{};
+	while (true)
+	{
+		auto triangle = &indices[best * 3];
+		emitted[best] = true;
+		result.insert(result.end(), triangle, triangle + 3);
+
+		for (uint32_t k = 0; k < 3; k++)
+		{
+			auto vertex = triangle[k];
+			auto begin = adjacency.begin() + offsets[vertex];
+			auto end = begin + valence[vertex];
+			std::iter_swap(std::find(begin, end, best), end - 1);
+			valence[vertex]--;
+		}
+
+		nextCache.assign(triangle, triangle + 3);
+		for (auto vertex : cache)
+			if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+				nextCache.push_back(vertex);
+
+		for (uint32_t position = 0; position < nextCache.size(); position++)
+		{
+			auto vertex = nextCache[position];
+			cachePosition[vertex] = position < CACHE_SIZE ? static_cast<int32_t>(position) : -1;
+			vertexScores[vertex] = vertexScore(cachePosition[vertex], valence[vertex]);
+		}
+
+		// Only triangles touching the cache change score, the best of them is emitted next
+		auto bestScore = 0.0f;
+		auto found = false;
+		for (auto vertex : nextCache)
+		{
+			for (uint32_t i = 0; i < valence[vertex]; i++)
+			{
+				auto neighbour = adjacency[offsets[vertex] + i];
+				auto* vertices = &indices[neighbour * 3];
+				triangleScores[neighbour] = vertexScores[vertices[0]] + vertexScores[vertices[1]] + vertexScores[vertices[2]];
+				if (!found || triangleScores[neighbour] > bestScore)
+				{
+					best = neighbour;
+					bestScore = triangleScores[neighbour];
+					found = true;
+				}
+			}
+		}
+
+		if (nextCache.size() > CACHE_SIZE) nextCache.resize(CACHE_SIZE);
+		std::swap(cache, nextCache);
+		if (found) continue;
+
+		// Nothing left around the cache, restart from the next triangle in input order
+		while (nextTriangle < triangleCount && emitted[nextTriangle]) nextTriangle++;
+		if (nextTriangle == triangleCount) break;
+		best = nextTriangle;
+	}
+
+	std::copy(result.begin(), result.end(), indices.begin());
+}
+
+void MeshOptimizer::optimizeOverdraw(std::span<uint32_t> indices, const std::vector<MeshVertex>& vertices, float threshold)
+{
+	auto triangleCount = indices.size() / 3;
+	if (triangleCount == 0) return;
+
+	auto cacheTime = std::vector<uint32_t>(vertices.size(), 0);
+	auto time = CACHE_SIZE + 1;
+	auto triangleMisses = std::vector<uint32_t>(triangleCount);
+	for (size_t triangle = 0; triangle < triangleCount; triangle++)
+		triangleMisses[triangle] = simulateTriangle(&indices[triangle * 3], cacheTime, time, CACHE_SIZE);
+
+	// A triangle missing all three vertices starts a new strip, which is where the order can be broken for free.
+	// Those clusters are split further wherever the part so far is within threshold of the cluster's cache efficiency
+	auto clusters = std::vector<size_t>{};
+	for (size_t start = 0; start < triangleCount;)
+	{
+		auto end = start + 1;
+		auto clusterMisses = triangleMisses[start];
+		while (end < triangleCount && triangleMisses[end] != 3) clusterMisses += triangleMisses[end++];
+		auto target = static_cast<float>(clusterMisses) / (end - start) * threshold;
+
+		time += CACHE_SIZE + 1;
+		auto begin = start;
+		auto misses = 0u;
+		clusters.push_back(begin);
+		for (auto triangle = start; triangle + 1 < end; triangle++)
+		{
+			misses += simulateTriangle(&indices[triangle * 3], cacheTime, time, CACHE_SIZE);
+			if (static_cast<float>(misses) <= target * (triangle + 1 - begin))
+			{
+				time += CACHE_SIZE + 1;
+				begin = triangle + 1;
+				misses = 0;
+				clusters.push_back(begin);
+			}
+		}
+		start = end;
+	}
+	clusters.push_back(triangleCount);
+
+	// Clusters facing away from the mesh centre tend to occlude the rest, so they are drawn first
+	auto triangleArea = [&](size_t triangle, glm::vec3& centroid) {
+		auto& a = vertices[indices[triangle * 3 + 0]].pos;
+		auto& b = vertices[indices[triangle * 3 + 1]].pos;
+		auto& c = vertices[indices[triangle * 3 + 2]].pos;
+		centroid = (a + b + c) / 3.0f;
+		return glm::cross(b - a, c - a);
+	};
+
+	auto meshCentroid = glm::vec3{ 0.0f };
+	auto meshArea = 0.0f;
+	for (size_t triangle = 0; triangle < triangleCount; triangle++)
+	{
+		auto centroid = glm::vec3{};
+		auto area = glm::length(triangleArea(triangle, centroid));
+		meshCentroid += centroid * area;
+		meshArea += area;
+	}
+	if (meshArea > 0.0f) meshCentroid /= meshArea;
+
+	auto clusterCount = clusters.size() - 1;
+	auto sortKeys = std::vector<float>(clusterCount);
+	for (size_t cluster = 0; cluster < clusterCount; cluster++)
+	{
+		auto clusterCentroid = glm::vec3{ 0.0f };
+		auto clusterNormal = glm::vec3{ 0.0f };
+		auto clusterArea = 0.0f;
+		for (auto triangle = clusters[cluster]; triangle < clusters[cluster + 1]; triangle++)
+		{
+			auto centroid = glm::vec3{};
+			auto normal = triangleArea(triangle, centroid);
+			auto area = glm::length(normal);
+			clusterCentroid += centroid * area;
+			clusterNormal += normal;
+			clusterArea += area;
+		}
+		auto normalLength = glm::length(clusterNormal);
+		if (clusterArea > 0.0f && normalLength > 0.0f)
+			sortKeys[cluster] = glm::dot(clusterCentroid / clusterArea - meshCentroid, clusterNormal / normalLength);
+	}
+
+	auto order = std::vector<size_t>(clusterCount);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sortKeys[a] > sortKeys[b]; });
+
+	auto result = std::vector<uint32_t>{};
+	result.reserve(indices.size());
+	for (auto cluster : order)
+		result.insert(result.end(), indices.begin() + clusters[cluster] * 3, indices.begin() + clusters[cluster + 1] * 3);
+	std::copy(result.begin(), result.end(), indices.begin());
+}
+
+void MeshOptimizer::optimizeVertexFetch(MeshData& data)
+{
+	// Vertices are laid out in the order the index buffer first touches them, unreferenced ones are dropped
+	constexpr auto unused = ~uint32_t{};
+	auto remap = std::vector<uint32_t>(data.vertices.size(), unused);
+	auto vertices = std::vector<MeshVertex>{};
+	vertices.reserve(data.vertices.size());
+	for (auto& index : data.indices)
+	{
+		if (remap[index] == unused)
+		{
+			remap[index] = static_cast<uint32_t>(vertices.size());
+			vertices.push_back(data.vertices[index]);
+		}
+		index = remap[index];
+	}
+	data.vertices = std::move(vertices);
+}
+
+VertexCacheStats MeshOptimizer::analyzeVertexCache(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize)
+{
+	auto cacheTime = std::vector<uint32_t>(vertexCount, 0);
+	auto time = cacheSize + 1;
+	auto used = std::vector<bool>(vertexCount, false);
+	auto uniqueVertices = size_t{};
+	auto stats = VertexCacheStats{};
+	for (size_t triangle = 0; triangle < indices.size() / 3; triangle++)
+		stats.vertexInvocations += simulateTriangle(&indices[triangle * 3], cacheTime, time, cacheSize);
+	for (auto index : indices)
+	{
+		if (!used[index]) uniqueVertices++;
+		used[index] = true;
+	}
+
+	if (!indices.empty()) stats.acmr = static_cast<float>(stats.vertexInvocations) / (indices.size() / 3);
+	if (uniqueVertices > 0) stats.atvr = static_cast<float>(stats.vertexInvocations) / uniqueVertices;
+	return stats;
+}
\ No newline at end of file
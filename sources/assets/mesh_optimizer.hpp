@@ -0,0 +1,29 @@
+#pragma once
+
+#include "assets/mesh_data.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+struct VertexCacheStats
+{
+	uint64_t vertexInvocations;
+	float acmr; // vertex shader invocations per triangle, 0.5 is the limit for a regular grid
+	float atvr; // vertex shader invocations per unique vertex, 1.0 is the limit
+};
+
+// Reorders triangles for the post transform cache and overdraw, then vertices for fetch locality.
+// Triangles never move across submesh or lod boundaries
+class MeshOptimizer
+{
+public:
+	static constexpr uint32_t CACHE_SIZE = 32;
+	static constexpr float OVERDRAW_THRESHOLD = 1.05f;
+
+	static void optimize(MeshData& data);
+	static void optimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount);
+	static void optimizeOverdraw(std::span<uint32_t> indices, const std::vector<MeshVertex>& vertices, float threshold);
+	static void optimizeVertexFetch(MeshData& data);
+	static VertexCacheStats analyzeVertexCache(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize);
+};
\ No newline at end of file
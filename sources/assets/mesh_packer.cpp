@@ -0,0 +1,73 @@
+#include "assets/mesh_packer.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+PackedMesh MeshPacker::pack(const MeshData& data)
+{
+	auto packed = PackedMesh{};
+	packed.positions.reserve(data.vertices.size());
+	packed.attributes.reserve(data.vertices.size());
+	for (auto& vertex : data.vertices)
+	{
+		packed.positions.push_back(packPosition(vertex, data.bounds));
+		packed.attributes.push_back(packAttributes(vertex));
+	}
+
+	// 16 bit indices halve the index fetch for any mesh that can address its vertices with them
+	packed.indexSize = data.vertices.size() <= std::numeric_limits<uint16_t>::max() + 1 ? 2 : 4;
+	packed.indices.resize(data.indices.size() * packed.indexSize);
+	if (packed.indexSize == 4)
+	{
+		memcpy(packed.indices.data(), data.indices.data(), packed.indices.size());
+		return packed;
+	}
+	for (size_t i = 0; i < data.indices.size(); i++)
+	{
+		auto index = static_cast<uint16_t>(data.indices[i]);
+		memcpy(packed.indices.data() + i * 2, &index, 2);
+	}
+	return packed;
+}
+
+VertexPosition MeshPacker::packPosition(const MeshVertex& vertex, const Bounds& bounds)
+{
+	auto extent = bounds.max - bounds.min;
+	auto vertexPos = glm::vec3{};
+	for (int i = 0; i < 3; i++)
+		vertexPos[i] = extent[i] > 0.0f ? (vertex.pos[i] - bounds.min[i]) / extent[i] : 0.0f;
+
+	return { glm::u16vec4{ glm::round(glm::clamp(vertexPos, 0.0f, 1.0f) * 65535.0f), 0 } };
+}
+
+VertexAttributes MeshPacker::packAttributes(const MeshVertex& vertex)
+{
+	auto packed = VertexAttributes{};
+	packed.normal = encodeOctahedral(vertex.normal);
+	packed.texCoord = { glm::packHalf1x16(vertex.texCoord.x), glm::packHalf1x16(vertex.texCoord.y) };
+	return packed;
+}
+
+glm::i16vec2 MeshPacker::encodeOctahedral(glm::vec3 normal)
+{
+	auto length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+	if (length == 0.0f) return {};
+	normal /= length;
+	auto encoded = glm::vec2{ normal.x, normal.y };
+	if (normal.z < 0.0f)
+	{
+		encoded = (1.0f - glm::abs(glm::vec2{ normal.y, normal.x }))
+			* glm::vec2{ normal.x >= 0.0f ? 1.0f : -1.0f, normal.y >= 0.0f ? 1.0f : -1.0f };
+	}
+	return glm::i16vec2{ glm::round(glm::clamp(encoded, -1.0f, 1.0f) * 32767.0f) };
+}
+
+glm::mat4 MeshPacker::getDequantization(const Bounds& bounds)
+{
+	auto dequantization = glm::translate(glm::mat4{ 1.0f }, bounds.min);
+	return glm::scale(dequantization, bounds.max - bounds.min);
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "assets/mesh_data.hpp"
+#include "graphics/vulkan/types.hpp"
+
+#include <cstdint>
+#include <vector>
+
+struct PackedMesh
+{
+	std::vector<VertexPosition> positions;
+	std::vector<VertexAttributes> attributes;
+	std::vector<uint8_t> indices;
+	uint32_t indexSize;
+};
+
+class MeshPacker
+{
+public:
+	static PackedMesh pack(const MeshData& data);
+	static VertexPosition packPosition(const MeshVertex& vertex, const Bounds& bounds);
+	static VertexAttributes packAttributes(const MeshVertex& vertex);
+	static glm::i16vec2 encodeOctahedral(glm::vec3 normal);
+	static glm::mat4 getDequantization(const Bounds& bounds);
+};
\ No newline at end of file
@@ -0,0 +1,240 @@
+#include "assets/mesh_simplifier.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <unordered_map>
+
+namespace
+{
+	// Symmetric 4x4 error quadric, doubles since planes far from the origin lose precision quickly.
+	// Planes are weighted by area, the summed weight turns the error back into a squared distance
+	struct Quadric
+	{
+		double a00, a01, a02, a11, a12, a22;
+		double b0, b1, b2;
+		double c;
+		double weight;
+
+		Quadric& operator+=(const Quadric& other)
+		{
+			a00 += other.a00; a01 += other.a01; a02 += other.a02;
+			a11 += other.a11; a12 += other.a12; a22 += other.a22;
+			b0 += other.b0; b1 += other.b1; b2 += other.b2;
+			c += other.c;
+			weight += other.weight;
+			return *this;
+		}
+
+		Quadric operator+(const Quadric& other) const
+		{
+			auto result = *this;
+			return result += other;
+		}
+
+		double evaluate(const glm::vec3& point) const
+		{
+			double x = point.x, y = point.y, z = point.z;
+			auto error = a00 * x * x + a11 * y * y + a22 * z * z
+				+ 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+				+ 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+			return weight > 0.0 ? std::max(error, 0.0) / weight : 0.0;
+		}
+
+		static Quadric fromPlane(const glm::vec3& normal, float distance, float weight)
+		{
+			double a = normal.x, b = normal.y, c = normal.z, d = distance, w = weight;
+			return { w * a * a, w * a * b, w * a * c, w * b * b, w * b * c, w * c * c, w * a * d, w * b * d, w * c * d, w * d * d, w };
+		}
+	};
+
+	struct Collapse
+	{
+		uint32_t from;
+		uint32_t to;
+		double cost;
+	};
+}
+
+void MeshSimplifier::generateLods(MeshData& data)
+{
+	data.lods = { { 0, static_cast<uint32_t>(data.indices.size()), 0.0f } };
+	auto targetError = glm::length(data.bounds.max - data.bounds.min) * MAX_ERROR;
+
+	// Each level is built from the previous one per submesh, so the error grows by at most the step error
+	auto previous = std::vector<std::vector<uint32_t>>{};
+	for (auto& submesh : data.submeshes)
+		previous.emplace_back(data.indices.begin() + submesh.indexOffset, data.indices.begin() + submesh.indexOffset + submesh.indexCount);
+
+	while (data.lods.size() < MAX_LODS)
+	{
+		auto lod = MeshLod{ static_cast<uint32_t>(data.indices.size()), 0, data.lods.back().error };
+		auto previousCount = size_t{};
+		auto stepError = 0.0f;
+		auto levels = std::vector<std::vector<uint32_t>>{};
+		for (auto& indices : previous)
+		{
+			auto targetCount = static_cast<size_t>(indices.size() / 3 * LOD_REDUCTION) * 3;
+			auto error = 0.0f;
+			levels.push_back(simplify(data.vertices, indices, targetCount, targetError - lod.error, error));
+			stepError = std::max(stepError, error);
+			previousCount += indices.size();
+			lod.indexCount += static_cast<uint32_t>(levels.back().size());
+		}
+
+		// Stop once simplification stalls on locked borders and seams or the error budget is used up
+		if (lod.indexCount == 0 || lod.indexCount > previousCount * 0.8f) break;
+		lod.error += stepError;
+		for (auto& indices : levels)
+			data.indices.insert(data.indices.end(), indices.begin(), indices.end());
+		data.lods.push_back(lod);
+		previous = std::move(levels);
+	}
+}
+
+std::vector<uint32_t> MeshSimplifier::simplify(const std::vector<MeshVertex>& vertices, std::span<const uint32_t> indices,
+	size_t targetIndexCount, float targetError, float& resultError)
+{
+	auto result = std::vector<uint32_t>(indices.begin(), indices.end());
+	resultError = 0.0f;
+	if (result.size() <= targetIndexCount || targetError <= 0.0f) return result;
+
+	// Vertices sharing a position are one point of the surface, split only by attributes
+	auto positionIds = std::unordered_map<glm::vec3, uint32_t>{};
+	auto wedge = std::vector<uint32_t>(vertices.size());
+	auto seam = std::vector<bool>(vertices.size(), false);
+	for (auto index : result)
+	{
+		auto it = positionIds.try_emplace(vertices[index].pos, index).first;
+		wedge[index] = it->second;
+		if (it->second != index) seam[it->second] = true;
+	}
+
+	// Edges used by a single triangle are borders, collapsing them would open or shrink the outline
+	auto edgeUses = std::unordered_map<uint64_t, uint32_t>{};
+	auto edgeKey = [&](uint32_t a, uint32_t b) {
+		a = wedge[a];
+		b = wedge[b];
+		return (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+	};
+	for (size_t i = 0; i < result.size(); i += 3)
+		for (uint32_t k = 0; k < 3; k++)
+			edgeUses[edgeKey(result[i + k], result[i + (k + 1) % 3])]++;
+
+	auto locked = std::vector<bool>(vertices.size(), false);
+	for (auto index : result)
+		locked[index] = seam[wedge[index]];
+	for (size_t i = 0; i < result.size(); i += 3)
+	{
+		for (uint32_t k = 0; k < 3; k++)
+		{
+			auto a = result[i + k];
+			auto b = result[i + (k + 1) % 3];
+			if (edgeUses[edgeKey(a, b)] == 1)
+				locked[a] = locked[b] = true;
+		}
+	}
+
+	auto quadrics = std::vector<Quadric>(vertices.size(), Quadric{});
+	for (size_t i = 0; i < result.size(); i += 3)
+	{
+		auto& a = vertices[result[i + 0]].pos;
+		auto& b = vertices[result[i + 1]].pos;
+		auto& c = vertices[result[i + 2]].pos;
+		auto normal = glm::cross(b - a, c - a);
+		auto area = glm::length(normal);
+		if (area == 0.0f) continue;
+		normal /= area;
+		auto quadric = Quadric::fromPlane(normal, -glm::dot(normal, a), area);
+		for (uint32_t k = 0; k < 3; k++)
+			quadrics[wedge[result[i + k]]] += quadric;
+	}
+
+	auto maxCost = static_cast<double>(targetError) * targetError;
+	auto maxApplied = 0.0;
+	auto remap = std::vector<uint32_t>(vertices.size());
+	auto touched = std::vector<bool>(vertices.size());
+	auto collapses = std::vector<Collapse>{};
+	auto offsets = std::vector<uint32_t>(vertices.size() + 1);
+	auto adjacency = std::vector<uint32_t>{};
+	while (result.size() > targetIndexCount)
+	{
+		collapses.clear();
+		for (size_t i = 0; i < result.size(); i += 3)
+		{
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				auto from = result[i + k];
+				auto to = result[i + (k + 1) % 3];
+				for (auto [a, b] : { std::pair{ from, to }, std::pair{ to, from } })
+				{
+					if (locked[a]) continue;
+					auto cost = (quadrics[wedge[a]] + quadrics[wedge[b]]).evaluate(vertices[b].pos);
+					if (cost <= maxCost) collapses.push_back({ a, b, cost });
+				}
+			}
+		}
+		if (collapses.empty()) break;
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+		// Triangles around each vertex, rebuilt per pass since collapses are only applied at the end of one
+		std::fill(offsets.begin(), offsets.end(), 0);
+		for (auto index : result) offsets[index + 1]++;
+		std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+		adjacency.resize(result.size());
+		auto cursor = std::vector<uint32_t>(offsets.begin(), offsets.end() - 1);
+		for (size_t i = 0; i < result.size(); i++)
+			adjacency[cursor[result[i]]++] = static_cast<uint32_t>(i / 3);
+
+		std::iota(remap.begin(), remap.end(), 0);
+		std::fill(touched.begin(), touched.end(), false);
+		// An interior collapse removes two triangles, so this lands on the target in one pass at best
+		auto budget = (result.size() - targetIndexCount) / 3 / 2 + 1;
+		auto applied = size_t{};
+		for (auto& collapse : collapses)
+		{
+			if (touched[collapse.from] || touched[collapse.to]) continue;
+
+			// Reject collapses that would flip a remaining triangle around the removed vertex
+			auto flips = false;
+			for (auto i = offsets[collapse.from]; i < offsets[collapse.from + 1] && !flips; i++)
+			{
+				auto* triangle = &result[adjacency[i] * 3];
+				if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to) continue;
+				auto& a = vertices[triangle[0]].pos;
+				auto& b = vertices[triangle[1]].pos;
+				auto& c = vertices[triangle[2]].pos;
+				auto before = glm::cross(b - a, c - a);
+				auto position = [&](uint32_t vertex) { return vertex == collapse.from ? vertices[collapse.to].pos : vertices[vertex].pos; };
+				auto after = glm::cross(position(triangle[1]) - position(triangle[0]), position(triangle[2]) - position(triangle[0]));
+				flips = glm::dot(before, after) <= 0.0f;
+			}
+			if (flips) continue;
+
+			remap[collapse.from] = collapse.to;
+			quadrics[wedge[collapse.to]] += quadrics[wedge[collapse.from]];
+			for (auto i = offsets[collapse.from]; i < offsets[collapse.from + 1]; i++)
+				for (uint32_t k = 0; k < 3; k++)
+					touched[result[adjacency[i] * 3 + k]] = true;
+			maxApplied = std::max(maxApplied, collapse.cost);
+			if (++applied >= budget) break;
+		}
+		if (applied == 0) break;
+
+		auto write = size_t{};
+		for (size_t i = 0; i < result.size(); i += 3)
+		{
+			auto a = remap[result[i + 0]];
+			auto b = remap[result[i + 1]];
+			auto c = remap[result[i + 2]];
+			if (a == b || b == c || c == a) continue;
+			result[write++] = a;
+			result[write++] = b;
+			result[write++] = c;
+		}
+		result.resize(write);
+	}
+
+	resultError = static_cast<float>(std::sqrt(maxApplied));
+	return result;
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "assets/mesh_data.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Quadric error edge collapse in the spirit of Garland and Heckbert. Vertices collapse onto existing
+// neighbours so every LOD indexes the same vertex buffer; borders and attribute seams are kept
+class MeshSimplifier
+{
+public:
+	static constexpr uint32_t MAX_LODS = 5;
+	static constexpr float LOD_REDUCTION = 0.5f;
+	static constexpr float MAX_ERROR = 0.05f; // relative to the mesh diagonal
+
+	static void generateLods(MeshData& data);
+	static std::vector<uint32_t> simplify(const std::vector<MeshVertex>& vertices, std::span<const uint32_t> indices,
+		size_t targetIndexCount, float targetError, float& resultError);
+};
\ No newline at end of file
@@ -0,0 +1,258 @@
+#include "assets/obj_importer.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	// Indices are stored 1 based with 0 marking a missing one. Negative OBJ indices count back from the
+	// current end, they are kept chunk local and offset by RELATIVE until the chunk's global base is known
+	constexpr int32_t RELATIVE = 1 << 30;
+
+	struct ObjCorner
+	{
+		int32_t position;
+		int32_t texCoord;
+		int32_t normal;
+	};
+
+	struct ObjChunk
+	{
+		std::string_view source;
+		std::vector<glm::vec3> positions;
+		std::vector<glm::vec2> texCoords;
+		std::vector<glm::vec3> normals;
+		std::vector<ObjCorner> corners;
+		std::vector<size_t> groupStarts;
+		size_t positionBase;
+		size_t texCoordBase;
+		size_t normalBase;
+		size_t cornerBase;
+	};
+
+	struct WeldSlot
+	{
+		uint32_t hash;
+		uint32_t vertex;
+	};
+}
+
+static_assert(sizeof(MeshVertex) == 8 * sizeof(float));
+
+static Bounds emptyBounds()
+{
+	return { glm::vec3{ std::numeric_limits<float>::max() }, glm::vec3{ std::numeric_limits<float>::lowest() } };
+}
+
+static const char* skipSpace(const char* it, const char* end)
+{
+	while (it < end && (*it == ' ' || *it == '\t' || *it == '\r')) it++;
+	return it;
+}
+
+template<typename T>
+static const char* parseNumber(const char* it, const char* end, T& value)
+{
+	it = skipSpace(it, end);
+	if (it < end && *it == '+') it++;
+	auto [next, error] = std::from_chars(it, end, value);
+	if (error != std::errc{})
+		throw std::runtime_error{ "failed to parse obj number" };
+	return next;
+}
+
+static int32_t toRelative(int32_t index, size_t count)
+{
+	return index < 0 ? static_cast<int32_t>(count) + index - RELATIVE : index;
+}
+
+static uint32_t resolve(int32_t index, size_t base, size_t count)
+{
+	auto resolved = index < 0 ? static_cast<int64_t>(base) + index + RELATIVE : static_cast<int64_t>(index) - 1;
+	if (resolved < 0 || resolved >= static_cast<int64_t>(count))
+		throw std::runtime_error{ "obj face index out of range" };
+	return static_cast<uint32_t>(resolved);
+}
+
+static void parseChunk(ObjChunk& chunk)
+{
+	auto polygon = std::vector<ObjCorner>{};
+	auto* it = chunk.source.data();
+	auto* end = it + chunk.source.size();
+	while (it < end)
+	{
+		auto* lineEnd = static_cast<const char*>(memchr(it, '\n', end - it));
+		if (lineEnd == nullptr) lineEnd = end;
+		it = skipSpace(it, lineEnd);
+
+		if (lineEnd - it > 2 && it[0] == 'v' && (it[1] == ' ' || it[1] == '\t'))
+		{
+			auto& position = chunk.positions.emplace_back();
+			it = parseNumber(parseNumber(parseNumber(it + 2, lineEnd, position.x), lineEnd, position.y), lineEnd, position.z);
+		}
+		else if (lineEnd - it > 3 && it[0] == 'v' && it[1] == 't')
+		{
+			auto& texCoord = chunk.texCoords.emplace_back(0.0f);
+			it = parseNumber(it + 2, lineEnd, texCoord.x);
+			if (skipSpace(it, lineEnd) < lineEnd) parseNumber(it, lineEnd, texCoord.y);
+			texCoord.y = 1.0f - texCoord.y;
+		}
+		else if (lineEnd - it > 3 && it[0] == 'v' && it[1] == 'n')
+		{
+			auto& normal = chunk.normals.emplace_back();
+			parseNumber(parseNumber(parseNumber(it + 2, lineEnd, normal.x), lineEnd, normal.y), lineEnd, normal.z);
+		}
+		else if (lineEnd - it > 2 && it[0] == 'f' && (it[1] == ' ' || it[1] == '\t'))
+		{
+			polygon.clear();
+			it = skipSpace(it + 1, lineEnd);
+			while (it < lineEnd)
+			{
+				auto corner = ObjCorner{};
+				it = parseNumber(it, lineEnd, corner.position);
+				corner.position = toRelative(corner.position, chunk.positions.size());
+				if (it < lineEnd && *it == '/')
+				{
+					if (++it < lineEnd && *it != '/')
+					{
+						it = parseNumber(it, lineEnd, corner.texCoord);
+						corner.texCoord = toRelative(corner.texCoord, chunk.texCoords.size());
+					}
+					if (it < lineEnd && *it == '/')
+					{
+						it = parseNumber(it + 1, lineEnd, corner.normal);
+						corner.normal = toRelative(corner.normal, chunk.normals.size());
+					}
+				}
+				polygon.push_back(corner);
+				it = skipSpace(it, lineEnd);
+			}
+			for (size_t i = 2; i < polygon.size(); i++)
+			{
+				chunk.corners.push_back(polygon[0]);
+				chunk.corners.push_back(polygon[i - 1]);
+				chunk.corners.push_back(polygon[i]);
+			}
+		}
+		else if (lineEnd - it > 1 && (it[0] == 'o' || it[0] == 'g') && (it[1] == ' ' || it[1] == '\t'))
+			chunk.groupStarts.push_back(chunk.corners.size());
+
+		it = lineEnd + 1;
+	}
+}
+
+static uint32_t hashVertex(const MeshVertex& vertex)
+{
+	uint32_t words[8];
+	memcpy(words, &vertex, sizeof(words));
+	auto hash = uint64_t{ 0x9e3779b97f4a7c15 };
+	for (auto word : words)
+		hash = (hash ^ word) * 0xff51afd7ed558ccd;
+	return static_cast<uint32_t>(hash ^ (hash >> 32));
+}
+
+MeshData ObjImporter::import(std::string_view source, JobSystem& jobs)
+{
+	// A few chunks per thread so idle workers have something left to steal when lines are uneven
+	auto chunkCount = std::clamp<size_t>(source.size() / MIN_CHUNK_SIZE, 1, jobs.getThreadCount() * CHUNKS_PER_THREAD);
+
+	// Chunks end on line boundaries so every statement is parsed by exactly one job
+	auto chunks = std::vector<ObjChunk>(chunkCount);
+	auto begin = size_t{};
+	for (size_t i = 0; i < chunkCount; i++)
+	{
+		auto end = i + 1 == chunkCount ? source.size() : source.find('\n', source.size() * (i + 1) / chunkCount);
+		end = std::min(end == std::string_view::npos ? source.size() : end + 1, source.size());
+		chunks[i].source = source.substr(begin, std::max(end, begin) - begin);
+		begin = std::max(end, begin);
+	}
+	jobs.parallelFor(chunkCount, 1, [&](size_t i) { parseChunk(chunks[i]); });
+
+	auto positionCount = size_t{}, texCoordCount = size_t{}, normalCount = size_t{}, cornerCount = size_t{};
+	for (auto& chunk : chunks)
+	{
+		chunk.positionBase = std::exchange(positionCount, positionCount + chunk.positions.size());
+		chunk.texCoordBase = std::exchange(texCoordCount, texCoordCount + chunk.texCoords.size());
+		chunk.normalBase = std::exchange(normalCount, normalCount + chunk.normals.size());
+		chunk.cornerBase = std::exchange(cornerCount, cornerCount + chunk.corners.size());
+	}
+	if (cornerCount == 0)
+		throw std::runtime_error{ "obj has no triangles" };
+	if (cornerCount > std::numeric_limits<uint32_t>::max())
+		throw std::runtime_error{ "obj has too many triangles" };
+
+	auto positions = std::vector<glm::vec3>(positionCount);
+	auto texCoords = std::vector<glm::vec2>(texCoordCount);
+	auto normals = std::vector<glm::vec3>(normalCount);
+	jobs.parallelFor(chunkCount, 1, [&](size_t i) {
+		auto& chunk = chunks[i];
+		std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + chunk.positionBase);
+		std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), texCoords.begin() + chunk.texCoordBase);
+		std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + chunk.normalBase);
+	});
+
+	// Corners become full vertices and hashes in parallel, leaving only the table probing for the weld
+	auto cornerVertices = std::vector<MeshVertex>(cornerCount);
+	auto cornerHashes = std::vector<uint32_t>(cornerCount);
+	jobs.parallelFor(chunkCount, 1, [&](size_t i) {
+		auto& chunk = chunks[i];
+		for (size_t corner = 0; corner < chunk.corners.size(); corner++)
+		{
+			auto& indices = chunk.corners[corner];
+			auto& vertex = cornerVertices[chunk.cornerBase + corner];
+			vertex.pos = positions[resolve(indices.position, chunk.positionBase, positionCount)];
+			if (indices.texCoord != 0) vertex.texCoord = texCoords[resolve(indices.texCoord, chunk.texCoordBase, texCoordCount)];
+			if (indices.normal != 0) vertex.normal = normals[resolve(indices.normal, chunk.normalBase, normalCount)];
+			cornerHashes[chunk.cornerBase + corner] = hashVertex(vertex);
+		}
+	});
+
+	auto groupStarts = std::vector<size_t>{ 0 };
+	for (auto& chunk : chunks)
+		for (auto start : chunk.groupStarts)
+			groupStarts.push_back(chunk.cornerBase + start);
+	groupStarts.push_back(cornerCount);
+
+	auto data = MeshData{};
+	data.bounds = emptyBounds();
+	data.vertices.resize(cornerCount);
+	data.indices.resize(cornerCount);
+	auto vertexCount = uint32_t{};
+	constexpr auto empty = std::numeric_limits<uint32_t>::max();
+	auto table = std::vector<WeldSlot>(std::bit_ceil(cornerCount * 2), WeldSlot{ 0, empty });
+	auto mask = table.size() - 1;
+	for (size_t group = 0; group + 1 < groupStarts.size(); group++)
+	{
+		auto submesh = Submesh{ static_cast<uint32_t>(groupStarts[group]), static_cast<uint32_t>(groupStarts[group + 1] - groupStarts[group]), emptyBounds() };
+		for (auto corner = groupStarts[group]; corner < groupStarts[group + 1]; corner++)
+		{
+			auto& vertex = cornerVertices[corner];
+			auto hash = cornerHashes[corner];
+			auto slot = hash & mask;
+			while (table[slot].vertex != empty
+				&& (table[slot].hash != hash || memcmp(&data.vertices[table[slot].vertex], &vertex, sizeof(MeshVertex)) != 0))
+				slot = (slot + 1) & mask;
+			if (table[slot].vertex == empty)
+			{
+				table[slot] = { hash, vertexCount };
+				data.vertices[vertexCount++] = vertex;
+			}
+			data.indices[corner] = table[slot].vertex;
+			submesh.bounds.min = glm::min(submesh.bounds.min, vertex.pos);
+			submesh.bounds.max = glm::max(submesh.bounds.max, vertex.pos);
+		}
+		if (submesh.indexCount == 0) continue;
+
+		data.bounds.min = glm::min(data.bounds.min, submesh.bounds.min);
+		data.bounds.max = glm::max(data.bounds.max, submesh.bounds.max);
+		data.submeshes.push_back(submesh);
+	}
+	data.vertices.resize(vertexCount);
+	return data;
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "assets/mesh_data.hpp"
+#include "core/job_system.hpp"
+
+#include <cstdint>
+#include <string_view>
+
+// Parses line aligned chunks of the source as jobs, then welds identical vertices.
+// Every o or g statement starts a new submesh, materials are ignored
+class ObjImporter
+{
+public:
+	static constexpr size_t MIN_CHUNK_SIZE = 1 << 20;
+	static constexpr size_t CHUNKS_PER_THREAD = 4;
+
+	static MeshData import(std::string_view source, JobSystem& jobs);
+};
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+struct ImageData
+{
+	uint32_t width;
+	uint32_t height;
+	std::vector<uint8_t> pixels;
+};
+
+struct TextureData
+{
+	VkFormat format;
+	uint32_t width;
+	uint32_t height;
+	std::vector<std::vector<uint8_t>> levels;
+};
\ No newline at end of file
@@ -0,0 +1,365 @@
+#include "assets/texture_encoder.hpp"
+#include "assets/ktx_file.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+static const uint32_t BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+struct BitWriter
+{
+	uint8_t* data;
+	uint32_t position = 0;
+
+	void write(uint32_t value, uint32_t bits)
+	{
+		for (uint32_t i = 0; i < bits; i++, position++)
+		{
+			if (value >> i & 1)
+				data[position >> 3] |= static_cast<uint8_t>(1 << (position & 7));
+		}
+	}
+};
+
+static float toLinear(uint8_t value)
+{
+	auto c = value / 255.0f;
+	return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+static uint8_t toSrgb(float value)
+{
+	auto c = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+	return static_cast<uint8_t>(std::clamp(std::lround(c * 255.0f), 0l, 255l));
+}
+
+static uint8_t toUnorm(float value)
+{
+	return static_cast<uint8_t>(std::clamp(std::lround(value * 255.0f), 0l, 255l));
+}
+
+static bool isBlockCompressed(VkFormat format)
+{
+	return format != VK_FORMAT_R8G8B8A8_SRGB && format != VK_FORMAT_R8G8B8A8_UNORM;
+}
+
+// Fits the block colors to a line along their principal axis and returns its extreme points
+static void fitEndpoints(const uint8_t (&block)[16][4], uint32_t channels, float (&e0)[4], float (&e1)[4])
+{
+	float mean[4]{};
+	for (auto& pixel : block)
+		for (uint32_t c = 0; c < channels; c++) mean[c] += pixel[c] / 16.0f;
+
+	float covariance[4][4]{};
+	float axis[4]{};
+	for (auto& pixel : block)
+	{
+		for (uint32_t i = 0; i < channels; i++)
+		{
+			for (uint32_t j = 0; j < channels; j++)
+				covariance[i][j] += (pixel[i] - mean[i]) * (pixel[j] - mean[j]);
+			axis[i] = std::max(axis[i], std::abs(pixel[i] - mean[i]));
+		}
+	}
+
+	for (uint32_t iteration = 0; iteration < 8; iteration++)
+	{
+		float next[4]{};
+		auto length = 0.0f;
+		for (uint32_t i = 0; i < channels; i++)
+		{
+			for (uint32_t j = 0; j < channels; j++) next[i] += covariance[i][j] * axis[j];
+			length += next[i] * next[i];
+		}
+		if (length < 1e-6f) break;
+		length = std::sqrt(length);
+		for (uint32_t i = 0; i < channels; i++) axis[i] = next[i] / length;
+	}
+
+	auto minT = std::numeric_limits<float>::max();
+	auto maxT = std::numeric_limits<float>::lowest();
+	for (auto& pixel : block)
+	{
+		auto t = 0.0f;
+		for (uint32_t c = 0; c < channels; c++) t += (pixel[c] - mean[c]) * axis[c];
+		minT = std::min(minT, t);
+		maxT = std::max(maxT, t);
+	}
+	for (uint32_t c = 0; c < 4; c++)
+	{
+		e0[c] = c < channels ? std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f) : 255.0f;
+		e1[c] = c < channels ? std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f) : 255.0f;
+	}
+}
+
+std::vector<ImageData> TextureEncoder::generateMips(const ImageData& image, bool srgb)
+{
+	// Filter in linear space, averaging sRGB values darkens the smaller levels
+	auto width = image.width;
+	auto height = image.height;
+	auto level = std::vector<float>(image.pixels.size());
+	for (size_t i = 0; i < level.size(); i++)
+		level[i] = srgb && i % 4 != 3 ? toLinear(image.pixels[i]) : image.pixels[i] / 255.0f;
+
+	auto mips = std::vector<ImageData>{ image };
+	while (width > 1 || height > 1)
+	{
+		auto mipWidth = std::max(width / 2, 1u);
+		auto mipHeight = std::max(height / 2, 1u);
+		auto mipLevel = std::vector<float>(mipWidth * mipHeight * 4);
+		auto mip = ImageData{ mipWidth, mipHeight, std::vector<uint8_t>(mipLevel.size()) };
+		for (uint32_t y = 0; y < mipHeight; y++)
+		{
+			auto y0 = std::min(y * 2, height - 1);
+			auto y1 = std::min(y * 2 + 1, height - 1);
+			for (uint32_t x = 0; x < mipWidth; x++)
+			{
+				auto x0 = std::min(x * 2, width - 1);
+				auto x1 = std::min(x * 2 + 1, width - 1);
+				for (uint32_t c = 0; c < 4; c++)
+				{
+					auto value = (level[(y0 * width + x0) * 4 + c] + level[(y0 * width + x1) * 4 + c]
+						+ level[(y1 * width + x0) * 4 + c] + level[(y1 * width + x1) * 4 + c]) * 0.25f;
+					auto index = (y * mipWidth + x) * 4 + c;
+					mipLevel[index] = value;
+					mip.pixels[index] = srgb && c != 3 ? toSrgb(value) : toUnorm(value);
+				}
+			}
+		}
+		mips.push_back(std::move(mip));
+		level = std::move(mipLevel);
+		width = mipWidth;
+		height = mipHeight;
+	}
+	return mips;
+}
+
+TextureData TextureEncoder::encode(const std::vector<ImageData>& mips, VkFormat format)
+{
+	auto data = TextureData{ format, mips.front().width, mips.front().height, {} };
+	auto blockSize = KtxFile::getBlockSize(format);
+	for (auto& mip : mips)
+	{
+		if (!isBlockCompressed(format))
+		{
+			data.levels.push_back(mip.pixels);
+			continue;
+		}
+
+		auto blocksX = (mip.width + 3) / 4;
+		auto blocksY = (mip.height + 3) / 4;
+		auto level = std::vector<uint8_t>(blocksX * blocksY * blockSize);
+		for (uint32_t by = 0; by < blocksY; by++)
+		{
+			for (uint32_t bx = 0; bx < blocksX; bx++)
+			{
+				// Edge blocks of small or odd sized levels repeat the last row and column
+				uint8_t block[16][4];
+				for (uint32_t i = 0; i < 16; i++)
+				{
+					auto x = std::min(bx * 4 + i % 4, mip.width - 1);
+					auto y = std::min(by * 4 + i / 4, mip.height - 1);
+					memcpy(block[i], &mip.pixels[(y * mip.width + x) * 4], 4);
+				}
+				encodeBlock(format, block, level.data() + (by * blocksX + bx) * blockSize);
+			}
+		}
+		data.levels.push_back(std::move(level));
+	}
+	return data;
+}
+
+void TextureEncoder::encodeBlock(VkFormat format, const uint8_t (&block)[16][4], uint8_t* output)
+{
+	switch (format)
+	{
+	case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+		encodeBc1(block, output);
+		break;
+	case VK_FORMAT_BC5_UNORM_BLOCK:
+		encodeBc4(block, 0, output);
+		encodeBc4(block, 1, output + 8);
+		break;
+	case VK_FORMAT_BC7_UNORM_BLOCK:
+	case VK_FORMAT_BC7_SRGB_BLOCK:
+		encodeBc7(block, output);
+		break;
+	default:
+		throw std::runtime_error{ "unsupported block format" };
+	}
+}
+
+void TextureEncoder::encodeBc1(const uint8_t (&block)[16][4], uint8_t* output)
+{
+	auto to565 = [](const float (&color)[4])
+	{
+		auto r = static_cast<uint16_t>(std::lround(color[0] * 31.0f / 255.0f));
+		auto g = static_cast<uint16_t>(std::lround(color[1] * 63.0f / 255.0f));
+		auto b = static_cast<uint16_t>(std::lround(color[2] * 31.0f / 255.0f));
+		return static_cast<uint16_t>(r << 11 | g << 5 | b);
+	};
+	auto from565 = [](uint16_t color, float (&result)[4])
+	{
+		auto r = color >> 11 & 31, g = color >> 5 & 63, b = color & 31;
+		result[0] = static_cast<float>(r << 3 | r >> 2);
+		result[1] = static_cast<float>(g << 2 | g >> 4);
+		result[2] = static_cast<float>(b << 3 | b >> 2);
+	};
+
+	float e0[4], e1[4];
+	fitEndpoints(block, 3, e0, e1);
+	auto c0 = to565(e1);
+	auto c1 = to565(e0);
+	if (c0 < c1) std::swap(c0, c1);
+
+	// c0 > c1 selects the opaque four color mode
+	float palette[4][4]{};
+	from565(c0, palette[0]);
+	from565(c1, palette[1]);
+	for (uint32_t c = 0; c < 3; c++)
+	{
+		palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+		palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+	}
+
+	auto indices = uint32_t{};
+	for (uint32_t i = 0; c0 != c1 && i < 16; i++)
+	{
+		auto best = 0u;
+		auto bestError = std::numeric_limits<float>::max();
+		for (uint32_t p = 0; p < 4; p++)
+		{
+			auto error = 0.0f;
+			for (uint32_t c = 0; c < 3; c++) error += (block[i][c] - palette[p][c]) * (block[i][c] - palette[p][c]);
+			if (error < bestError)
+			{
+				bestError = error;
+				best = p;
+			}
+		}
+		indices |= best << (i * 2);
+	}
+
+	memcpy(output, &c0, 2);
+	memcpy(output + 2, &c1, 2);
+	memcpy(output + 4, &indices, 4);
+}
+
+void TextureEncoder::encodeBc4(const uint8_t (&block)[16][4], uint32_t channel, uint8_t* output)
+{
+	auto maxValue = uint8_t{ 0 };
+	auto minValue = uint8_t{ 255 };
+	for (auto& pixel : block)
+	{
+		maxValue = std::max(maxValue, pixel[channel]);
+		minValue = std::min(minValue, pixel[channel]);
+	}
+
+	// max > min selects the eight value mode
+	float palette[8];
+	palette[0] = maxValue;
+	palette[1] = minValue;
+	for (uint32_t p = 2; p < 8; p++)
+		palette[p] = ((8.0f - p) * maxValue + (p - 1.0f) * minValue) / 7.0f;
+
+	output[0] = maxValue;
+	output[1] = minValue;
+	auto writer = BitWriter{ output + 2 };
+	for (auto& pixel : block)
+	{
+		auto best = 0u;
+		auto bestError = std::numeric_limits<float>::max();
+		for (uint32_t p = 0; maxValue != minValue && p < 8; p++)
+		{
+			auto error = std::abs(pixel[channel] - palette[p]);
+			if (error < bestError)
+			{
+				bestError = error;
+				best = p;
+			}
+		}
+		writer.write(best, 3);
+	}
+}
+
+// Mode 6 only: a single subset with 7.7.7.7 endpoints, a p-bit per endpoint and 4 bit indices
+void TextureEncoder::encodeBc7(const uint8_t (&block)[16][4], uint8_t* output)
+{
+	float e0[4], e1[4];
+	fitEndpoints(block, 4, e0, e1);
+
+	uint32_t bestEndpoints[2][4]{};
+	uint32_t bestPbits[2]{};
+	uint32_t bestIndices[16]{};
+	auto bestError = std::numeric_limits<float>::max();
+	for (uint32_t pbits = 0; pbits < 4; pbits++)
+	{
+		uint32_t p[2] = { pbits & 1, pbits >> 1 };
+		uint32_t endpoints[2][4];
+		float expanded[2][4];
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			endpoints[0][c] = static_cast<uint32_t>(std::clamp(std::lround((e0[c] - p[0]) / 2.0f), 0l, 127l));
+			endpoints[1][c] = static_cast<uint32_t>(std::clamp(std::lround((e1[c] - p[1]) / 2.0f), 0l, 127l));
+			expanded[0][c] = static_cast<float>(endpoints[0][c] << 1 | p[0]);
+			expanded[1][c] = static_cast<float>(endpoints[1][c] << 1 | p[1]);
+		}
+
+		float palette[16][4];
+		for (uint32_t i = 0; i < 16; i++)
+			for (uint32_t c = 0; c < 4; c++)
+				palette[i][c] = static_cast<float>(((64 - BC7_WEIGHTS[i]) * static_cast<uint32_t>(expanded[0][c]) + BC7_WEIGHTS[i] * static_cast<uint32_t>(expanded[1][c]) + 32) >> 6);
+
+		uint32_t indices[16];
+		auto totalError = 0.0f;
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			auto pixelError = std::numeric_limits<float>::max();
+			for (uint32_t index = 0; index < 16; index++)
+			{
+				auto error = 0.0f;
+				for (uint32_t c = 0; c < 4; c++) error += (block[i][c] - palette[index][c]) * (block[i][c] - palette[index][c]);
+				if (error < pixelError)
+				{
+					pixelError = error;
+					indices[i] = index;
+				}
+			}
+			totalError += pixelError;
+		}
+
+		if (totalError < bestError)
+		{
+			bestError = totalError;
+			memcpy(bestEndpoints, endpoints, sizeof(endpoints));
+			memcpy(bestPbits, p, sizeof(p));
+			memcpy(bestIndices, indices, sizeof(indices));
+		}
+	}
+
+	// The anchor index is stored without its top bit, flip the line if it is set
+	if (bestIndices[0] & 8)
+	{
+		std::swap(bestEndpoints[0], bestEndpoints[1]);
+		std::swap(bestPbits[0], bestPbits[1]);
+		for (auto& index : bestIndices) index = 15 - index;
+	}
+
+	memset(output, 0, 16);
+	auto writer = BitWriter{ output };
+	writer.write(1 << 6, 7);
+	for (uint32_t c = 0; c < 4; c++)
+	{
+		writer.write(bestEndpoints[0][c], 7);
+		writer.write(bestEndpoints[1][c], 7);
+	}
+	writer.write(bestPbits[0], 1);
+	writer.write(bestPbits[1], 1);
+	writer.write(bestIndices[0], 3);
+	for (uint32_t i = 1; i < 16; i++)
+		writer.write(bestIndices[i], 4);
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "assets/texture_data.hpp"
+
+#include <vulkan/vulkan.h>
+
+class TextureEncoder
+{
+public:
+	static std::vector<ImageData> generateMips(const ImageData& image, bool srgb);
+	static TextureData encode(const std::vector<ImageData>& mips, VkFormat format);
+
+private:
+	static void encodeBlock(VkFormat format, const uint8_t (&block)[16][4], uint8_t* output);
+	static void encodeBc1(const uint8_t (&block)[16][4], uint8_t* output);
+	static void encodeBc4(const uint8_t (&block)[16][4], uint32_t channel, uint8_t* output);
+	static void encodeBc7(const uint8_t (&block)[16][4], uint8_t* output);
+};
\ No newline at end of file
@@ -0,0 +1,244 @@
+#include "core/job_system.hpp"
+#include "core/profiler.hpp"
+
+#include <cassert>
+#include <utility>
+
+namespace
+{
+	thread_local JobSystem* t_system = nullptr;
+	thread_local uint32_t t_index = 0;
+}
+
+bool JobCounter::isDone() const
+{
+	return m_value.load(std::memory_order_acquire) == 0;
+}
+
+JobSystem::~JobSystem()
+{
+	destroy();
+}
+
+// Queued jobs that did not start yet are dropped
+void JobSystem::destroy()
+{
+	if (m_initialized)
+	{
+		{
+			auto lock = std::lock_guard{ m_sleepMutex };
+			m_stopping = true;
+		}
+		m_sleepCondition.notify_all();
+		for (auto& worker : m_workers)
+			worker.join();
+		m_workers.clear();
+		m_queues.clear();
+		m_mainQueue.entries.clear();
+		if (t_system == this) t_system = nullptr;
+	}
+	m_initialized = false;
+}
+
+// The calling thread becomes the main thread and counts towards threadCount, it runs jobs whenever it waits or pumps
+void JobSystem::init(uint32_t threadCount)
+{
+	assert(!m_initialized);
+	m_initialized = true;
+	m_stopping = false;
+	m_queued = 0;
+	m_executed = 0;
+	m_stolen = 0;
+	m_mainThread = std::this_thread::get_id();
+	t_system = this;
+	t_index = 0;
+
+	if (threadCount == 0) threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	auto workerCount = threadCount - 1;
+	for (uint32_t i = 0; i < workerCount + 2; i++)
+		m_queues.push_back(std::make_unique<Queue>());
+	for (uint32_t i = 1; i <= workerCount; i++)
+		m_workers.emplace_back(&JobSystem::work, this, i);
+}
+
+void JobSystem::run(Job job, JobCounter* counter, JobAffinity affinity)
+{
+	assert(m_initialized);
+	if (counter) counter->m_value.fetch_add(1, std::memory_order_relaxed);
+	push({ std::move(job), counter }, affinity);
+}
+
+// The job is counted right away, so waiting on its counter also covers the time it is held back
+void JobSystem::after(JobCounter& dependency, Job job, JobCounter* counter, JobAffinity affinity)
+{
+	assert(m_initialized);
+	if (counter) counter->m_value.fetch_add(1, std::memory_order_relaxed);
+	{
+		auto lock = std::lock_guard{ dependency.m_mutex };
+		if (dependency.m_value.load(std::memory_order_acquire) > 0)
+		{
+			dependency.m_continuations.push_back({ std::move(job), counter, affinity });
+			return;
+		}
+	}
+	push({ std::move(job), counter }, affinity);
+}
+
+void JobSystem::wait(JobCounter& counter)
+{
+	assert(m_initialized);
+	auto index = getIndex();
+	while (!counter.isDone())
+	{
+		if (!execute(index)) std::this_thread::yield();
+	}
+
+	// The last job may still hold the lock after its decrement, the counter must outlive that
+	auto lock = std::lock_guard{ counter.m_mutex };
+	if (counter.m_exception)
+		std::rethrow_exception(std::exchange(counter.m_exception, nullptr));
+}
+
+// Runs everything that has to happen on the main thread, called once per frame
+void JobSystem::pump()
+{
+	assert(m_initialized);
+	assert(isMainThread());
+	auto entry = Entry{};
+	while (popFront(m_mainQueue, entry))
+		invoke(entry);
+}
+
+uint32_t JobSystem::getThreadCount()
+{
+	assert(m_initialized);
+	return static_cast<uint32_t>(m_workers.size()) + 1;
+}
+
+bool JobSystem::isMainThread()
+{
+	return std::this_thread::get_id() == m_mainThread;
+}
+
+JobStats JobSystem::getStats()
+{
+	return { m_executed.load(std::memory_order_relaxed), m_stolen.load(std::memory_order_relaxed) };
+}
+
+void JobSystem::work(uint32_t index)
+{
+	ProfilerThreadName("job worker");
+	t_system = this;
+	t_index = index;
+	while (true)
+	{
+		if (execute(index)) continue;
+		auto lock = std::unique_lock{ m_sleepMutex };
+		m_sleepCondition.wait(lock, [this] { return m_stopping || m_queued.load() > 0; });
+		if (m_stopping) return;
+	}
+}
+
+void JobSystem::push(Entry entry, JobAffinity affinity)
+{
+	if (affinity == JobAffinity::Main)
+	{
+		auto lock = std::lock_guard{ m_mainQueue.mutex };
+		m_mainQueue.entries.push_back(std::move(entry));
+		return;
+	}
+
+	{
+		auto& queue = *m_queues[getIndex()];
+		auto lock = std::lock_guard{ queue.mutex };
+		queue.entries.push_back(std::move(entry));
+	}
+	m_queued.fetch_add(1);
+
+	// Taking the lock orders the increment against a worker that just found nothing and is about to sleep
+	{
+		auto lock = std::lock_guard{ m_sleepMutex };
+	}
+	m_sleepCondition.notify_one();
+}
+
+// Own work newest first while it is still in cache, then the oldest work of everyone else
+bool JobSystem::execute(uint32_t index)
+{
+	auto entry = Entry{};
+	if (index == 0 && t_system == this && popFront(m_mainQueue, entry))
+	{
+		invoke(entry);
+		return true;
+	}
+
+	auto found = popBack(*m_queues[index], entry) || popFront(*m_queues.back(), entry);
+	auto threadQueues = m_queues.size() - 1;
+	for (size_t i = 1; !found && i <= threadQueues; i++)
+	{
+		auto victim = (index + i) % threadQueues;
+		if (victim == index) continue;
+		found = popFront(*m_queues[victim], entry);
+		if (found) m_stolen.fetch_add(1, std::memory_order_relaxed);
+	}
+	if (!found) return false;
+	m_queued.fetch_sub(1);
+	invoke(entry);
+	return true;
+}
+
+void JobSystem::invoke(Entry& entry)
+{
+	if (entry.counter)
+	{
+		try
+		{
+			entry.job();
+		}
+		catch (...)
+		{
+			auto lock = std::lock_guard{ entry.counter->m_mutex };
+			if (!entry.counter->m_exception) entry.counter->m_exception = std::current_exception();
+		}
+	}
+	else entry.job();
+	m_executed.fetch_add(1, std::memory_order_relaxed);
+	finish(entry.counter);
+}
+
+bool JobSystem::popBack(Queue& queue, Entry& entry)
+{
+	auto lock = std::lock_guard{ queue.mutex };
+	if (queue.entries.empty()) return false;
+	entry = std::move(queue.entries.back());
+	queue.entries.pop_back();
+	return true;
+}
+
+bool JobSystem::popFront(Queue& queue, Entry& entry)
+{
+	auto lock = std::lock_guard{ queue.mutex };
+	if (queue.entries.empty()) return false;
+	entry = std::move(queue.entries.front());
+	queue.entries.pop_front();
+	return true;
+}
+
+void JobSystem::finish(JobCounter* counter)
+{
+	if (!counter) return;
+	auto continuations = std::vector<JobCounter::Continuation>{};
+	{
+		auto lock = std::lock_guard{ counter->m_mutex };
+		if (counter->m_value.fetch_sub(1, std::memory_order_acq_rel) > 1) return;
+		continuations.swap(counter->m_continuations);
+	}
+	for (auto& continuation : continuations)
+		push({ std::move(continuation.job), continuation.counter }, continuation.affinity);
+}
+
+// Threads that do not belong to this system share the last deque
+uint32_t JobSystem::getIndex()
+{
+	return t_system == this ? t_index : static_cast<uint32_t>(m_queues.size()) - 1;
+}
\ No newline at end of file
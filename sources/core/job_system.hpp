@@ -0,0 +1,137 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Jobs tagged Main only ever run on the thread that initialized the system, for windowing calls
+enum class JobAffinity
+{
+	Any,
+	Main
+};
+
+// Number of unfinished jobs in a batch. Jobs queued with after start once it drops to zero,
+// the first exception thrown by a counted job is rethrown by wait
+class JobCounter
+{
+public:
+	bool isDone() const;
+
+private:
+	friend class JobSystem;
+
+	struct Continuation
+	{
+		std::function<void()> job;
+		JobCounter* counter;
+		JobAffinity affinity;
+	};
+
+	std::atomic<uint32_t> m_value{};
+	std::mutex m_mutex{};
+	std::vector<Continuation> m_continuations{};
+	std::exception_ptr m_exception{};
+};
+
+struct JobStats
+{
+	uint64_t executed;
+	uint64_t stolen;
+};
+
+// Work stealing scheduler. Every thread pushes and pops the back of its own deque while idle workers steal
+// from the front of the others, threads outside the system share one extra deque. Waiting never blocks,
+// the waiting thread keeps running jobs until its counter is done
+class JobSystem
+{
+public:
+	using Job = std::function<void()>;
+
+	~JobSystem();
+	void init(uint32_t threadCount = 0);
+	void destroy();
+
+	void run(Job job, JobCounter* counter = nullptr, JobAffinity affinity = JobAffinity::Any);
+	void after(JobCounter& dependency, Job job, JobCounter* counter = nullptr, JobAffinity affinity = JobAffinity::Any);
+	void wait(JobCounter& counter);
+	void pump();
+
+	template<typename Function>
+	void parallelFor(size_t count, size_t grain, Function&& function);
+
+	uint32_t getThreadCount();
+	bool isMainThread();
+	JobStats getStats();
+
+private:
+	struct Entry
+	{
+		Job job;
+		JobCounter* counter;
+	};
+
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<Entry> entries;
+	};
+
+	void work(uint32_t index);
+	void push(Entry entry, JobAffinity affinity);
+	bool execute(uint32_t index);
+	void invoke(Entry& entry);
+	bool popBack(Queue& queue, Entry& entry);
+	bool popFront(Queue& queue, Entry& entry);
+	void finish(JobCounter* counter);
+	uint32_t getIndex();
+
+private:
+	bool m_initialized = false;
+	std::thread::id m_mainThread{};
+	std::vector<std::thread> m_workers{};
+	// One per worker with the main thread first, the last one is shared by outside threads
+	std::vector<std::unique_ptr<Queue>> m_queues{};
+	Queue m_mainQueue{};
+	std::atomic<uint32_t> m_queued{};
+	std::mutex m_sleepMutex{};
+	std::condition_variable m_sleepCondition{};
+	bool m_stopping = false;
+	std::atomic<uint64_t> m_executed{};
+	std::atomic<uint64_t> m_stolen{};
+};
+
+// Runs function(i) for every index, grain indices per job. The calling thread takes the first range itself
+template<typename Function>
+void JobSystem::parallelFor(size_t count, size_t grain, Function&& function)
+{
+	if (count == 0) return;
+	grain = std::max<size_t>(grain, 1);
+	auto counter = JobCounter{};
+	for (auto begin = grain; begin < count; begin += grain)
+	{
+		run([&function, begin, end = std::min(begin + grain, count)] {
+			for (auto i = begin; i < end; i++) function(i);
+		}, &counter);
+	}
+
+	// Jobs still reference the counter and function, so an exception here waits for them as well
+	try
+	{
+		for (size_t i = 0; i < std::min(grain, count); i++) function(i);
+	}
+	catch (...)
+	{
+		auto lock = std::lock_guard{ counter.m_mutex };
+		if (!counter.m_exception) counter.m_exception = std::current_exception();
+	}
+	wait(counter);
+}
\ No newline at end of file
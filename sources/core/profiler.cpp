@@ -0,0 +1,43 @@
+#include "core/profiler.hpp"
+
+#ifdef VK_PROFILING
+#include <cstdlib>
+#include <new>
+
+// Every heap allocation shows up in the memory view. The secure variants tolerate allocations that
+// happen before the profiler started or after it shut down
+void* operator new(std::size_t size)
+{
+	auto* pointer = std::malloc(size > 0 ? size : 1);
+	if (pointer == nullptr)
+		throw std::bad_alloc{};
+	TracySecureAlloc(pointer, size);
+	return pointer;
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+	TracySecureFree(pointer);
+	std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+	operator delete(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+	operator delete(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+	operator delete(pointer);
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+
+// Tracy is only pulled in when the build enables profiling, otherwise every macro expands to nothing
+// and the same code compiles into tools that do not link the client
+#ifdef VK_PROFILING
+#include <tracy/Tracy.hpp>
+#define ProfilerThreadName(name) tracy::SetThreadName(name)
+#else
+#define ZoneScoped
+#define ZoneScopedN(name)
+#define FrameMark
+#define FrameMarkNamed(name)
+#define TracyPlot(name, value)
+#define TracyPlotConfig(name, type, step, fill, color)
+#define TracySecureAlloc(pointer, size)
+#define TracySecureFree(pointer)
+#define TracyAllocN(pointer, size, name)
+#define TracyFreeN(pointer, name)
+#define TracyLockable(type, name) type name
+#define TracyLockableN(type, name, description) type name
+#define LockableBase(type) type
+#define LockMark(name)
+#define ProfilerThreadName(name)
+#endif
\ No newline at end of file
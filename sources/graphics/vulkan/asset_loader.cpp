@@ -0,0 +1,246 @@
+#include "graphics/vulkan/asset_loader.hpp"
+#include "graphics/vulkan/locator.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+AssetLoader::~AssetLoader()
+{
+	destroy();
+}
+
+void AssetLoader::destroy()
+{
+	if (m_initialized)
+	{
+		// Jobs that did not start yet return right away, the ones already decoding are waited for
+		m_stopping = true;
+		m_jobSystem->wait(m_counter);
+
+		// Pending resources are dropped without completing, their owners release whatever record created
+		for (auto& batch : m_batches)
+		{
+			vkWaitForFences(m_device->getDevice(), 1, &batch.fence, VK_TRUE, UINT64_MAX);
+			vkDestroyFence(m_device->getDevice(), batch.fence, nullptr);
+		}
+		m_batches.clear();
+		m_decoded.clear();
+		m_error = nullptr;
+
+		vkDestroyImageView(m_device->getDevice(), m_placeholderCubeView, nullptr);
+		vkDestroyImageView(m_device->getDevice(), m_placeholderView, nullptr);
+		vkDestroyImage(m_device->getDevice(), m_placeholderImage, nullptr);
+		m_device->getMemoryTracker().free(m_placeholderMemory);
+		vkDestroyCommandPool(m_device->getDevice(), m_commandPool, nullptr);
+	}
+	m_initialized = false;
+}
+
+void AssetLoader::init()
+{
+	assert(!m_initialized);
+	m_initialized = true;
+	m_device = &Locator::getDevice();
+	m_jobSystem = &Locator::getJobSystem();
+	m_stopping = false;
+	createCommandPool();
+	createPlaceholder();
+	Locator::setAssetLoader(this);
+}
+
+void AssetLoader::createCommandPool()
+{
+	auto createInfo = VkCommandPoolCreateInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	createInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	createInfo.queueFamilyIndex = m_device->findQueueFamilies(m_device->getGpu()).graphics.value();
+	if (vkCreateCommandPool(m_device->getDevice(), &createInfo, nullptr, &m_commandPool) != VK_SUCCESS)
+		throw std::runtime_error{ "failed to create asset upload command pool" };
+}
+
+void AssetLoader::createPlaceholder()
+{
+	// A single grey texel with six layers backs both plain and cubemap textures until they are resident
+	const uint32_t layers = 6;
+	const auto format = VK_FORMAT_R8G8B8A8_UNORM;
+	auto stagingBuffer = Buffer{};
+	stagingBuffer.init(layers * 4, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		MemoryCategory::Staging, "placeholder"
+	);
+	auto* data = static_cast<uint8_t*>(stagingBuffer.map());
+	for (uint32_t i = 0; i < layers; i++)
+		memcpy(data + i * 4, "\x80\x80\x80\xff", 4);
+	stagingBuffer.unmap();
+
+	m_device->createImage(1, 1, 1, layers, format, VK_IMAGE_TILING_OPTIMAL,
+		VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_placeholderImage, m_placeholderMemory, MemoryCategory::Texture, "placeholder"
+	);
+	m_device->transitionImageLayout(m_placeholderImage, layers, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1);
+	m_device->copyBufferToImage(stagingBuffer, m_placeholderImage, 1, 1, layers);
+	m_device->transitionImageLayout(m_placeholderImage, layers, format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1);
+	m_placeholderView = m_device->createImageView(m_placeholderImage, format, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+	m_placeholderCubeView = m_device->createImageView(m_placeholderImage, layers, format, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+
+	auto createInfo = SamplerCache::getDefaultInfo();
+	createInfo.magFilter = VK_FILTER_NEAREST;
+	createInfo.minFilter = VK_FILTER_NEAREST;
+	createInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	createInfo.anisotropyEnable = VK_FALSE;
+	m_placeholderSampler = m_device->getSamplerCache().get(createInfo);
+}
+
+void AssetLoader::load(Job job)
+{
+	assert(m_initialized);
+	m_pending++;
+	m_jobSystem->run([this, job = std::move(job)] { decode(job); }, &m_counter);
+}
+
+// Starts the job once everything counted by dependency finished, for assets assembled from several decodes
+void AssetLoader::load(JobCounter& dependency, Job job)
+{
+	assert(m_initialized);
+	m_pending++;
+	m_jobSystem->after(dependency, [this, job = std::move(job)] { decode(job); }, &m_counter);
+}
+
+// Part of a decode that does not produce an upload by itself, failures surface in update like any other
+void AssetLoader::run(JobSystem::Job job, JobCounter& counter)
+{
+	assert(m_initialized);
+	m_jobSystem->run([this, job = std::move(job)] {
+		if (m_stopping) return;
+		try
+		{
+			ZoneScopedN("asset decode");
+			job();
+		}
+		catch (...)
+		{
+			auto lock = std::lock_guard{ m_mutex };
+			m_error = std::current_exception();
+		}
+	}, &counter);
+}
+
+void AssetLoader::decode(const Job& job)
+{
+	if (m_stopping) return;
+	try
+	{
+		auto upload = AssetUpload{};
+		{
+			ZoneScopedN("asset decode");
+			upload = job();
+		}
+		if (!upload.record && !upload.complete)
+		{
+			m_pending--;
+			return;
+		}
+		auto lock = std::lock_guard{ m_mutex };
+		m_decoded.push_back(std::move(upload));
+	}
+	catch (...)
+	{
+		auto lock = std::lock_guard{ m_mutex };
+		m_error = std::current_exception();
+	}
+}
+
+// Called after the frame fence was waited on, so descriptors the completions rewrite are not in use
+void AssetLoader::update()
+{
+	assert(m_initialized);
+	retire();
+	submit();
+}
+
+void AssetLoader::submit()
+{
+	auto uploads = std::vector<AssetUpload>{};
+	{
+		auto lock = std::lock_guard{ m_mutex };
+		if (m_error)
+			std::rethrow_exception(std::exchange(m_error, nullptr));
+		uploads.swap(m_decoded);
+	}
+	if (uploads.empty()) return;
+
+	auto batch = Batch{};
+	auto allocInfo = VkCommandBufferAllocateInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocInfo.commandPool = m_commandPool;
+	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocInfo.commandBufferCount = 1;
+	if (vkAllocateCommandBuffers(m_device->getDevice(), &allocInfo, &batch.commandBuffer) != VK_SUCCESS)
+		throw std::runtime_error{ "failed to allocate asset upload command buffer" };
+
+	auto beginInfo = VkCommandBufferBeginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(batch.commandBuffer, &beginInfo);
+	for (auto& upload : uploads)
+		if (upload.record) upload.record(batch.commandBuffer);
+	vkEndCommandBuffer(batch.commandBuffer);
+
+	auto fenceInfo = VkFenceCreateInfo{};
+	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	if (vkCreateFence(m_device->getDevice(), &fenceInfo, nullptr, &batch.fence) != VK_SUCCESS)
+		throw std::runtime_error{ "failed to create asset upload fence" };
+
+	auto submitInfo = VkSubmitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &batch.commandBuffer;
+	if (vkQueueSubmit(m_device->getGraphicsQueue(), 1, &submitInfo, batch.fence) != VK_SUCCESS)
+		throw std::runtime_error{ "failed to submit asset uploads" };
+
+	batch.uploads = std::move(uploads);
+	m_batches.push_back(std::move(batch));
+}
+
+void AssetLoader::retire()
+{
+	std::erase_if(m_batches, [this](Batch& batch) {
+		if (vkGetFenceStatus(m_device->getDevice(), batch.fence) != VK_SUCCESS)
+			return false;
+
+		for (auto& upload : batch.uploads)
+		{
+			if (upload.complete) upload.complete();
+			m_pending--;
+		}
+		vkFreeCommandBuffers(m_device->getDevice(), m_commandPool, 1, &batch.commandBuffer);
+		vkDestroyFence(m_device->getDevice(), batch.fence, nullptr);
+		return true;
+	});
+}
+
+uint32_t AssetLoader::getPendingCount()
+{
+	assert(m_initialized);
+	return m_pending;
+}
+
+VkImageView AssetLoader::getPlaceholderView()
+{
+	assert(m_initialized);
+	return m_placeholderView;
+}
+
+VkImageView AssetLoader::getPlaceholderCubeView()
+{
+	assert(m_initialized);
+	return m_placeholderCubeView;
+}
+
+VkSampler AssetLoader::getPlaceholderSampler()
+{
+	assert(m_initialized);
+	return m_placeholderSampler;
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "graphics/vulkan/context/device.hpp"
+#include "core/job_system.hpp"
+#include "core/profiler.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Returned by a decode job. record runs on the main thread and copies the staging memory the job filled,
+// complete runs once the upload fence signalled and swaps the placeholder for the real resource
+struct AssetUpload
+{
+	std::function<void(VkCommandBuffer)> record;
+	std::function<void()> complete;
+};
+
+// Decodes assets on the job system while frames keep rendering with placeholder resources.
+// Everything decoded since the last update is uploaded with a single submission and fence
+class AssetLoader
+{
+public:
+	using Job = std::function<AssetUpload()>;
+
+	~AssetLoader();
+	void init();
+	void destroy();
+
+	void load(Job job);
+	void load(JobCounter& dependency, Job job);
+	void run(JobSystem::Job job, JobCounter& counter);
+	void update();
+	uint32_t getPendingCount();
+
+	VkImageView getPlaceholderView();
+	VkImageView getPlaceholderCubeView();
+	VkSampler getPlaceholderSampler();
+
+private:
+	struct Batch
+	{
+		VkCommandBuffer commandBuffer;
+		VkFence fence;
+		std::vector<AssetUpload> uploads;
+	};
+
+	void createCommandPool();
+	void createPlaceholder();
+	void decode(const Job& job);
+	void submit();
+	void retire();
+
+private:
+	bool m_initialized = false;
+	Device* m_device{};
+	VkCommandPool m_commandPool{};
+	VkImage m_placeholderImage{};
+	VkDeviceMemory m_placeholderMemory{};
+	VkImageView m_placeholderView{};
+	VkImageView m_placeholderCubeView{};
+	VkSampler m_placeholderSampler{};
+
+	JobSystem* m_jobSystem{};
+	JobCounter m_counter{};
+	TracyLockableN(std::mutex, m_mutex, "asset loader");
+	std::vector<AssetUpload> m_decoded{};
+	std::exception_ptr m_error{};
+	std::atomic<uint32_t> m_pending{};
+	std::atomic<bool> m_stopping = false;
+	std::vector<Batch> m_batches{};
+};
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include "graphics/vulkan/asset_manager.hpp"
+#include "graphics/vulkan/locator.hpp"
+
+#include <cmrc/cmrc.hpp>
+CMRC_DECLARE(models);
+CMRC_DECLARE(images);
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace
+{
+	// Workers and pending uploads refer to an asset through a raw pointer until it settles
+	bool isBusy(Mesh& mesh)
+	{
+		return !mesh.isReady();
+	}
+
+	bool isBusy(ImageTexture& texture)
+	{
+		return !texture.isReady() || texture.isStreaming();
+	}
+}
+
+uint64_t AssetManager::hashContent(std::span<const char> content)
+{
+	auto hash = uint64_t{ 0x9e3779b97f4a7c15 } ^ content.size();
+	auto words = content.size() / 8;
+	for (size_t i = 0; i < words; i++)
+	{
+		uint64_t word;
+		memcpy(&word, content.data() + i * 8, 8);
+		hash = (hash ^ word) * 0xff51afd7ed558ccd;
+		hash ^= hash >> 32;
+	}
+	for (auto i = words * 8; i < content.size(); i++)
+		hash = (hash ^ static_cast<uint8_t>(content[i])) * 0xff51afd7ed558ccd;
+	return hash ^ (hash >> 29);
+}
+
+AssetManager::~AssetManager()
+{
+	destroy();
+}
+
+void AssetManager::destroy()
+{
+	if (m_initialized)
+	{
+		m_meshes = {};
+		m_textures = {};
+	}
+	m_initialized = false;
+}
+
+void AssetManager::init()
+{
+	assert(!m_initialized);
+	m_initialized = true;
+	m_pathHits = 0;
+	m_contentHits = 0;
+	Locator::setAssetManager(this);
+}
+
+MeshPtr AssetManager::getMesh(const std::string& modelPath)
+{
+	assert(m_initialized);
+	return get(m_meshes, modelPath,
+		[&] { auto file = cmrc::models::get_filesystem().open(modelPath); return std::span<const char>{ file.begin(), file.size() }; },
+		[&] { auto mesh = std::make_shared<Mesh>(); mesh->init(modelPath); return mesh; });
+}
+
+TexturePtr AssetManager::getTexture(const std::string& imagePath)
+{
+	assert(m_initialized);
+	return get(m_textures, imagePath,
+		[&] { auto file = cmrc::images::get_filesystem().open(imagePath); return std::span<const char>{ file.begin(), file.size() }; },
+		[&] { auto texture = std::make_shared<ImageTexture>(); texture->init(imagePath, Locator::getDescriptorPool().createSet(2)); return texture; });
+}
+
+// Cooked files are derived from their source, so hashing the source identifies the asset either way
+template<typename T, typename Open, typename Load>
+std::shared_ptr<T> AssetManager::get(Cache<T>& cache, const std::string& path, Open&& open, Load&& load)
+{
+	if (auto asset = cache.paths[path].lock())
+	{
+		m_pathHits++;
+		return asset;
+	}
+
+	auto hash = hashContent(open());
+	auto asset = cache.contents[hash].lock();
+	if (asset)
+		m_contentHits++;
+	else
+	{
+		asset = load();
+		cache.contents[hash] = asset;
+		if (isBusy(*asset)) cache.loading.push_back(asset);
+	}
+	cache.paths[path] = asset;
+	return asset;
+}
+
+void AssetManager::update()
+{
+	assert(m_initialized);
+	sweep(m_meshes);
+	sweep(m_textures);
+}
+
+template<typename T>
+void AssetManager::sweep(Cache<T>& cache)
+{
+	// Streaming starts long after the first load settled, so live assets are pinned again when they get busy
+	std::erase_if(cache.loading, [](auto& asset) { return !isBusy(*asset); });
+	for (auto& [hash, entry] : cache.contents)
+		if (auto asset = entry.lock(); asset && isBusy(*asset) && std::ranges::find(cache.loading, asset) == cache.loading.end())
+			cache.loading.push_back(asset);
+	std::erase_if(cache.paths, [](auto& entry) { return entry.second.expired(); });
+	std::erase_if(cache.contents, [](auto& entry) { return entry.second.expired(); });
+}
+
+template<typename T>
+uint32_t AssetManager::countReferences(Cache<T>& cache)
+{
+	auto references = uint32_t{};
+	for (auto& [hash, asset] : cache.contents)
+		references += static_cast<uint32_t>(asset.use_count());
+	return references - static_cast<uint32_t>(cache.loading.size());
+}
+
+AssetStats AssetManager::getStats()
+{
+	assert(m_initialized);
+	auto stats = AssetStats{};
+	stats.meshCount = static_cast<uint32_t>(std::ranges::count_if(m_meshes.contents, [](auto& entry) { return !entry.second.expired(); }));
+	stats.textureCount = static_cast<uint32_t>(std::ranges::count_if(m_textures.contents, [](auto& entry) { return !entry.second.expired(); }));
+	stats.meshReferences = countReferences(m_meshes);
+	stats.textureReferences = countReferences(m_textures);
+	stats.pathHits = m_pathHits;
+	stats.contentHits = m_contentHits;
+	return stats;
+}
\ No newline at end of file
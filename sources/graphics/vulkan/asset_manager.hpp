@@ -0,0 +1,65 @@
+#pragma once
+
+#include "graphics/vulkan/mesh.hpp"
+#include "graphics/vulkan/image/image_texture.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using MeshPtr = std::shared_ptr<Mesh>;
+using TexturePtr = std::shared_ptr<ImageTexture>;
+
+struct AssetStats
+{
+	uint32_t meshCount;
+	uint32_t textureCount;
+	uint32_t meshReferences;
+	uint32_t textureReferences;
+	uint64_t pathHits;
+	uint64_t contentHits; // different paths resolved to an already loaded asset with the same bytes
+};
+
+// Hands out shared meshes and textures keyed by path and by source content hash. The cache only holds weak
+// references, so an asset and its gpu memory go away with its last user. Assets are kept alive until their
+// upload finished, because pending loads refer to them
+class AssetManager
+{
+public:
+	static uint64_t hashContent(std::span<const char> content);
+
+	~AssetManager();
+	void init();
+	void destroy();
+
+	MeshPtr getMesh(const std::string& modelPath);
+	TexturePtr getTexture(const std::string& imagePath);
+	void update();
+	AssetStats getStats();
+
+private:
+	template<typename T>
+	struct Cache
+	{
+		std::unordered_map<std::string, std::weak_ptr<T>> paths;
+		std::unordered_map<uint64_t, std::weak_ptr<T>> contents;
+		std::vector<std::shared_ptr<T>> loading;
+	};
+
+	template<typename T, typename Open, typename Load>
+	std::shared_ptr<T> get(Cache<T>& cache, const std::string& path, Open&& open, Load&& load);
+	template<typename T>
+	void sweep(Cache<T>& cache);
+	template<typename T>
+	uint32_t countReferences(Cache<T>& cache);
+
+private:
+	bool m_initialized = false;
+	Cache<Mesh> m_meshes{};
+	Cache<ImageTexture> m_textures{};
+	uint64_t m_pathHits{};
+	uint64_t m_contentHits{};
+};
\ No newline at end of file
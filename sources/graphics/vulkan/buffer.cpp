@@ -13,21 +13,20 @@ void Buffer::destroy()
 {
 	if (m_initialized)
 	{
-		vkDestroyBuffer(m_device->getDevice(), m_buffer, nullptr);
-		vkFreeMemory(m_device->getDevice(), m_bufferMemory, nullptr);
+		m_device->getDeletionQueue().releaseBuffer(m_buffer, m_bufferMemory);
 	}
 	m_initialized = false;
 }
 
-void Buffer::init(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties)
+void Buffer::init(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, MemoryCategory category, const std::string& name)
 {
 	assert(!m_initialized);
 	m_initialized = true;
 	m_device = &Locator::getDevice();
-	createBuffer(size, usage, properties);
+	createBuffer(size, usage, properties, category, name);
 }
 
-void Buffer::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties)
+void Buffer::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, MemoryCategory category, const std::string& name)
 {
 	auto createInfo = VkBufferCreateInfo{};
 	createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -36,17 +35,12 @@ void Buffer::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryP
 	createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 	if (vkCreateBuffer(m_device->getDevice(), &createInfo, nullptr, &m_buffer) != VK_SUCCESS)
 		throw std::runtime_error{ "failed to create vertex buffer" };
+	m_device->setObjectName(VK_OBJECT_TYPE_BUFFER, reinterpret_cast<uint64_t>(m_buffer), name);
 
 	auto memReq = VkMemoryRequirements{};
 	vkGetBufferMemoryRequirements(m_device->getDevice(), m_buffer, &memReq);
 	m_size = memReq.size;
-
-	auto allocInfo = VkMemoryAllocateInfo{};
-	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	allocInfo.allocationSize = m_size;
-	allocInfo.memoryTypeIndex = m_device->findMemoryType(memReq.memoryTypeBits, properties);
-	if (vkAllocateMemory(m_device->getDevice(), &allocInfo, nullptr, &m_bufferMemory) != VK_SUCCESS)
-		throw std::runtime_error{ "failed to allocate vertex buffer memory" };
+	m_bufferMemory = m_device->getMemoryTracker().allocate(memReq, properties, category, name);
 
 	vkBindBufferMemory(m_device->getDevice(), m_buffer, m_bufferMemory, 0);
 }
@@ -1,14 +1,18 @@
 #pragma once
 
+#include "graphics/vulkan/memory_tracker.hpp"
+
 #include <vulkan/vulkan.h>
 
+#include <string>
+
 class Device;
 
 class Buffer
 {
 public:
 	~Buffer();
-	void init(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties);
+	void init(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, MemoryCategory category, const std::string& name);
 	void destroy();
 
 	void* map();
@@ -17,7 +21,7 @@ public:
 	VkDeviceSize getSize();
 	
 private:
-	void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties);
+	void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, MemoryCategory category, const std::string& name);
 
 private:
 	bool m_initialized = false;
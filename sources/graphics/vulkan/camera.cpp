@@ -3,6 +3,19 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <chrono>
 
+static float halton(uint32_t index, uint32_t base)
+{
+    auto result = 0.0f;
+    auto fraction = 1.0f;
+    while (index > 0)
+    {
+        fraction /= base;
+        result += fraction * (index % base);
+        index /= base;
+    }
+    return result;
+}
+
 Camera::Camera()
 {
     m_position = { 0.0f, 2.0f, 4.0f };
@@ -40,12 +53,62 @@ void Camera::rotate(glm::vec2 rotation, float delta)
     updateCamera();
 }
 
+void Camera::jitter(uint32_t width, uint32_t height)
+{
+    m_jitterIndex = m_jitterIndex % JITTER_PHASES + 1;
+    auto offset = glm::vec2{ halton(m_jitterIndex, 2), halton(m_jitterIndex, 3) } - 0.5f;
+    m_jitter = offset * 2.0f / glm::vec2{ width, height };
+}
+
+void Camera::resetJitter()
+{
+    m_jitterIndex = 0;
+    m_jitter = {};
+}
+
 glm::mat4 Camera::getViewMatrix()
 {
     return glm::lookAt(m_position, m_position + m_front, m_up);
 }
 
+glm::mat4 Camera::getProjMatrix(float aspect, bool jittered)
+{
+    auto proj = glm::perspective(glm::radians(FOV), aspect, NEAR, FAR);
+    proj[1][1] *= -1;
+    if (jittered)
+        proj = glm::translate(glm::mat4{ 1.0f }, glm::vec3{ m_jitter, 0.0f }) * proj;
+    return proj;
+}
+
+glm::vec2 Camera::getJitter()
+{
+    return m_jitter;
+}
+
 glm::vec3 Camera::getPosition()
 {
     return m_position;
+}
+
+CameraState Camera::getState()
+{
+    return { m_position, m_yaw, m_pitch };
+}
+
+void Camera::setState(const CameraState& state)
+{
+    m_position = state.position;
+    m_yaw = state.yaw;
+    m_pitch = state.pitch;
+    updateCamera();
+}
+
+float Camera::getNear()
+{
+    return NEAR;
+}
+
+float Camera::getFar()
+{
+    return FAR;
 }
\ No newline at end of file
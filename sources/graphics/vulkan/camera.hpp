@@ -2,14 +2,30 @@
 
 #include <glm/glm.hpp>
 
+#include <cstdint>
+
+// The part of the camera the simulation owns, jitter stays with the renderer
+struct CameraState
+{
+	glm::vec3 position;
+	float yaw;
+	float pitch;
+};
+
 class Camera
 {
 public:
 	Camera();
 	void move(glm::vec3 direction, float delta);
 	void rotate(glm::vec2 rotation, float delta);
+	void jitter(uint32_t width, uint32_t height);
+	void resetJitter();
 	glm::mat4 getViewMatrix();
+	glm::mat4 getProjMatrix(float aspect, bool jittered = true);
+	glm::vec2 getJitter();
 	glm::vec3 getPosition();
+	float getNear();
+	float getFar();
 
 private:
 	void updateCamera();
@@ -19,8 +35,14 @@ private:
 	glm::vec3 m_front;
 	glm::vec3 m_right;
 	glm::vec3 m_up;
+	glm::vec2 m_jitter{};
+	uint32_t m_jitterIndex{};
 	float m_yaw = -90.0f;
 	float m_pitch = 00.0f;
 	const float SPEED = 5.0f;
 	const float RSPEED = 150.0f;
+	const float FOV = 80.0f;
+	const float NEAR = 0.1f;
+	const float FAR = 100.0f;
+	const uint32_t JITTER_PHASES = 8;
 };
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include "graphics/vulkan/command_recorder.hpp"
+
+#include <cassert>
+
+CommandRecorder::~CommandRecorder()
+{
+	destroy();
+}
+
+void CommandRecorder::destroy()
+{
+	m_stats.clear();
+	m_initialized = false;
+}
+
+void CommandRecorder::init(uint32_t scopeCount)
+{
+	assert(!m_initialized);
+	m_initialized = true;
+	m_stats.resize(scopeCount);
+}
+
+// Bindings live as long as the command buffer, they survive render pass boundaries but not a new recording
+void CommandRecorder::begin(VkCommandBuffer commandBuffer)
+{
+	assert(m_initialized);
+	m_commandBuffer = commandBuffer;
+	m_scope = 0;
+	for (auto& stats : m_stats) stats = {};
+	invalidate();
+}
+
+void CommandRecorder::setScope(uint32_t scope)
+{
+	assert(m_initialized);
+	assert(scope < m_stats.size());
+	m_scope = scope;
+}
+
+// Needed after anything records graphics state behind the recorder's back, like the ui backend
+void CommandRecorder::invalidate()
+{
+	assert(m_initialized);
+	m_pipeline = VK_NULL_HANDLE;
+	m_layout = VK_NULL_HANDLE;
+	m_sets = {};
+	m_vertexBuffers = {};
+	m_indexBuffer = VK_NULL_HANDLE;
+	m_viewportSet = false;
+	m_scissorSet = false;
+}
+
+bool CommandRecorder::skip(bool redundant)
+{
+	auto& stats = m_stats[m_scope];
+	if (redundant) stats.skipped++;
+	else stats.binds++;
+	return redundant;
+}
+
+void CommandRecorder::bindPipeline(VkPipeline pipeline)
+{
+	assert(m_initialized);
+	if (skip(pipeline == m_pipeline)) return;
+	m_pipeline = pipeline;
+	vkCmdBindPipeline(m_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+}
+
+// Sets are only known to stay valid while the same layout binds them, another layout may disturb any of them
+void CommandRecorder::bindDescriptorSet(VkPipelineLayout layout, uint32_t setId, VkDescriptorSet set)
+{
+	assert(m_initialized);
+	assert(setId < MAX_SETS);
+	if (layout != m_layout)
+	{
+		m_sets = {};
+		m_layout = layout;
+	}
+	if (skip(m_sets[setId] == set)) return;
+	m_sets[setId] = set;
+	vkCmdBindDescriptorSets(m_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, setId, 1, &set, 0, nullptr);
+}
+
+void CommandRecorder::bindVertexBuffers(uint32_t firstBinding, uint32_t bindingCount, const VkBuffer* buffers, const VkDeviceSize* offsets)
+{
+	assert(m_initialized);
+	assert(firstBinding + bindingCount <= MAX_VERTEX_BUFFERS);
+	auto redundant = true;
+	for (uint32_t i = 0; i < bindingCount; i++)
+	{
+		auto& binding = m_vertexBuffers[firstBinding + i];
+		redundant &= binding.buffer == buffers[i] && binding.offset == offsets[i];
+		binding = { buffers[i], offsets[i] };
+	}
+	if (skip(redundant)) return;
+	vkCmdBindVertexBuffers(m_commandBuffer, firstBinding, bindingCount, buffers, offsets);
+}
+
+void CommandRecorder::bindIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType)
+{
+	assert(m_initialized);
+	if (skip(buffer == m_indexBuffer && offset == m_indexOffset && indexType == m_indexType)) return;
+	m_indexBuffer = buffer;
+	m_indexOffset = offset;
+	m_indexType = indexType;
+	vkCmdBindIndexBuffer(m_commandBuffer, buffer, offset, indexType);
+}
+
+void CommandRecorder::setViewport(const VkViewport& viewport)
+{
+	assert(m_initialized);
+	auto redundant = m_viewportSet && viewport.x == m_viewport.x && viewport.y == m_viewport.y
+		&& viewport.width == m_viewport.width && viewport.height == m_viewport.height
+		&& viewport.minDepth == m_viewport.minDepth && viewport.maxDepth == m_viewport.maxDepth;
+	if (skip(redundant)) return;
+	m_viewport = viewport;
+	m_viewportSet = true;
+	vkCmdSetViewport(m_commandBuffer, 0, 1, &viewport);
+}
+
+void CommandRecorder::setScissor(const VkRect2D& scissor)
+{
+	assert(m_initialized);
+	auto redundant = m_scissorSet && scissor.offset.x == m_scissor.offset.x && scissor.offset.y == m_scissor.offset.y
+		&& scissor.extent.width == m_scissor.extent.width && scissor.extent.height == m_scissor.extent.height;
+	if (skip(redundant)) return;
+	m_scissor = scissor;
+	m_scissorSet = true;
+	vkCmdSetScissor(m_commandBuffer, 0, 1, &scissor);
+}
+
+void CommandRecorder::draw(uint32_t vertexCount, uint32_t instanceCount)
+{
+	assert(m_initialized);
+	auto& stats = m_stats[m_scope];
+	stats.draws++;
+	stats.triangles += vertexCount / 3 * instanceCount;
+	vkCmdDraw(m_commandBuffer, vertexCount, instanceCount, 0, 0);
+}
+
+void CommandRecorder::drawIndexed(uint32_t indexCount, uint32_t firstIndex, uint32_t instanceCount)
+{
+	assert(m_initialized);
+	auto& stats = m_stats[m_scope];
+	stats.draws++;
+	stats.triangles += indexCount / 3 * instanceCount;
+	vkCmdDrawIndexed(m_commandBuffer, indexCount, instanceCount, firstIndex, 0, 0);
+}
+
+void CommandRecorder::drawIndexedIndirect(VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount)
+{
+	assert(m_initialized);
+	m_stats[m_scope].draws += drawCount;
+	vkCmdDrawIndexedIndirect(m_commandBuffer, buffer, offset, drawCount, sizeof(VkDrawIndexedIndirectCommand));
+}
+
+VkCommandBuffer CommandRecorder::getCommandBuffer()
+{
+	assert(m_initialized);
+	return m_commandBuffer;
+}
+
+const RecorderStats& CommandRecorder::getStats(uint32_t scope)
+{
+	assert(m_initialized);
+	assert(scope < m_stats.size());
+	return m_stats[scope];
+}
+
+RecorderStats CommandRecorder::getTotal()
+{
+	assert(m_initialized);
+	auto total = RecorderStats{};
+	for (auto& stats : m_stats)
+	{
+		total.draws += stats.draws;
+		total.binds += stats.binds;
+		total.skipped += stats.skipped;
+		total.triangles += stats.triangles;
+	}
+	return total;
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <vector>
+
+struct RecorderStats
+{
+	uint32_t draws;
+	uint32_t binds;
+	uint32_t skipped; // redundant binds that never reached the command buffer
+	uint64_t triangles; // of direct draws, indirect ones are only seen by the pipeline statistics
+};
+
+// Records the graphics state changes of a frame and drops the ones that would not change anything.
+// Compute passes bind their own state directly, the graphics bind point does not see it
+class CommandRecorder
+{
+public:
+	static constexpr uint32_t MAX_SETS = 16;
+	static constexpr uint32_t MAX_VERTEX_BUFFERS = 4;
+
+	~CommandRecorder();
+	void init(uint32_t scopeCount);
+	void destroy();
+
+	void begin(VkCommandBuffer commandBuffer);
+	void setScope(uint32_t scope);
+	void invalidate();
+
+	void bindPipeline(VkPipeline pipeline);
+	void bindDescriptorSet(VkPipelineLayout layout, uint32_t setId, VkDescriptorSet set);
+	void bindVertexBuffers(uint32_t firstBinding, uint32_t bindingCount, const VkBuffer* buffers, const VkDeviceSize* offsets);
+	void bindIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType);
+	void setViewport(const VkViewport& viewport);
+	void setScissor(const VkRect2D& scissor);
+
+	void draw(uint32_t vertexCount, uint32_t instanceCount = 1);
+	void drawIndexed(uint32_t indexCount, uint32_t firstIndex, uint32_t instanceCount = 1);
+	void drawIndexedIndirect(VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount = 1);
+
+	VkCommandBuffer getCommandBuffer();
+	const RecorderStats& getStats(uint32_t scope);
+	RecorderStats getTotal();
+
+private:
+	struct VertexBinding
+	{
+		VkBuffer buffer;
+		VkDeviceSize offset;
+	};
+
+	bool skip(bool redundant);
+
+private:
+	bool m_initialized = false;
+	VkCommandBuffer m_commandBuffer{};
+	uint32_t m_scope{};
+	std::vector<RecorderStats> m_stats{};
+
+	VkPipeline m_pipeline{};
+	VkPipelineLayout m_layout{};
+	std::array<VkDescriptorSet, MAX_SETS> m_sets{};
+	std::array<VertexBinding, MAX_VERTEX_BUFFERS> m_vertexBuffers{};
+	VkBuffer m_indexBuffer{};
+	VkDeviceSize m_indexOffset{};
+	VkIndexType m_indexType{};
+	VkViewport m_viewport{};
+	VkRect2D m_scissor{};
+	bool m_viewportSet = false;
+	bool m_scissorSet = false;
+};
\ No newline at end of file
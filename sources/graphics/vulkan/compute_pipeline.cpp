@@ -0,0 +1,88 @@
+#include "graphics/vulkan/compute_pipeline.hpp"
+#include "graphics/vulkan/locator.hpp"
+
+#include <cmrc/cmrc.hpp>
+CMRC_DECLARE(shaders);
+
+#include <cassert>
+#include <stdexcept>
+
+ComputePipeline::~ComputePipeline()
+{
+	destroy();
+}
+
+void ComputePipeline::destroy()
+{
+	if (m_initialized)
+	{
+		m_device->getDeletionQueue().push([device = m_device->getDevice(), pipeline = m_pipeline, layout = m_layout] {
+			vkDestroyPipeline(device, pipeline, nullptr);
+			vkDestroyPipelineLayout(device, layout, nullptr);
+		});
+	}
+	m_initialized = false;
+}
+
+void ComputePipeline::init(const ComputePipelineProps& props)
+{
+	assert(!m_initialized);
+	m_initialized = true;
+	m_device = &Locator::getDevice();
+	m_props = props;
+	createPipeline();
+}
+
+void ComputePipeline::createPipeline()
+{
+	auto computeFile = cmrc::shaders::get_filesystem().open(m_props.computePath);
+	auto computeCode = std::vector<char>(computeFile.begin(), computeFile.end());
+	auto computeModule = createShaderModule(computeCode);
+
+	auto stageInfo = VkPipelineShaderStageCreateInfo{};
+	stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	stageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	stageInfo.module = computeModule;
+	stageInfo.pName = "main";
+
+	auto pipelineLayoutInfo = VkPipelineLayoutCreateInfo{};
+	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutInfo.pSetLayouts = m_props.descriptorSetLayouts.data();
+	pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(m_props.descriptorSetLayouts.size());
+	if (vkCreatePipelineLayout(m_device->getDevice(), &pipelineLayoutInfo, nullptr, &m_layout) != VK_SUCCESS)
+		throw std::runtime_error{ "failed to create vulkan compute pipeline layout" };
+
+	auto createInfo = VkComputePipelineCreateInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	createInfo.stage = stageInfo;
+	createInfo.layout = m_layout;
+	if (vkCreateComputePipelines(m_device->getDevice(), VK_NULL_HANDLE, 1, &createInfo, nullptr, &m_pipeline) != VK_SUCCESS)
+		throw std::runtime_error{ "failed to create vulkan compute pipeline" };
+
+	vkDestroyShaderModule(m_device->getDevice(), computeModule, nullptr);
+}
+
+VkShaderModule ComputePipeline::createShaderModule(const std::vector<char>& code)
+{
+	auto shaderModule = VkShaderModule{};
+	auto createInfo = VkShaderModuleCreateInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+	createInfo.codeSize = code.size();
+	if (vkCreateShaderModule(m_device->getDevice(), &createInfo, nullptr, &shaderModule) != VK_SUCCESS)
+		throw std::runtime_error{ "failed to create shader module" };
+
+	return shaderModule;
+}
+
+void ComputePipeline::bind(VkCommandBuffer commandBuffer)
+{
+	assert(m_initialized);
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline);
+}
+
+VkPipelineLayout ComputePipeline::getLayout()
+{
+	assert(m_initialized);
+	return m_layout;
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "graphics/vulkan/context/device.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <string>
+#include <vector>
+
+struct ComputePipelineProps
+{
+	std::string computePath;
+	std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
+};
+
+class ComputePipeline
+{
+public:
+	~ComputePipeline();
+	void init(const ComputePipelineProps& props);
+	void destroy();
+
+	void bind(VkCommandBuffer commandBuffer);
+	VkPipelineLayout getLayout();
+
+private:
+	void createPipeline();
+	VkShaderModule createShaderModule(const std::vector<char>& code);
+
+private:
+	bool m_initialized = false;
+	Device* m_device{};
+	ComputePipelineProps m_props{};
+	VkPipelineLayout m_layout{};
+	VkPipeline m_pipeline{};
+};
\ No newline at end of file
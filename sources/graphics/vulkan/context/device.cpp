@@ -1,6 +1,7 @@
 #include "graphics/vulkan/context/device.hpp"
 #include "graphics/vulkan/locator.hpp"
 
+#include <cstring>
 #include <print>
 #include <set>
 #include <string>
@@ -15,6 +16,9 @@ void Device::destroy()
 {
 	if (m_initialized)
 	{
+		m_deletionQueue.destroy();
+		m_samplerCache.destroy();
+		m_memoryTracker.destroy();
 		vkDestroyCommandPool(m_device, m_commandPool, nullptr);
 		vkDestroyDevice(m_device, nullptr);
 		vkDestroySurfaceKHR(m_context->getInstance(), m_surface, nullptr);
@@ -32,6 +36,9 @@ void Device::init(VkSurfaceKHR surface)
 	createDevice();
 	createCommandPool();
 	Locator::setDevice(this);
+	m_samplerCache.init();
+	m_memoryTracker.init(m_memoryBudgetSupported);
+	m_deletionQueue.init();
 }
 
 void Device::pickGpu()
@@ -92,6 +99,20 @@ bool Device::checkGpuExtensionsSupport(VkPhysicalDevice gpu)
 	return requiredExtensions.empty();
 }
 
+bool Device::isExtensionSupported(VkPhysicalDevice gpu, const char* extensionName)
+{
+	auto extensionCount = uint32_t{};
+	vkEnumerateDeviceExtensionProperties(gpu, nullptr, &extensionCount, nullptr);
+	auto availableExtensions = std::vector<VkExtensionProperties>(extensionCount);
+	vkEnumerateDeviceExtensionProperties(gpu, nullptr, &extensionCount, availableExtensions.data());
+	for (const auto& extension : availableExtensions)
+	{
+		if (strcmp(extension.extensionName, extensionName) == 0)
+			return true;
+	}
+	return false;
+}
+
 uint32_t Device::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
 {
 	auto memProps = VkPhysicalDeviceMemoryProperties{};
@@ -162,6 +183,17 @@ VkFormat Device::findDepthFormat()
 	);
 }
 
+void Device::setObjectName(VkObjectType type, uint64_t handle, const std::string& name)
+{
+	if (m_setObjectName == nullptr) return;
+	auto nameInfo = VkDebugUtilsObjectNameInfoEXT{};
+	nameInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
+	nameInfo.objectType = type;
+	nameInfo.objectHandle = handle;
+	nameInfo.pObjectName = name.c_str();
+	m_setObjectName(m_device, &nameInfo);
+}
+
 SwapchainSupportDetails Device::querySwapchainSupport(VkPhysicalDevice gpu)
 {
 	auto details = SwapchainSupportDetails{};
@@ -202,16 +234,46 @@ void Device::createDevice()
 		queueCreateInfos.push_back(queueCreateInfo);
 	}
 
+	auto supportedFeatures = VkPhysicalDeviceFeatures{};
+	vkGetPhysicalDeviceFeatures(m_gpu, &supportedFeatures);
+
 	auto deviceFeatures = VkPhysicalDeviceFeatures{};
 	deviceFeatures.samplerAnisotropy = VK_TRUE;
+	deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+	deviceFeatures.pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery;
+
+	auto extensions = DEVICE_EXTENSIONS;
+	m_memoryBudgetSupported = isExtensionSupported(m_gpu, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+	if (m_memoryBudgetSupported)
+		extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+	auto presentIdFeatures = VkPhysicalDevicePresentIdFeaturesKHR{};
+	presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+	auto presentWaitFeatures = VkPhysicalDevicePresentWaitFeaturesKHR{};
+	presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+	presentWaitFeatures.pNext = &presentIdFeatures;
+	if (isExtensionSupported(m_gpu, VK_KHR_PRESENT_ID_EXTENSION_NAME) && isExtensionSupported(m_gpu, VK_KHR_PRESENT_WAIT_EXTENSION_NAME))
+	{
+		auto features = VkPhysicalDeviceFeatures2{};
+		features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		features.pNext = &presentWaitFeatures;
+		vkGetPhysicalDeviceFeatures2(m_gpu, &features);
+	}
+	m_presentWaitSupported = presentIdFeatures.presentId && presentWaitFeatures.presentWait;
+	if (m_presentWaitSupported)
+	{
+		extensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+		extensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+	}
 
 	auto createInfo = VkDeviceCreateInfo{};
 	createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	createInfo.pNext = m_presentWaitSupported ? &presentWaitFeatures : nullptr;
 	createInfo.pQueueCreateInfos = queueCreateInfos.data();
 	createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 	createInfo.pEnabledFeatures = &deviceFeatures;
-	createInfo.ppEnabledExtensionNames = DEVICE_EXTENSIONS.data();
-	createInfo.enabledExtensionCount = static_cast<uint32_t>(DEVICE_EXTENSIONS.size());
+	createInfo.ppEnabledExtensionNames = extensions.data();
+	createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
 	if (USE_VALIDATION_LAYERS)
 	{
 		createInfo.ppEnabledLayerNames = VALIDATION_LAYER_NAMES.data();
@@ -224,6 +286,10 @@ void Device::createDevice()
 
 	vkGetDeviceQueue(m_device, indices.graphics.value(), 0, &m_graphicsQueue);
 	vkGetDeviceQueue(m_device, indices.present.value(), 0, &m_presentQueue);
+
+	// Debug utils is only enabled on the instance together with the validation layers
+	if (USE_VALIDATION_LAYERS)
+		m_setObjectName = (PFN_vkSetDebugUtilsObjectNameEXT)vkGetInstanceProcAddr(m_context->getInstance(), "vkSetDebugUtilsObjectNameEXT");
 }
 
 void Device::createCommandPool()
@@ -237,7 +303,7 @@ void Device::createCommandPool()
 		throw std::runtime_error{ "failed to create vulkan command pool" };
 }
 
-void Device::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& memory)
+void Device::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& memory, MemoryCategory category, const std::string& name)
 {
 	assert(m_initialized);
 	auto createInfo = VkBufferCreateInfo{};
@@ -247,21 +313,16 @@ void Device::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryP
 	createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 	if (vkCreateBuffer(m_device, &createInfo, nullptr, &buffer) != VK_SUCCESS)
 		throw std::runtime_error{ "failed to create vertex buffer" };
+	setObjectName(VK_OBJECT_TYPE_BUFFER, reinterpret_cast<uint64_t>(buffer), name);
 
 	auto memReq = VkMemoryRequirements{};
 	vkGetBufferMemoryRequirements(m_device, buffer, &memReq);
-
-	auto allocInfo = VkMemoryAllocateInfo{};
-	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	allocInfo.allocationSize = memReq.size;
-	allocInfo.memoryTypeIndex = findMemoryType(memReq.memoryTypeBits, properties);
-	if (vkAllocateMemory(m_device, &allocInfo, nullptr, &memory) != VK_SUCCESS)
-		throw std::runtime_error{ "failed to allocate vertex buffer memory" };
+	memory = m_memoryTracker.allocate(memReq, properties, category, name);
 
 	vkBindBufferMemory(m_device, buffer, memory, 0);
 }
 
-void Device::createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory)
+void Device::createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory, MemoryCategory category, const std::string& name)
 {
 	assert(m_initialized);
 	auto createInfo = VkImageCreateInfo{};
@@ -280,21 +341,16 @@ void Device::createImage(uint32_t width, uint32_t height, uint32_t mipLevels, Vk
 	createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 	if (vkCreateImage(m_device, &createInfo, nullptr, &image) != VK_SUCCESS)
 		throw std::runtime_error{ "failed to create image" };
+	setObjectName(VK_OBJECT_TYPE_IMAGE, reinterpret_cast<uint64_t>(image), name);
 
 	auto memReq = VkMemoryRequirements{};
 	vkGetImageMemoryRequirements(m_device, image, &memReq);
-
-	auto allocInfo = VkMemoryAllocateInfo{};
-	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	allocInfo.allocationSize = memReq.size;
-	allocInfo.memoryTypeIndex = findMemoryType(memReq.memoryTypeBits, properties);
-	if (vkAllocateMemory(m_device, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS)
-		throw std::runtime_error{ "failed to allocate image memory" };
+	imageMemory = m_memoryTracker.allocate(memReq, properties, category, name);
 
 	vkBindImageMemory(m_device, image, imageMemory, 0);
 }
 
-void Device::createImage(uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t arrayLayers, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory)
+void Device::createImage(uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t arrayLayers, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory, MemoryCategory category, const std::string& name)
 {
 	assert(m_initialized);
 	auto createInfo = VkImageCreateInfo{};
@@ -314,16 +370,11 @@ void Device::createImage(uint32_t width, uint32_t height, uint32_t mipLevels, ui
 	createInfo.flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
 	if (vkCreateImage(m_device, &createInfo, nullptr, &image) != VK_SUCCESS)
 		throw std::runtime_error{ "failed to create image" };
+	setObjectName(VK_OBJECT_TYPE_IMAGE, reinterpret_cast<uint64_t>(image), name);
 
 	auto memReq = VkMemoryRequirements{};
 	vkGetImageMemoryRequirements(m_device, image, &memReq);
-
-	auto allocInfo = VkMemoryAllocateInfo{};
-	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	allocInfo.allocationSize = memReq.size;
-	allocInfo.memoryTypeIndex = findMemoryType(memReq.memoryTypeBits, properties);
-	if (vkAllocateMemory(m_device, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS)
-		throw std::runtime_error{ "failed to allocate image memory" };
+	imageMemory = m_memoryTracker.allocate(memReq, properties, category, name);
 
 	vkBindImageMemory(m_device, image, imageMemory, 0);
 }
@@ -406,6 +457,14 @@ void Device::copyBufferToImage(Buffer& srcBuffer, VkImage dstImage, uint32_t wid
 	endSingleTimeCommands(commandBuffer);
 }
 
+void Device::copyBufferToImage(Buffer& srcBuffer, VkImage dstImage, const std::vector<VkBufferImageCopy>& regions)
+{
+	assert(m_initialized);
+	auto commandBuffer = beginSingleTimeCommands();
+	vkCmdCopyBufferToImage(commandBuffer, srcBuffer.getBuffer(), dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()), regions.data());
+	endSingleTimeCommands(commandBuffer);
+}
+
 std::vector<VkCommandBuffer> Device::createCommandBuffers(uint32_t count)
 {
 	assert(m_initialized);
@@ -544,6 +603,13 @@ void Device::transitionImageLayout(VkImage image, uint32_t layerCount, VkFormat
 		sourceStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 		destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
 	}
+	else if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_GENERAL)
+	{
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		destinationStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	}
 	else
 		throw std::invalid_argument("unsupported layout transition!");
 
@@ -588,3 +654,27 @@ VkQueue Device::getPresentQueue()
 	assert(m_initialized);
 	return m_presentQueue;
 }
+
+SamplerCache& Device::getSamplerCache()
+{
+	assert(m_initialized);
+	return m_samplerCache;
+}
+
+MemoryTracker& Device::getMemoryTracker()
+{
+	assert(m_initialized);
+	return m_memoryTracker;
+}
+
+DeletionQueue& Device::getDeletionQueue()
+{
+	assert(m_initialized);
+	return m_deletionQueue;
+}
+
+bool Device::isPresentWaitSupported()
+{
+	assert(m_initialized);
+	return m_presentWaitSupported;
+}
\ No newline at end of file
@@ -5,8 +5,12 @@
 #include "graphics/vulkan/context/context.hpp"
 #include "graphics/vulkan/descriptor/descriptor_pool.hpp"
 #include "graphics/vulkan/buffer.hpp"
+#include "graphics/vulkan/sampler_cache.hpp"
+#include "graphics/vulkan/memory_tracker.hpp"
+#include "graphics/vulkan/deletion_queue.hpp"
 
 #include <memory>
+#include <string>
 
 class Device
 {
@@ -15,14 +19,15 @@ public:
 	void init(VkSurfaceKHR surface);
 	void destroy();
 	
-	void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& memory);
-	void createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
-	void createImage(uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t arrayLayers, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
+	void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& memory, MemoryCategory category, const std::string& name);
+	void createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory, MemoryCategory category, const std::string& name);
+	void createImage(uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t arrayLayers, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory, MemoryCategory category, const std::string& name);
 	VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels);
 	VkImageView createImageView(VkImage image, uint32_t layerCount, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels);
 
 	void copyBuffer(Buffer& srcBuffer, Buffer& dstBuffer);
 	void copyBufferToImage(Buffer& srcBuffer, VkImage dstImage, uint32_t width, uint32_t height, uint32_t layerCount = 1);
+	void copyBufferToImage(Buffer& srcBuffer, VkImage dstImage, const std::vector<VkBufferImageCopy>& regions);
 	void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels, VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT, VkCommandBuffer commandBuffer = VK_NULL_HANDLE);
 	void transitionImageLayout(VkImage image, uint32_t layerCount, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels, VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT, VkCommandBuffer commandBuffer = VK_NULL_HANDLE);
 
@@ -37,15 +42,21 @@ public:
 	VkFormat findSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
 	VkFormat findDepthFormat();
 	SwapchainSupportDetails querySwapchainSupport(VkPhysicalDevice gpu);
+	void setObjectName(VkObjectType type, uint64_t handle, const std::string& name);
 
 	VkSurfaceKHR getSurface();
 	VkPhysicalDevice getGpu();
 	VkDevice getDevice();
 	VkQueue getGraphicsQueue();
 	VkQueue getPresentQueue();
+	SamplerCache& getSamplerCache();
+	MemoryTracker& getMemoryTracker();
+	DeletionQueue& getDeletionQueue();
+	bool isPresentWaitSupported();
 
 private:
 	bool checkGpuExtensionsSupport(VkPhysicalDevice gpu);
+	bool isExtensionSupported(VkPhysicalDevice gpu, const char* extensionName);
 
 private:
 	void pickGpu();
@@ -62,4 +73,10 @@ private:
 	VkQueue m_graphicsQueue{};
 	VkQueue m_presentQueue{};
 	VkCommandPool m_commandPool{};
+	PFN_vkSetDebugUtilsObjectNameEXT m_setObjectName{};
+	bool m_memoryBudgetSupported = false;
+	bool m_presentWaitSupported = false;
+	SamplerCache m_samplerCache{};
+	MemoryTracker m_memoryTracker{};
+	DeletionQueue m_deletionQueue{};
 };
\ No newline at end of file
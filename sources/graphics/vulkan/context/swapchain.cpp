@@ -14,7 +14,8 @@ void Swapchain::destroy()
 {
 	if (m_initialized)
 	{
-		vkDestroySwapchainKHR(m_device->getDevice(), m_swapchain, nullptr);
+		m_framebuffers.clear();
+		retire(m_swapchain);
 	}
 	m_initialized = false;
 }
@@ -27,25 +28,46 @@ void Swapchain::init(const FramebufferProps& framebufferProps, RenderPass& rende
 	m_renderPass = &renderPass;
 	m_framebufferProps = framebufferProps;
 	m_onResize = onResize;
-	createSwapchain();
+	if (m_device->isPresentWaitSupported())
+		m_waitForPresent = (PFN_vkWaitForPresentKHR)vkGetDeviceProcAddr(m_device->getDevice(), "vkWaitForPresentKHR");
+	m_recreatePending = false;
+	createSwapchain(VK_NULL_HANDLE);
 	createFramebuffers();
 	Locator::setSwapchain(this);
 }
 
+// The new swapchain takes over from the old one through oldSwapchain. The retired swapchain and its framebuffers
+// go to the deletion queue, the frame in flight and the presentation engine may still be using them
 void Swapchain::recreate()
 {
 	assert(m_initialized);
-	vkDeviceWaitIdle(m_device->getDevice());
-	vkDestroySwapchainKHR(m_device->getDevice(), m_swapchain, nullptr);
-	createSwapchain();
+	auto oldSwapchain = m_swapchain;
+	m_framebuffers.clear();
+	createSwapchain(oldSwapchain);
 	createFramebuffers();
+	m_recreatePending = false;
+	retire(oldSwapchain);
 }
 
-void Swapchain::createSwapchain()
+// Queued after the framebuffers, so the views of its images are gone before the swapchain is
+void Swapchain::retire(VkSwapchainKHR swapchain)
+{
+	m_device->getDeletionQueue().push([device = m_device->getDevice(), swapchain] {
+		vkDestroySwapchainKHR(device, swapchain, nullptr);
+	});
+}
+
+void Swapchain::resize()
+{
+	recreate();
+	m_onResize(m_swapchainExtent.width, m_swapchainExtent.height);
+}
+
+void Swapchain::createSwapchain(VkSwapchainKHR oldSwapchain)
 {
 	auto swapchainDetails = m_device->querySwapchainSupport(m_device->getGpu());
 	auto surfaceFormat = chooseSwapchainSurfaceFormat(swapchainDetails.formats);
-	auto presentMode = chooseSwapchainPresentMode(swapchainDetails.presentModes);
+	auto presentMode = chooseSwapchainPresentMode(swapchainDetails.presentModes, m_preferredPresentMode);
 	auto extent = chooseSwapchainExtent(swapchainDetails.capabilities);
 
 	auto imageCount = swapchainDetails.capabilities.minImageCount + 1;
@@ -77,13 +99,16 @@ void Swapchain::createSwapchain()
 	createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
 	createInfo.presentMode = presentMode;
 	createInfo.clipped = VK_TRUE;
-	createInfo.oldSwapchain = VK_NULL_HANDLE;
+	createInfo.oldSwapchain = oldSwapchain;
 
 	if (vkCreateSwapchainKHR(m_device->getDevice(), &createInfo, nullptr, &m_swapchain) != VK_SUCCESS)
 		throw std::runtime_error{ "failed to create vulkan swapchain" };
 
 	m_swapchainFormat = surfaceFormat.format;
 	m_swapchainExtent = extent;
+	m_presentMode = presentMode;
+	m_presentModes = swapchainDetails.presentModes;
+	m_presentId = 0;
 }
 
 void Swapchain::createFramebuffers()
@@ -92,11 +117,11 @@ void Swapchain::createFramebuffers()
 	vkGetSwapchainImagesKHR(m_device->getDevice(), m_swapchain, &imageCount, nullptr);
 	auto swapchainImages = std::vector<VkImage>(imageCount);
 	vkGetSwapchainImagesKHR(m_device->getDevice(), m_swapchain, &imageCount, swapchainImages.data());
-	m_framebuffers.resize(imageCount);
-	for (auto [image, framebuffer] : std::views::zip(swapchainImages, m_framebuffers))
+	m_framebuffers.reserve(imageCount);
+	for (auto image : swapchainImages)
 	{
-		framebuffer.destroy();
-		framebuffer.init(m_framebufferProps, image, *m_renderPass, m_swapchainExtent.width, m_swapchainExtent.height);
+		auto& framebuffer = m_framebuffers.emplace_back(std::make_unique<SwapchainFramebuffer>());
+		framebuffer->init(m_framebufferProps, image, *m_renderPass, m_swapchainExtent.width, m_swapchainExtent.height);
 	}
 }
 
@@ -111,11 +136,12 @@ VkSurfaceFormatKHR Swapchain::chooseSwapchainSurfaceFormat(const std::vector<VkS
 	return availableFormats[0];
 }
 
-VkPresentModeKHR Swapchain::chooseSwapchainPresentMode(const std::vector<VkPresentModeKHR>& availableModes)
+// FIFO is the only mode every implementation has to support
+VkPresentModeKHR Swapchain::chooseSwapchainPresentMode(const std::vector<VkPresentModeKHR>& availableModes, VkPresentModeKHR preferredMode)
 {
 	for (const auto& mode : availableModes)
 	{
-		if (mode == VK_PRESENT_MODE_MAILBOX_KHR)
+		if (mode == preferredMode)
 			return mode;
 	}
 	return VK_PRESENT_MODE_FIFO_KHR;
@@ -135,6 +161,40 @@ VkExtent2D Swapchain::chooseSwapchainExtent(const VkSurfaceCapabilitiesKHR& capa
 	}
 }
 
+// Blocks until the image presented with presentId is visible, a no op without present wait
+void Swapchain::waitForPresent(uint64_t presentId, uint64_t timeout)
+{
+	assert(m_initialized);
+	if (m_waitForPresent == nullptr || presentId == 0 || presentId > m_presentId) return;
+	m_waitForPresent(m_device->getDevice(), m_swapchain, presentId, timeout);
+}
+
+void Swapchain::setPresentMode(VkPresentModeKHR presentMode)
+{
+	assert(m_initialized);
+	m_preferredPresentMode = presentMode;
+	if (m_presentMode != presentMode)
+		recreate();
+}
+
+VkPresentModeKHR Swapchain::getPresentMode()
+{
+	assert(m_initialized);
+	return m_presentMode;
+}
+
+const std::vector<VkPresentModeKHR>& Swapchain::getPresentModes()
+{
+	assert(m_initialized);
+	return m_presentModes;
+}
+
+uint64_t Swapchain::getPresentId()
+{
+	assert(m_initialized);
+	return m_presentId;
+}
+
 VkExtent2D Swapchain::getExtent()
 {
 	assert(m_initialized);
@@ -150,7 +210,7 @@ VkFormat Swapchain::getFormat()
 Framebuffer& Swapchain::getFramebuffer(uint32_t index)
 {
 	assert(m_initialized);
-	return m_framebuffers[index];
+	return *m_framebuffers[index];
 }
 
 uint32_t Swapchain::getImageIndex()
@@ -164,14 +224,21 @@ uint32_t Swapchain::beginFrame(VkFence inFlightFence, VkSemaphore imageAvailable
 	assert(m_initialized);
 	vkWaitForFences(m_device->getDevice(), 1, &inFlightFence, VK_TRUE, UINT64_MAX);
 
+	if (m_recreatePending)
+		resize();
+
+	// A failed acquire leaves the semaphore unsignaled, so the frame can retry on the new swapchain instead of being dropped
 	auto result = vkAcquireNextImageKHR(m_device->getDevice(), m_swapchain, UINT64_MAX, imageAvailableSemaphore, VK_NULL_HANDLE, &m_imageIndex);
-	if (result == VK_ERROR_OUT_OF_DATE_KHR) 
+	if (result == VK_ERROR_OUT_OF_DATE_KHR)
 	{
-		recreate();
-		m_onResize(m_swapchainExtent.width, m_swapchainExtent.height);
-		return UINT32_MAX;
+		resize();
+		result = vkAcquireNextImageKHR(m_device->getDevice(), m_swapchain, UINT64_MAX, imageAvailableSemaphore, VK_NULL_HANDLE, &m_imageIndex);
+		if (result == VK_ERROR_OUT_OF_DATE_KHR)
+			return UINT32_MAX;
 	}
-	else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+	if (result == VK_SUBOPTIMAL_KHR)
+		m_recreatePending = true;
+	else if (result != VK_SUCCESS)
 		throw std::runtime_error("failed to acquire swap chain image!");
 
 	vkResetFences(m_device->getDevice(), 1, &inFlightFence);
@@ -188,5 +255,17 @@ void Swapchain::endFrame(uint32_t imageIndex, VkSemaphore renderFinishedSemaphor
 	presentInfo.pSwapchains = &m_swapchain;
 	presentInfo.swapchainCount = 1;
 	presentInfo.pImageIndices = &imageIndex;
-	vkQueuePresentKHR(m_device->getPresentQueue(), &presentInfo);
+
+	auto presentId = ++m_presentId;
+	auto presentIdInfo = VkPresentIdKHR{};
+	presentIdInfo.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+	presentIdInfo.swapchainCount = 1;
+	presentIdInfo.pPresentIds = &presentId;
+	if (m_waitForPresent != nullptr)
+		presentInfo.pNext = &presentIdInfo;
+	auto result = vkQueuePresentKHR(m_device->getPresentQueue(), &presentInfo);
+	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+		m_recreatePending = true;
+	else if (result != VK_SUCCESS)
+		throw std::runtime_error{ "failed to present swapchain image" };
 }
\ No newline at end of file
@@ -10,6 +10,7 @@
 #include <vector>
 #include <optional>
 #include <functional>
+#include <memory>
 
 class Swapchain
 {
@@ -21,18 +22,25 @@ public:
 	uint32_t beginFrame(VkFence inFlightFence, VkSemaphore imageAvailableSemaphore);
 	void endFrame(uint32_t imageIndex, VkSemaphore renderFinishedSemaphore);
 	void recreate();
+	void waitForPresent(uint64_t presentId, uint64_t timeout);
+	void setPresentMode(VkPresentModeKHR presentMode);
+	VkPresentModeKHR getPresentMode();
+	const std::vector<VkPresentModeKHR>& getPresentModes();
+	uint64_t getPresentId();
 	VkExtent2D getExtent();
 	VkFormat getFormat();
 	Framebuffer& getFramebuffer(uint32_t index);
 	uint32_t getImageIndex();
 
 private:
-	void createSwapchain();
+	void createSwapchain(VkSwapchainKHR oldSwapchain);
 	void createFramebuffers();
+	void resize();
+	void retire(VkSwapchainKHR swapchain);
 
 public:
 	static VkSurfaceFormatKHR chooseSwapchainSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats);
-	static VkPresentModeKHR chooseSwapchainPresentMode(const std::vector<VkPresentModeKHR>& availableModes);
+	static VkPresentModeKHR chooseSwapchainPresentMode(const std::vector<VkPresentModeKHR>& availableModes, VkPresentModeKHR preferredMode);
 	VkExtent2D chooseSwapchainExtent(const VkSurfaceCapabilitiesKHR& capabilities);
 
 private:
@@ -46,7 +54,14 @@ private:
 	FramebufferProps m_framebufferProps{};
 	std::function<void(uint32_t, uint32_t)> m_onResize;
 	uint32_t m_imageIndex{};
+	bool m_recreatePending = false; // present reported the swapchain as suboptimal or out of date
+
+	VkPresentModeKHR m_preferredPresentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+	VkPresentModeKHR m_presentMode{};
+	std::vector<VkPresentModeKHR> m_presentModes{};
+	PFN_vkWaitForPresentKHR m_waitForPresent{};
+	uint64_t m_presentId{}; // last id handed to present, ids restart with every swapchain
 
 	VkSwapchainKHR m_swapchain{};
-	std::vector<SwapchainFramebuffer> m_framebuffers{};
+	std::vector<std::unique_ptr<SwapchainFramebuffer>> m_framebuffers{};
 };
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "graphics/vulkan/deletion_queue.hpp"
+#include "graphics/vulkan/context/device.hpp"
+#include "graphics/vulkan/locator.hpp"
+
+#include <cassert>
+#include <iterator>
+#include <utility>
+
+DeletionQueue::~DeletionQueue()
+{
+	destroy();
+}
+
+// The device has to be idle, whatever is still pending is released right away
+void DeletionQueue::destroy()
+{
+	if (m_initialized)
+	{
+		flush();
+	}
+	m_initialized = false;
+}
+
+void DeletionQueue::init()
+{
+	assert(!m_initialized);
+	m_initialized = true;
+	m_device = &Locator::getDevice();
+	m_frame = 0;
+}
+
+void DeletionQueue::push(std::function<void()> release)
+{
+	assert(m_initialized);
+	auto lock = std::lock_guard{ m_mutex };
+	m_entries.push_back(Entry{ m_frame, std::move(release) });
+}
+
+void DeletionQueue::releaseBuffer(VkBuffer buffer, VkDeviceMemory memory)
+{
+	if (buffer == VK_NULL_HANDLE && memory == VK_NULL_HANDLE) return;
+	push([device = m_device, buffer, memory] {
+		vkDestroyBuffer(device->getDevice(), buffer, nullptr);
+		device->getMemoryTracker().free(memory);
+	});
+}
+
+void DeletionQueue::releaseImage(VkImage image, VkImageView imageView, VkDeviceMemory memory)
+{
+	if (image == VK_NULL_HANDLE && imageView == VK_NULL_HANDLE && memory == VK_NULL_HANDLE) return;
+	push([device = m_device, image, imageView, memory] {
+		vkDestroyImageView(device->getDevice(), imageView, nullptr);
+		vkDestroyImage(device->getDevice(), image, nullptr);
+		device->getMemoryTracker().free(memory);
+	});
+}
+
+// Called once per frame after the frame fence was waited on
+void DeletionQueue::update()
+{
+	assert(m_initialized);
+	auto expired = std::vector<Entry>{};
+	{
+		auto lock = std::lock_guard{ m_mutex };
+		m_frame++;
+		while (!m_entries.empty() && m_entries.front().frame + FRAME_DELAY <= m_frame)
+		{
+			expired.push_back(std::move(m_entries.front()));
+			m_entries.pop_front();
+		}
+	}
+	run(expired);
+}
+
+// Releases can push further releases, a framebuffer retiring its attachments for example, so this loops until empty
+void DeletionQueue::flush()
+{
+	assert(m_initialized);
+	while (true)
+	{
+		auto pending = std::vector<Entry>{};
+		{
+			auto lock = std::lock_guard{ m_mutex };
+			if (m_entries.empty()) return;
+			pending.assign(std::make_move_iterator(m_entries.begin()), std::make_move_iterator(m_entries.end()));
+			m_entries.clear();
+		}
+		run(pending);
+	}
+}
+
+void DeletionQueue::run(std::vector<Entry>& entries)
+{
+	for (auto& entry : entries)
+		entry.release();
+}
+
+uint64_t DeletionQueue::getFrame()
+{
+	assert(m_initialized);
+	auto lock = std::lock_guard{ m_mutex };
+	return m_frame;
+}
+
+uint32_t DeletionQueue::getPendingCount()
+{
+	assert(m_initialized);
+	auto lock = std::lock_guard{ m_mutex };
+	return static_cast<uint32_t>(m_entries.size());
+}
\ No newline at end of file
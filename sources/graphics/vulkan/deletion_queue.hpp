@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+class Device;
+
+// Every wrapper hands its handles here instead of destroying them, so resources can be replaced mid-session without
+// waiting for the device to go idle. Entries are tagged with the frame they were retired in and released once
+// enough frame fences have been waited on
+class DeletionQueue
+{
+public:
+	// One frame in flight plus the presentation engine, which may still scan out images of a retired swapchain
+	static constexpr uint64_t FRAME_DELAY = 3;
+
+	~DeletionQueue();
+	void init();
+	void destroy();
+
+	void push(std::function<void()> release);
+	void releaseBuffer(VkBuffer buffer, VkDeviceMemory memory);
+	void releaseImage(VkImage image, VkImageView imageView, VkDeviceMemory memory);
+	void update();
+	void flush();
+	uint64_t getFrame();
+	uint32_t getPendingCount();
+
+private:
+	struct Entry
+	{
+		uint64_t frame;
+		std::function<void()> release;
+	};
+
+	void run(std::vector<Entry>& entries);
+
+private:
+	bool m_initialized = false;
+	Device* m_device{};
+
+	// Staging buffers are released by asset decode jobs
+	std::mutex m_mutex{};
+	uint64_t m_frame{};
+	std::deque<Entry> m_entries{};
+};
\ No newline at end of file
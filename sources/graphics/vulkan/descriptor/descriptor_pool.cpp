@@ -15,6 +15,8 @@ void DescriptorPool::destroy()
 {
 	if (m_initialized)
 	{
+		// Sets freed so far still point into the pool, the device is idle on shutdown
+		m_device->getDeletionQueue().flush();
 		vkDestroyDescriptorPool(m_device->getDevice(), m_pool, nullptr);
 		for (auto layout : m_layouts)
 			vkDestroyDescriptorSetLayout(m_device->getDevice(), layout, nullptr);
@@ -82,6 +84,8 @@ void DescriptorPool::createDescriptorSetLayouts()
 			bind.descriptorType = setInfo.bindings[i].descriptorType;
 			bind.descriptorCount = 1;
 			bind.stageFlags = setInfo.stages;
+			if (setInfo.bindings[i].immutableSampler != VK_NULL_HANDLE)
+				bind.pImmutableSamplers = &setInfo.bindings[i].immutableSampler;
 			bindings[i] = bind;
 		}
 
@@ -105,9 +109,12 @@ DescriptorSetPtr DescriptorPool::createSet(uint32_t setId)
 	if (vkAllocateDescriptorSets(m_device->getDevice(), &allocInfo, &set) != VK_SUCCESS)
 		throw std::runtime_error{ "failed to allocate descriptor sets" };
 
-	auto free = [device = m_device->getDevice(), pool = m_pool, set = set]()
+	// Command buffers of earlier frames may still have the set bound when its last owner lets go
+	auto free = [device = m_device, pool = m_pool, set = set]()
 	{
-		vkFreeDescriptorSets(device, pool, 1, &set);
+		device->getDeletionQueue().push([device, pool, set] {
+			vkFreeDescriptorSets(device->getDevice(), pool, 1, &set);
+		});
 	};
 
 	auto descriptorSet = std::make_shared<DescriptorSet>(free, set);
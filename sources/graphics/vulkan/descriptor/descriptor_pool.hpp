@@ -11,6 +11,8 @@ struct DescriptorSet
 {
 public:
 	DescriptorSet(std::function<void()> free, VkDescriptorSet set) : m_free{ free }, m_set{set} {};
+	DescriptorSet(const DescriptorSet&) = delete;
+	~DescriptorSet() { m_free(); };
 	VkDescriptorSet getSet() { return m_set; };
 
 private:
@@ -7,6 +7,7 @@
 struct BindingInfo
 {
 	VkDescriptorType descriptorType;
+	VkSampler immutableSampler = VK_NULL_HANDLE; // baked into the layout, writes only need the image view
 };
 
 struct DescriptorSetInfo
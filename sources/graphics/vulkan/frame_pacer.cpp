@@ -0,0 +1,62 @@
+#include "graphics/vulkan/frame_pacer.hpp"
+#include "graphics/vulkan/context/swapchain.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <thread>
+
+void FramePacer::init(GLFWwindow* window, Swapchain& swapchain)
+{
+	assert(!m_initialized);
+	m_initialized = true;
+	m_window = window;
+	m_swapchain = &swapchain;
+	m_frameStart = Clock::now();
+}
+
+void FramePacer::wait()
+{
+	assert(m_initialized);
+
+	// A minimized window has nothing to present to, sleep until it is restored or asked to close
+	while (glfwGetWindowAttrib(m_window, GLFW_ICONIFIED) && !glfwWindowShouldClose(m_window))
+		glfwWaitEventsTimeout(0.1);
+
+	auto presentId = m_swapchain->getPresentId();
+	if (presentWait && presentId > maxQueuedFrames)
+		m_swapchain->waitForPresent(presentId - maxQueuedFrames, PRESENT_TIMEOUT);
+
+	auto focused = glfwGetWindowAttrib(m_window, GLFW_FOCUSED) != 0;
+	m_throttled = !focused;
+	auto fps = focused ? (limitEnabled ? targetFps : 0.0f) : (limitEnabled ? std::min(targetFps, backgroundFps) : backgroundFps);
+	if (fps > 0.0f)
+	{
+		auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(1.0f / fps));
+		sleepUntil(m_frameStart + interval);
+	}
+
+	auto now = Clock::now();
+	m_frameTime = std::chrono::duration<float, std::milli>(now - m_frameStart).count();
+	m_frameStart = now;
+}
+
+void FramePacer::sleepUntil(Clock::time_point deadline)
+{
+	if (auto sleepEnd = deadline - SPIN_TIME; Clock::now() < sleepEnd)
+		std::this_thread::sleep_until(sleepEnd);
+	while (Clock::now() < deadline)
+		std::this_thread::yield();
+}
+
+// Milliseconds between the starts of the last two frames
+float FramePacer::getFrameTime()
+{
+	assert(m_initialized);
+	return m_frameTime;
+}
+
+bool FramePacer::isThrottled()
+{
+	assert(m_initialized);
+	return m_throttled;
+}
\ No newline at end of file
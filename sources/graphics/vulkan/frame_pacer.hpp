@@ -0,0 +1,41 @@
+#pragma once
+
+#include <GLFW/glfw3.h>
+
+#include <chrono>
+#include <cstdint>
+
+class Swapchain;
+
+// Decides when the next frame may start. Waiting happens before input is sampled, so whatever the frame shows
+// is as fresh as possible: on present completion when present wait is available, then on the frame limit
+class FramePacer
+{
+public:
+	void init(GLFWwindow* window, Swapchain& swapchain);
+	void wait();
+	float getFrameTime();
+	bool isThrottled();
+
+	bool limitEnabled = false;
+	float targetFps = 144.0f;
+	float backgroundFps = 20.0f; // unfocused windows are limited to this even with the limit disabled
+	bool presentWait = true;
+	uint32_t maxQueuedFrames = 1; // presents allowed to be pending when the next frame starts
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	void sleepUntil(Clock::time_point deadline);
+
+private:
+	const std::chrono::microseconds SPIN_TIME{ 1500 }; // os sleeps overshoot, the rest is spun
+	const uint64_t PRESENT_TIMEOUT = 100'000'000; // ns
+
+	bool m_initialized = false;
+	GLFWwindow* m_window{};
+	Swapchain* m_swapchain{};
+	Clock::time_point m_frameStart{};
+	float m_frameTime{};
+	bool m_throttled = false;
+};
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "graphics/vulkan/gpu_timer.hpp"
+#include "graphics/vulkan/locator.hpp"
+
+#include <stdexcept>
+#include <cassert>
+
+GpuTimer::~GpuTimer()
+{
+	destroy();
+}
+
+void GpuTimer::destroy()
+{
+	if (m_initialized)
+	{
+		if (m_supported) vkDestroyQueryPool(m_device->getDevice(), m_queryPool, nullptr);
+	}
+	m_initialized = false;
+}
+
+void GpuTimer::init(uint32_t scopeCount)
+{
+	assert(!m_initialized);
+	m_initialized = true;
+	m_device = &Locator::getDevice();
+	m_scopeCount = scopeCount;
+	m_timestamps.resize(scopeCount * 2);
+	m_times.resize(scopeCount);
+	createQueryPool();
+}
+
+void GpuTimer::createQueryPool()
+{
+	auto gpuProps = VkPhysicalDeviceProperties{};
+	vkGetPhysicalDeviceProperties(m_device->getGpu(), &gpuProps);
+
+	auto queueFamilyCount = uint32_t{};
+	vkGetPhysicalDeviceQueueFamilyProperties(m_device->getGpu(), &queueFamilyCount, nullptr);
+	auto queueFamilies = std::vector<VkQueueFamilyProperties>(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(m_device->getGpu(), &queueFamilyCount, queueFamilies.data());
+	auto graphicsFamily = m_device->findQueueFamilies(m_device->getGpu()).graphics.value();
+
+	m_timestampPeriod = gpuProps.limits.timestampPeriod;
+	m_supported = gpuProps.limits.timestampPeriod > 0.0f && queueFamilies[graphicsFamily].timestampValidBits > 0;
+	if (!m_supported) return;
+
+	auto createInfo = VkQueryPoolCreateInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	createInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	createInfo.queryCount = m_scopeCount * 2;
+	if (vkCreateQueryPool(m_device->getDevice(), &createInfo, nullptr, &m_queryPool) != VK_SUCCESS)
+		throw std::runtime_error{ "failed to create timestamp query pool" };
+}
+
+void GpuTimer::reset(VkCommandBuffer commandBuffer)
+{
+	assert(m_initialized);
+	if (!m_supported) return;
+	vkCmdResetQueryPool(commandBuffer, m_queryPool, 0, m_scopeCount * 2);
+	m_pending = true;
+}
+
+void GpuTimer::begin(VkCommandBuffer commandBuffer, uint32_t scope)
+{
+	assert(m_initialized);
+	assert(scope < m_scopeCount);
+	if (!m_supported) return;
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_queryPool, scope * 2);
+}
+
+void GpuTimer::end(VkCommandBuffer commandBuffer, uint32_t scope)
+{
+	assert(m_initialized);
+	assert(scope < m_scopeCount);
+	if (!m_supported) return;
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_queryPool, scope * 2 + 1);
+}
+
+bool GpuTimer::fetch()
+{
+	assert(m_initialized);
+	if (!m_supported || !m_pending) return false;
+
+	auto result = vkGetQueryPoolResults(m_device->getDevice(), m_queryPool, 0, m_scopeCount * 2,
+		m_timestamps.size() * sizeof(uint64_t), m_timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+	if (result != VK_SUCCESS) return false;
+
+	for (uint32_t i = 0; i < m_scopeCount; i++)
+	{
+		auto ticks = m_timestamps[i * 2 + 1] - m_timestamps[i * 2];
+		m_times[i] = static_cast<float>(static_cast<double>(ticks) * m_timestampPeriod / 1000000.0);
+	}
+	m_pending = false;
+	return true;
+}
+
+float GpuTimer::getTime(uint32_t scope)
+{
+	assert(m_initialized);
+	assert(scope < m_scopeCount);
+	return m_times[scope];
+}
+
+bool GpuTimer::isSupported()
+{
+	assert(m_initialized);
+	return m_supported;
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "graphics/vulkan/context/device.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+class GpuTimer
+{
+public:
+	~GpuTimer();
+	void init(uint32_t scopeCount);
+	void destroy();
+
+	void reset(VkCommandBuffer commandBuffer);
+	void begin(VkCommandBuffer commandBuffer, uint32_t scope);
+	void end(VkCommandBuffer commandBuffer, uint32_t scope);
+	bool fetch();
+
+	float getTime(uint32_t scope);
+	bool isSupported();
+
+private:
+	void createQueryPool();
+
+private:
+	bool m_initialized = false;
+	Device* m_device{};
+	VkQueryPool m_queryPool{};
+	uint32_t m_scopeCount{};
+	float m_timestampPeriod{};
+	bool m_supported = false;
+	bool m_pending = false;
+	std::vector<uint64_t> m_timestamps{};
+	std::vector<float> m_times{};
+};
\ No newline at end of file
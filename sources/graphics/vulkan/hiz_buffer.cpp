@@ -0,0 +1,213 @@
+#include "graphics/vulkan/hiz_buffer.hpp"
+#include "graphics/vulkan/locator.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <stdexcept>
+#include <utility>
+
+HiZBuffer::~HiZBuffer()
+{
+	destroy();
+}
+
+void HiZBuffer::destroy()
+{
+	if (m_initialized)
+	{
+		releaseImage();
+		m_pipeline.destroy();
+		for (auto& set : m_levelSets)
+			set.reset();
+	}
+	m_initialized = false;
+}
+
+void HiZBuffer::init(const std::string& name, uint32_t width, uint32_t height)
+{
+	assert(!m_initialized);
+	m_initialized = true;
+	m_device = &Locator::getDevice();
+	m_name = name;
+	auto& descriptorPool = Locator::getDescriptorPool();
+
+	auto pipelineInfo = ComputePipelineProps{};
+	pipelineInfo.computePath = "resources/shaders/hiz/shader.comp.spv";
+	pipelineInfo.descriptorSetLayouts = { descriptorPool.getLayout(4) };
+	m_pipeline.init(pipelineInfo);
+
+	// Depth is read texel by texel, levels are picked explicitly by the tests
+	auto samplerInfo = SamplerCache::getDefaultInfo();
+	samplerInfo.magFilter = VK_FILTER_NEAREST;
+	samplerInfo.minFilter = VK_FILTER_NEAREST;
+	samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerInfo.anisotropyEnable = VK_FALSE;
+	m_sampler = m_device->getSamplerCache().get(samplerInfo);
+
+	for (uint32_t i = 0; i < MAX_LEVELS; i++)
+	{
+		m_levelSets[i] = descriptorPool.createSet(4);
+		m_levelParams[i].init(m_levelSets[i], 0);
+	}
+	createImage(width, height);
+}
+
+// Sized after the depth attachment's max extent, the contents are dropped
+void HiZBuffer::resize(uint32_t width, uint32_t height)
+{
+	assert(m_initialized);
+	releaseImage();
+	createImage(width, height);
+}
+
+void HiZBuffer::createImage(uint32_t width, uint32_t height)
+{
+	const auto format = VK_FORMAT_R32_SFLOAT;
+	m_extent = { std::bit_floor(std::max(width, 1u)), std::bit_floor(std::max(height, 1u)) };
+	m_levelCount = std::min(static_cast<uint32_t>(std::bit_width(std::max(m_extent.width, m_extent.height))), MAX_LEVELS);
+
+	m_device->createImage(m_extent.width, m_extent.height, m_levelCount, format, VK_IMAGE_TILING_OPTIMAL,
+		VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		m_image, m_imageMemory, MemoryCategory::RenderTarget, m_name + " hiz"
+	);
+	m_device->transitionImageLayout(m_image, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, m_levelCount);
+	m_imageView = m_device->createImageView(m_image, format, VK_IMAGE_ASPECT_COLOR_BIT, m_levelCount);
+
+	for (uint32_t i = 0; i < m_levelCount; i++)
+	{
+		auto createInfo = VkImageViewCreateInfo{};
+		createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		createInfo.image = m_image;
+		createInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		createInfo.format = format;
+		createInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		createInfo.subresourceRange.baseMipLevel = i;
+		createInfo.subresourceRange.levelCount = 1;
+		createInfo.subresourceRange.baseArrayLayer = 0;
+		createInfo.subresourceRange.layerCount = 1;
+		if (vkCreateImageView(m_device->getDevice(), &createInfo, nullptr, &m_levelViews[i]) != VK_SUCCESS)
+			throw std::runtime_error{ "failed to create hiz level view" };
+
+		// Level 0 reads the depth attachment, its source size is set on every build
+		if (i == 0) continue;
+		m_levelParams[i].write(HiZLevel{
+			.sourceSize = { std::max(m_extent.width >> (i - 1), 1u), std::max(m_extent.height >> (i - 1), 1u) },
+			.levelSize = { std::max(m_extent.width >> i, 1u), std::max(m_extent.height >> i, 1u) },
+		});
+		writeLevel(i, m_levelViews[i - 1], VK_IMAGE_LAYOUT_GENERAL);
+	}
+	m_sourceView = VK_NULL_HANDLE;
+	m_valid = false;
+}
+
+void HiZBuffer::releaseImage()
+{
+	for (uint32_t i = 0; i < m_levelCount; i++)
+		m_device->getDeletionQueue().releaseImage(VK_NULL_HANDLE, std::exchange(m_levelViews[i], VK_NULL_HANDLE), VK_NULL_HANDLE);
+	m_device->getDeletionQueue().releaseImage(m_image, m_imageView, m_imageMemory);
+	m_levelCount = 0;
+}
+
+void HiZBuffer::writeLevel(uint32_t level, VkImageView source, VkImageLayout sourceLayout)
+{
+	auto sourceInfo = VkDescriptorImageInfo{};
+	sourceInfo.imageLayout = sourceLayout;
+	sourceInfo.imageView = source;
+	sourceInfo.sampler = m_sampler;
+
+	auto destinationInfo = VkDescriptorImageInfo{};
+	destinationInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+	destinationInfo.imageView = m_levelViews[level];
+
+	auto descriptorWrites = std::array<VkWriteDescriptorSet, 2>{};
+	descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	descriptorWrites[0].dstSet = m_levelSets[level]->getSet();
+	descriptorWrites[0].dstBinding = 1;
+	descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descriptorWrites[0].descriptorCount = 1;
+	descriptorWrites[0].pImageInfo = &sourceInfo;
+
+	descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	descriptorWrites[1].dstSet = m_levelSets[level]->getSet();
+	descriptorWrites[1].dstBinding = 2;
+	descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	descriptorWrites[1].descriptorCount = 1;
+	descriptorWrites[1].pImageInfo = &destinationInfo;
+	vkUpdateDescriptorSets(m_device->getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+}
+
+// Outside of any render pass, after the pass that wrote the depth has ended
+void HiZBuffer::build(VkCommandBuffer commandBuffer, Texture& depth, VkExtent2D depthExtent)
+{
+	assert(m_initialized);
+	// Attachments get new views when they are resized
+	if (auto view = depth.getImageView(); view != m_sourceView)
+	{
+		writeLevel(0, view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		m_sourceView = view;
+	}
+	m_levelParams[0].write(HiZLevel{
+		.sourceSize = { depthExtent.width, depthExtent.height },
+		.levelSize = { m_extent.width, m_extent.height },
+	});
+
+	// Earlier culling dispatches of the frame may still read the previous pyramid
+	auto barrier = VkMemoryBarrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		0, 1, &barrier, 0, nullptr, 0, nullptr
+	);
+
+	m_pipeline.bind(commandBuffer);
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	for (uint32_t i = 0; i < m_levelCount; i++)
+	{
+		auto set = m_levelSets[i]->getSet();
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline.getLayout(), 0, 1, &set, 0, nullptr);
+		auto width = std::max(m_extent.width >> i, 1u);
+		auto height = std::max(m_extent.height >> i, 1u);
+		vkCmdDispatch(commandBuffer, (width + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, (height + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1);
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			0, 1, &barrier, 0, nullptr, 0, nullptr
+		);
+	}
+	m_valid = true;
+}
+
+VkImageView HiZBuffer::getImageView()
+{
+	assert(m_initialized);
+	return m_imageView;
+}
+
+VkSampler HiZBuffer::getSampler()
+{
+	assert(m_initialized);
+	return m_sampler;
+}
+
+VkExtent2D HiZBuffer::getExtent()
+{
+	assert(m_initialized);
+	return m_extent;
+}
+
+uint32_t HiZBuffer::getLevelCount()
+{
+	assert(m_initialized);
+	return m_levelCount;
+}
+
+// False until the first build after creation or a resize, there is nothing to test against before
+bool HiZBuffer::isValid()
+{
+	assert(m_initialized);
+	return m_valid;
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "graphics/vulkan/types.hpp"
+#include "graphics/vulkan/uniform_buffer.hpp"
+#include "graphics/vulkan/compute_pipeline.hpp"
+#include "graphics/vulkan/descriptor/descriptor_pool.hpp"
+#include "graphics/vulkan/image/texture.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+// Depth pyramid where every texel holds the farthest depth below it, built from a depth attachment with one
+// compute dispatch per level. Level 0 is the largest power of two that fits the attachment
+class HiZBuffer
+{
+public:
+	static constexpr uint32_t MAX_LEVELS = 16;
+	static constexpr uint32_t WORKGROUP_SIZE = 8;
+
+	~HiZBuffer();
+	void init(const std::string& name, uint32_t width, uint32_t height);
+	void destroy();
+	void resize(uint32_t width, uint32_t height);
+
+	void build(VkCommandBuffer commandBuffer, Texture& depth, VkExtent2D depthExtent);
+	VkImageView getImageView();
+	VkSampler getSampler();
+	VkExtent2D getExtent();
+	uint32_t getLevelCount();
+	bool isValid();
+
+private:
+	void createImage(uint32_t width, uint32_t height);
+	void releaseImage();
+	void writeLevel(uint32_t level, VkImageView source, VkImageLayout sourceLayout);
+
+private:
+	bool m_initialized = false;
+	Device* m_device{};
+	std::string m_name{};
+	ComputePipeline m_pipeline{};
+	VkSampler m_sampler{};
+
+	VkImage m_image{};
+	VkDeviceMemory m_imageMemory{};
+	VkImageView m_imageView{};
+	std::array<VkImageView, MAX_LEVELS> m_levelViews{};
+	std::array<DescriptorSetPtr, MAX_LEVELS> m_levelSets{};
+	std::array<UniformBuffer<HiZLevel>, MAX_LEVELS> m_levelParams{};
+	VkExtent2D m_extent{};
+	uint32_t m_levelCount{};
+	VkImageView m_sourceView{}; // depth view level 0 was last written with
+	bool m_valid = false;
+};
\ No newline at end of file
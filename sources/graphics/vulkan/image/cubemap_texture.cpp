@@ -19,12 +19,10 @@ void CubemapTexture::destroy()
 {
     if (m_initialized)
     {
-        vkDestroyImageView(m_device->getDevice(), m_imageView, nullptr);
-        vkDestroySampler(m_device->getDevice(), m_sampler, nullptr);
-        vkDestroyImage(m_device->getDevice(), m_image, nullptr);
-        vkFreeMemory(m_device->getDevice(), m_imageMemory, nullptr);
+        m_device->getDeletionQueue().releaseImage(m_image, m_imageView, m_imageMemory);
     }
     m_initialized = false;
+    m_ready = false;
 }
 
 void CubemapTexture::init(const std::string& imageDirPath, DescriptorSetPtr descriptorSet, uint32_t binding)
@@ -33,48 +31,72 @@ void CubemapTexture::init(const std::string& imageDirPath, DescriptorSetPtr desc
     m_initialized = true;
     m_device = &Locator::getDevice();
     m_descriptorSet = descriptorSet;
+    m_binding = binding;
     m_format = VK_FORMAT_R8G8B8A8_SRGB;
-    createImage(imageDirPath);
-    createImageView(VK_IMAGE_ASPECT_COLOR_BIT);
-    createImageSampler();
-    writeDescriptorSet(binding);
+
+    auto& assetLoader = Locator::getAssetLoader();
+    writeDescriptorSet(assetLoader.getPlaceholderCubeView(), assetLoader.getPlaceholderSampler());
+    loadImage(imageDirPath);
 }
 
-void CubemapTexture::createImage(const std::string& imageDirPath)
+void CubemapTexture::loadImage(const std::string& imageDirPath)
 {
     using namespace std::literals;
     auto sides = { "right", "left", "top", "bottom", "forward", "back" };
-    VkDeviceSize sideSize = WIDTH * WIDTH * 4;
-    VkDeviceSize size = sideSize * 6;
-    auto buffer = std::vector<stbi_uc>(size);
+    VkDeviceSize sideSize = WIDTH * HEIGHT * 4;
+    auto stagingBuffer = std::make_shared<Buffer>();
+    stagingBuffer->init(sideSize * sides.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        MemoryCategory::Staging, imageDirPath);
+    auto* data = static_cast<stbi_uc*>(stagingBuffer->map());
+
+    // Every face is decoded by its own job straight into its slice of the staging buffer,
+    // the upload is a continuation that starts once all of them finished
+    auto& assetLoader = Locator::getAssetLoader();
+    auto faces = std::make_shared<JobCounter>();
     for (auto [i, side] : std::views::enumerate(sides))
     {
-        auto imageFile = cmrc::images::get_filesystem().open(imageDirPath + "/"s + side + ".png"s);
-        int width, height, channels;
-        auto* pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(imageFile.begin()), imageFile.size(), &width, &height, &channels, STBI_rgb_alpha);
-        assert(WIDTH == width);
-        assert(HEIGHT == height);
-        if (pixels == nullptr)
-            throw std::runtime_error{ "failed to load image" };
-        std::copy(pixels, pixels + sideSize, buffer.begin() + (i * sideSize));
-        stbi_image_free(pixels);
+        auto sidePath = imageDirPath + "/"s + side + ".png"s;
+        auto* sideData = data + i * sideSize;
+        assetLoader.run([sidePath, sideData, sideSize, faces] {
+            auto imageFile = cmrc::images::get_filesystem().open(sidePath);
+            int width, height, channels;
+            auto* pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(imageFile.begin()), imageFile.size(), &width, &height, &channels, STBI_rgb_alpha);
+            if (pixels == nullptr)
+                throw std::runtime_error{ "failed to load image" };
+            assert(WIDTH == width);
+            assert(HEIGHT == height);
+            std::copy(pixels, pixels + sideSize, sideData);
+            stbi_image_free(pixels);
+        }, *faces);
     }
 
-    auto stagingBuffer = Buffer{};
-    stagingBuffer.init(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-    auto* data = stagingBuffer.map();
-    memcpy(data, buffer.data(), buffer.size());
-    stagingBuffer.unmap();
-
-    m_mipLevels = 1;
-    m_device->createImage(WIDTH, HEIGHT, m_mipLevels, 6, m_format, VK_IMAGE_TILING_OPTIMAL,
-        VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_image, m_imageMemory
-    );
-    m_device->transitionImageLayout(m_image, 6, m_format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_mipLevels);
-    m_device->copyBufferToImage(stagingBuffer, m_image, WIDTH, HEIGHT, 6);
-    m_device->transitionImageLayout(m_image, 6, m_format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, m_mipLevels);
+    assetLoader.load(*faces, [this, imageDirPath, stagingBuffer] {
+        auto record = [this, imageDirPath, stagingBuffer](VkCommandBuffer commandBuffer) {
+            stagingBuffer->unmap();
+            m_mipLevels = 1;
+            m_device->createImage(WIDTH, HEIGHT, m_mipLevels, 6, m_format, VK_IMAGE_TILING_OPTIMAL,
+                VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_image, m_imageMemory, MemoryCategory::Texture, imageDirPath
+            );
+            m_device->transitionImageLayout(m_image, 6, m_format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_mipLevels, VK_IMAGE_ASPECT_COLOR_BIT, commandBuffer);
+
+            auto region = VkBufferImageCopy{};
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.layerCount = 6;
+            region.imageExtent = { WIDTH, HEIGHT, 1 };
+            vkCmdCopyBufferToImage(commandBuffer, stagingBuffer->getBuffer(), m_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+            m_device->transitionImageLayout(m_image, 6, m_format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, m_mipLevels, VK_IMAGE_ASPECT_COLOR_BIT, commandBuffer);
+        };
+        auto complete = [this] {
+            createImageView(VK_IMAGE_ASPECT_COLOR_BIT);
+            createImageSampler();
+            writeDescriptorSet(m_imageView, m_sampler);
+            m_ready = true;
+        };
+        return AssetUpload{ record, complete };
+    });
 }
 
 void CubemapTexture::createImageView(VkImageAspectFlags aspect)
@@ -84,40 +106,24 @@ void CubemapTexture::createImageView(VkImageAspectFlags aspect)
 
 void CubemapTexture::createImageSampler()
 {
-    auto gpuProps = VkPhysicalDeviceProperties{};
-    vkGetPhysicalDeviceProperties(m_device->getGpu(), &gpuProps);
-
-    auto createInfo = VkSamplerCreateInfo{};
-    createInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-    createInfo.magFilter = VK_FILTER_LINEAR;
-    createInfo.minFilter = VK_FILTER_LINEAR;
+    auto createInfo = SamplerCache::getDefaultInfo();
     createInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
     createInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
     createInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-    createInfo.anisotropyEnable = VK_TRUE;
-    createInfo.maxAnisotropy = gpuProps.limits.maxSamplerAnisotropy;
-    createInfo.unnormalizedCoordinates = VK_FALSE;
-    createInfo.compareEnable = VK_FALSE;
-    createInfo.compareOp = VK_COMPARE_OP_ALWAYS;
-    createInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-    createInfo.mipLodBias = 0.0f;
-    createInfo.minLod = 0.0f;
-    createInfo.maxLod = static_cast<float>(m_mipLevels);
-    if (vkCreateSampler(m_device->getDevice(), &createInfo, nullptr, &m_sampler) != VK_SUCCESS)
-        throw std::runtime_error("failed to create texture sampler!");
+    m_sampler = m_device->getSamplerCache().get(createInfo);
 }
 
-void CubemapTexture::writeDescriptorSet(uint32_t binding)
+void CubemapTexture::writeDescriptorSet(VkImageView imageView, VkSampler sampler)
 {
     auto samplerInfo = VkDescriptorImageInfo{};
     samplerInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    samplerInfo.imageView = m_imageView;
-    samplerInfo.sampler = m_sampler;
+    samplerInfo.imageView = imageView;
+    samplerInfo.sampler = sampler;
 
     auto descriptorWrite = VkWriteDescriptorSet{};
     descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     descriptorWrite.dstSet = m_descriptorSet->getSet();
-    descriptorWrite.dstBinding = binding;
+    descriptorWrite.dstBinding = m_binding;
     descriptorWrite.dstArrayElement = 0;
     descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
     descriptorWrite.pImageInfo = &samplerInfo;
@@ -125,21 +131,26 @@ void CubemapTexture::writeDescriptorSet(uint32_t binding)
     vkUpdateDescriptorSets(m_device->getDevice(), 1, &descriptorWrite, 0, nullptr);
 }
 
-void CubemapTexture::bind(VkCommandBuffer commandBuffer, VkPipelineLayout layout, uint32_t setId)
+void CubemapTexture::bind(CommandRecorder& recorder, VkPipelineLayout layout, uint32_t setId)
 {
     assert(m_initialized);
-    auto set = m_descriptorSet->getSet();
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, setId, 1, &set, 0, nullptr);
+    recorder.bindDescriptorSet(layout, setId, m_descriptorSet->getSet());
 }
 
 VkImageView CubemapTexture::getImageView()
 {
     assert(m_initialized);
-    return m_imageView;
+    return m_ready ? m_imageView : Locator::getAssetLoader().getPlaceholderCubeView();
 }
 
 VkSampler CubemapTexture::getSampler()
 {
     assert(m_initialized);
-    return m_sampler;
+    return m_ready ? m_sampler : Locator::getAssetLoader().getPlaceholderSampler();
+}
+
+bool CubemapTexture::isReady()
+{
+    assert(m_initialized);
+    return m_ready;
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "graphics/vulkan/context/device.hpp"
 #include "graphics/vulkan/image/texture.hpp"
+#include "graphics/vulkan/asset_loader.hpp"
 
 #include <string>
 
@@ -12,18 +13,21 @@ public:
 	void init(const std::string& imageDirPath, DescriptorSetPtr descriptorSet, uint32_t binding = 0);
 	void destroy();
 
-	void bind(VkCommandBuffer commandBuffer, VkPipelineLayout layout, uint32_t setId) override;
+	void bind(CommandRecorder& recorder, VkPipelineLayout layout, uint32_t setId) override;
 	VkImageView getImageView() override;
 	VkSampler getSampler() override;
+	bool isReady();
 
 private:
-	void createImage(const std::string& imageDirPath);
+	void loadImage(const std::string& imageDirPath);
 	void createImageView(VkImageAspectFlags aspect);
 	void createImageSampler();
-	void writeDescriptorSet(uint32_t binding);
+	void writeDescriptorSet(VkImageView imageView, VkSampler sampler);
 
 private:
 	bool m_initialized = false;
+	bool m_ready = false;
+	uint32_t m_binding{};
 	const uint32_t WIDTH = 1024;
 	const uint32_t HEIGHT = 1024;
 	Device* m_device;
@@ -1,14 +1,36 @@
 #include "graphics/vulkan/image/image_texture.hpp"
 #include "graphics/vulkan/locator.hpp"
+#include "graphics/vulkan/texture_streamer.hpp"
+#include "assets/ktx_file.hpp"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
 #include <cmrc/cmrc.hpp>
 CMRC_DECLARE(images);
+CMRC_DECLARE(textures);
 
 #include <stdexcept>
 #include <cassert>
+#include <numeric>
+#include <print>
+#include <utility>
+
+namespace
+{
+    // Owns an image recorded for upload until the completion adopts it, so dropped uploads do not leak
+    struct PendingImage
+    {
+        Device* device;
+        VkImage image{};
+        VkDeviceMemory memory{};
+
+        ~PendingImage()
+        {
+            device->getDeletionQueue().releaseImage(image, VK_NULL_HANDLE, memory);
+        }
+    };
+}
 
 ImageTexture::~ImageTexture()
 {
@@ -19,12 +41,12 @@ void ImageTexture::destroy()
 {
     if (m_initialized)
     {
-        vkDestroyImageView(m_device->getDevice(), m_imageView, nullptr);
-        vkDestroySampler(m_device->getDevice(), m_sampler, nullptr);
-        vkDestroyImage(m_device->getDevice(), m_image, nullptr);
-        vkFreeMemory(m_device->getDevice(), m_imageMemory, nullptr);
+        if (m_streamed) Locator::getTextureStreamer().remove(*this);
+        m_device->getDeletionQueue().releaseImage(m_image, m_imageView, m_imageMemory);
     }
     m_initialized = false;
+    m_ready = false;
+    m_streamed = false;
 }
 
 void ImageTexture::init(const std::string& imagePath, DescriptorSetPtr descriptorSet, uint32_t binding)
@@ -33,14 +55,128 @@ void ImageTexture::init(const std::string& imagePath, DescriptorSetPtr descripto
     m_initialized = true;
     m_device = &Locator::getDevice();
     m_descriptorSet = descriptorSet;
-    m_format = VK_FORMAT_R8G8B8A8_SRGB;
-    createImage(imagePath);
-    createImageView(VK_IMAGE_ASPECT_COLOR_BIT);
-    createImageSampler(false);
-    writeDescriptorSet(binding);
+    m_name = imagePath;
+    m_binding = binding;
+
+    auto& assetLoader = Locator::getAssetLoader();
+    writeDescriptorSet(assetLoader.getPlaceholderView(), assetLoader.getPlaceholderSampler());
+    assetLoader.load([this, imagePath] {
+        auto upload = AssetUpload{};
+        if (!loadCookedImage(imagePath, upload))
+            upload = loadImage(imagePath);
+        return upload;
+    });
+}
+
+bool ImageTexture::loadCookedImage(const std::string& imagePath, AssetUpload& upload)
+{
+    auto ktxPath = imagePath.substr(0, imagePath.find_last_of(".")) + ".ktx2";
+    if (!cmrc::textures::get_filesystem().exists(ktxPath))
+        return false;
+
+    auto ktxFile = cmrc::textures::get_filesystem().open(ktxPath);
+    auto ktx = KtxFile{};
+    ktx.init({ ktxFile.begin(), ktxFile.size() });
+
+    auto formatProperties = VkFormatProperties{};
+    vkGetPhysicalDeviceFormatProperties(m_device->getGpu(), ktx.getFormat(), &formatProperties);
+    auto required = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    if ((formatProperties.optimalTilingFeatures & required) != required)
+    {
+        std::println("{}: format {} is not supported, falling back to rgba8", ktxPath, static_cast<int>(ktx.getFormat()));
+        return false;
+    }
+
+    // Only the mip tail is loaded up front, the streamer asks for finer levels once the texture is drawn
+    auto levelSizes = std::vector<VkDeviceSize>(ktx.getLevelCount());
+    for (uint32_t i = 0; i < ktx.getLevelCount(); i++)
+        levelSizes[i] = ktx.getLevel(i).size();
+    auto size = std::max(ktx.getWidth(), ktx.getHeight());
+    auto tailLevel = TextureStreamer::getTailLevel(ktx.getWidth(), ktx.getHeight(), ktx.getLevelCount());
+
+    upload = loadLevels(ktx, tailLevel);
+    upload.complete = [this, complete = upload.complete, ktxPath, levelSizes, size, tailLevel] {
+        m_ktxPath = ktxPath;
+        m_levelSizes = levelSizes;
+        m_size = size;
+        m_tailLevel = tailLevel;
+        m_streamed = true;
+        complete();
+        Locator::getTextureStreamer().add(*this);
+    };
+    return true;
 }
 
-void ImageTexture::createImage(const std::string& imagePath)
+// Stages levels [baseLevel, levelCount) for a new image, which replaces the current one once uploaded.
+// Cooked levels are read straight from the embedded file, so evicting and streaming back needs no cpu copy
+AssetUpload ImageTexture::loadLevels(const KtxFile& ktx, uint32_t baseLevel)
+{
+    auto levelCount = ktx.getLevelCount() - baseLevel;
+    auto regions = std::vector<VkBufferImageCopy>(levelCount);
+    auto size = VkDeviceSize{};
+    for (uint32_t i = 0; i < levelCount; i++)
+    {
+        auto level = baseLevel + i;
+        size = (size + 15) & ~VkDeviceSize{ 15 };
+        regions[i].bufferOffset = size;
+        regions[i].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        regions[i].imageSubresource.mipLevel = i;
+        regions[i].imageSubresource.layerCount = 1;
+        regions[i].imageExtent = { std::max(ktx.getWidth() >> level, 1u), std::max(ktx.getHeight() >> level, 1u), 1 };
+        size += ktx.getLevel(level).size();
+    }
+
+    auto stagingBuffer = std::make_shared<Buffer>();
+    stagingBuffer->init(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        MemoryCategory::Staging, m_name
+    );
+    auto* data = static_cast<char*>(stagingBuffer->map());
+    for (uint32_t i = 0; i < levelCount; i++)
+        memcpy(data + regions[i].bufferOffset, ktx.getLevel(baseLevel + i).data(), ktx.getLevel(baseLevel + i).size());
+    stagingBuffer->unmap();
+
+    auto format = ktx.getFormat();
+    auto pending = std::make_shared<PendingImage>(m_device);
+    auto record = [this, stagingBuffer, regions, format, pending](VkCommandBuffer commandBuffer) {
+        auto levelCount = static_cast<uint32_t>(regions.size());
+        m_device->createImage(regions[0].imageExtent.width, regions[0].imageExtent.height, levelCount, format, VK_IMAGE_TILING_OPTIMAL,
+            VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, pending->image, pending->memory, MemoryCategory::Texture, m_name
+        );
+
+        m_device->transitionImageLayout(pending->image, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, levelCount, VK_IMAGE_ASPECT_COLOR_BIT, commandBuffer);
+        vkCmdCopyBufferToImage(commandBuffer, stagingBuffer->getBuffer(), pending->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, levelCount, regions.data());
+        m_device->transitionImageLayout(pending->image, format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, levelCount, VK_IMAGE_ASPECT_COLOR_BIT, commandBuffer);
+    };
+    // The descriptor is rewritten after the frame fence, the old image waits in the deletion queue for later frames
+    auto complete = [this, pending, format, baseLevel, levelCount] {
+        m_device->getDeletionQueue().releaseImage(m_image, m_imageView, m_imageMemory);
+        m_image = std::exchange(pending->image, VK_NULL_HANDLE);
+        m_imageMemory = std::exchange(pending->memory, VK_NULL_HANDLE);
+        m_format = format;
+        m_mipLevels = levelCount;
+        m_residentLevel = baseLevel;
+        m_streaming = false;
+        completeImage();
+    };
+    return { record, complete };
+}
+
+void ImageTexture::streamLevels(uint32_t baseLevel)
+{
+    assert(m_initialized);
+    assert(m_streamed && !m_streaming);
+    m_streaming = true;
+    Locator::getAssetLoader().load([this, baseLevel] {
+        auto ktxFile = cmrc::textures::get_filesystem().open(m_ktxPath);
+        auto ktx = KtxFile{};
+        ktx.init({ ktxFile.begin(), ktxFile.size() });
+        return loadLevels(ktx, baseLevel);
+    });
+}
+
+AssetUpload ImageTexture::loadImage(const std::string& imagePath)
 {
     int width, height, channels;
     auto imageFile = cmrc::images::get_filesystem().open(imagePath);
@@ -49,36 +185,54 @@ void ImageTexture::createImage(const std::string& imagePath)
     if (pixels == nullptr)
         throw std::runtime_error{ "failed to load image" };
 
-    auto stagingBuffer = Buffer{};
-    stagingBuffer.init(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+    auto stagingBuffer = std::make_shared<Buffer>();
+    stagingBuffer->init(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        MemoryCategory::Staging, m_name
     );
-    auto* data = stagingBuffer.map();
+    auto* data = stagingBuffer->map();
     memcpy(data, pixels, static_cast<size_t>(size));
-    stagingBuffer.unmap();
+    stagingBuffer->unmap();
     stbi_image_free(pixels);
 
-    m_mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
-    m_device->createImage(width, height, m_mipLevels, m_format, VK_IMAGE_TILING_OPTIMAL,
-        VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_image, m_imageMemory
-    );
+    auto record = [this, stagingBuffer, width, height](VkCommandBuffer commandBuffer) {
+        m_format = VK_FORMAT_R8G8B8A8_SRGB;
+        m_mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
+        m_device->createImage(width, height, m_mipLevels, m_format, VK_IMAGE_TILING_OPTIMAL,
+            VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_image, m_imageMemory, MemoryCategory::Texture, m_name
+        );
 
-    m_device->transitionImageLayout(m_image, m_format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_mipLevels);
-    m_device->copyBufferToImage(stagingBuffer, m_image, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+        m_device->transitionImageLayout(m_image, m_format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_mipLevels, VK_IMAGE_ASPECT_COLOR_BIT, commandBuffer);
 
-    generateMipmaps(m_image, m_format, width, height, m_mipLevels);
+        auto region = VkBufferImageCopy{};
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = { static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1 };
+        vkCmdCopyBufferToImage(commandBuffer, stagingBuffer->getBuffer(), m_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+        generateMipmaps(commandBuffer, m_image, m_format, width, height, m_mipLevels);
+    };
+    return { record, [this] { completeImage(); } };
+}
+
+// The upload fence signalled, swap the placeholder or the previous residency for the new image
+void ImageTexture::completeImage()
+{
+    createImageView(VK_IMAGE_ASPECT_COLOR_BIT);
+    if (m_sampler == VK_NULL_HANDLE)
+        createImageSampler(false);
+    writeDescriptorSet(m_imageView, m_sampler);
+    m_ready = true;
 }
 
-void ImageTexture::generateMipmaps(VkImage image, VkFormat imageFormat, int32_t width, int32_t height, uint32_t mipLevels)
+void ImageTexture::generateMipmaps(VkCommandBuffer commandBuffer, VkImage image, VkFormat imageFormat, int32_t width, int32_t height, uint32_t mipLevels)
 {
     auto formatProperties = VkFormatProperties{};
     vkGetPhysicalDeviceFormatProperties(m_device->getGpu(), imageFormat, &formatProperties);
     if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT))
         throw std::runtime_error("texture image format does not support linear blitting!");
 
-    auto commandBuffer = m_device->beginSingleTimeCommands();
-
     auto barrier = VkImageMemoryBarrier{};
     barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
     barrier.image = image;
@@ -147,8 +301,6 @@ void ImageTexture::generateMipmaps(VkImage image, VkFormat imageFormat, int32_t
         0, nullptr,
         0, nullptr,
         1, &barrier);
-
-    m_device->endSingleTimeCommands(commandBuffer);
 }
 
 void ImageTexture::createImageView(VkImageAspectFlags aspect)
@@ -158,41 +310,27 @@ void ImageTexture::createImageView(VkImageAspectFlags aspect)
 
 void ImageTexture::createImageSampler(bool depth)
 {
-    auto gpuProps = VkPhysicalDeviceProperties{};
-    vkGetPhysicalDeviceProperties(m_device->getGpu(), &gpuProps);
-
-    auto createInfo = VkSamplerCreateInfo{};
-    createInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-    createInfo.magFilter = VK_FILTER_LINEAR;
-    createInfo.minFilter = VK_FILTER_LINEAR;
-    createInfo.addressModeU = depth ? VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER : VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    createInfo.addressModeV = depth ? VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER : VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    createInfo.addressModeW = depth ? VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER : VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    createInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
-    createInfo.anisotropyEnable = VK_TRUE;
-    createInfo.maxAnisotropy = gpuProps.limits.maxSamplerAnisotropy;
-    createInfo.unnormalizedCoordinates = VK_FALSE;
-    createInfo.compareEnable = VK_FALSE;
-    createInfo.compareOp = VK_COMPARE_OP_ALWAYS;
-    createInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-    createInfo.mipLodBias = 0.0f;
-    createInfo.minLod = 0.0f;
-    createInfo.maxLod = static_cast<float>(m_mipLevels);
-    if (vkCreateSampler(m_device->getDevice(), &createInfo, nullptr, &m_sampler) != VK_SUCCESS)
-        throw std::runtime_error("failed to create texture sampler!");
-}
-
-void ImageTexture::writeDescriptorSet(uint32_t binding)
+    auto createInfo = SamplerCache::getDefaultInfo();
+    if (depth)
+    {
+        createInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+        createInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+        createInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+    }
+    m_sampler = m_device->getSamplerCache().get(createInfo);
+}
+
+void ImageTexture::writeDescriptorSet(VkImageView imageView, VkSampler sampler)
 {
     auto samplerInfo = VkDescriptorImageInfo{};
     samplerInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    samplerInfo.imageView = m_imageView;
-    samplerInfo.sampler = m_sampler;
+    samplerInfo.imageView = imageView;
+    samplerInfo.sampler = sampler;
 
     auto descriptorWrite = VkWriteDescriptorSet{};
     descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     descriptorWrite.dstSet = m_descriptorSet->getSet();
-    descriptorWrite.dstBinding = binding;
+    descriptorWrite.dstBinding = m_binding;
     descriptorWrite.dstArrayElement = 0;
     descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
     descriptorWrite.pImageInfo = &samplerInfo;
@@ -200,21 +338,62 @@ void ImageTexture::writeDescriptorSet(uint32_t binding)
     vkUpdateDescriptorSets(m_device->getDevice(), 1, &descriptorWrite, 0, nullptr);
 }
 
-void ImageTexture::bind(VkCommandBuffer commandBuffer, VkPipelineLayout layout, uint32_t setId)
+void ImageTexture::bind(CommandRecorder& recorder, VkPipelineLayout layout, uint32_t setId)
 {
     assert(m_initialized);
-    auto set = m_descriptorSet->getSet();
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, setId, 1, &set, 0, nullptr);
+    recorder.bindDescriptorSet(layout, setId, m_descriptorSet->getSet());
 }
 
 VkImageView ImageTexture::getImageView()
 {
     assert(m_initialized);
-    return m_imageView;
+    return m_ready ? m_imageView : Locator::getAssetLoader().getPlaceholderView();
 }
 
 VkSampler ImageTexture::getSampler()
 {
     assert(m_initialized);
-    return m_sampler;
+    return m_ready ? m_sampler : Locator::getAssetLoader().getPlaceholderSampler();
+}
+
+bool ImageTexture::isReady()
+{
+    assert(m_initialized);
+    return m_ready;
+}
+
+bool ImageTexture::isStreaming()
+{
+    assert(m_initialized);
+    return m_streaming;
+}
+
+uint32_t ImageTexture::getSize()
+{
+    assert(m_initialized);
+    return m_size;
+}
+
+uint32_t ImageTexture::getLevelCount()
+{
+    assert(m_initialized);
+    return static_cast<uint32_t>(m_levelSizes.size());
+}
+
+uint32_t ImageTexture::getTailLevel()
+{
+    assert(m_initialized);
+    return m_tailLevel;
+}
+
+uint32_t ImageTexture::getResidentLevel()
+{
+    assert(m_initialized);
+    return m_residentLevel;
+}
+
+VkDeviceSize ImageTexture::getLevelsSize(uint32_t baseLevel)
+{
+    assert(m_initialized);
+    return std::accumulate(m_levelSizes.begin() + baseLevel, m_levelSizes.end(), VkDeviceSize{});
 }
\ No newline at end of file
@@ -2,8 +2,12 @@
 
 #include "graphics/vulkan/context/device.hpp"
 #include "graphics/vulkan/image/texture.hpp"
+#include "graphics/vulkan/asset_loader.hpp"
 
 #include <string>
+#include <vector>
+
+class KtxFile;
 
 class ImageTexture : public Texture
 {
@@ -12,20 +16,35 @@ public:
 	void init(const std::string& imagePath, DescriptorSetPtr descriptorSet, uint32_t binding = 0);
 	void destroy();
 
-	void bind(VkCommandBuffer commandBuffer, VkPipelineLayout layout, uint32_t setId) override;
+	void bind(CommandRecorder& recorder, VkPipelineLayout layout, uint32_t setId) override;
 	VkImageView getImageView() override;
 	VkSampler getSampler() override;
+	bool isReady();
+
+	// Streaming, only cooked textures are streamed, everything else stays fully resident
+	void streamLevels(uint32_t baseLevel);
+	bool isStreaming();
+	uint32_t getSize();
+	uint32_t getLevelCount();
+	uint32_t getTailLevel();
+	uint32_t getResidentLevel();
+	VkDeviceSize getLevelsSize(uint32_t baseLevel);
 
 private:
-	void createImage(const std::string& imagePath);
+	bool loadCookedImage(const std::string& imagePath, AssetUpload& upload);
+	AssetUpload loadLevels(const KtxFile& ktx, uint32_t baseLevel);
+	AssetUpload loadImage(const std::string& imagePath);
+	void completeImage();
 	void createImageView(VkImageAspectFlags aspect);
 	void createImageSampler(bool depth);
-	void generateMipmaps(VkImage image, VkFormat imageFormat, int32_t width, int32_t height, uint32_t mipLevels);
-	void writeDescriptorSet(uint32_t binding);
+	void generateMipmaps(VkCommandBuffer commandBuffer, VkImage image, VkFormat imageFormat, int32_t width, int32_t height, uint32_t mipLevels);
+	void writeDescriptorSet(VkImageView imageView, VkSampler sampler);
 
 private:
 	bool m_initialized = false;
+	bool m_ready = false;
 	Device* m_device;
+	uint32_t m_binding{};
 	VkFormat m_format{};
 
 	VkImage m_image{};
@@ -34,4 +53,13 @@ private:
 	VkSampler m_sampler{};
 	uint32_t m_mipLevels{};
 	DescriptorSetPtr m_descriptorSet{};
+	std::string m_name{};
+
+	bool m_streamed = false;
+	bool m_streaming = false;
+	std::string m_ktxPath{};
+	uint32_t m_size{};
+	uint32_t m_tailLevel{};
+	uint32_t m_residentLevel{};
+	std::vector<VkDeviceSize> m_levelSizes{};
 };
\ No newline at end of file
@@ -13,29 +13,44 @@ void RenderTexture::destroy()
 {
     if (m_initialized)
     {
-        vkDestroyImageView(m_device->getDevice(), m_imageView, nullptr);
-        vkDestroySampler(m_device->getDevice(), m_sampler, nullptr);
-        vkDestroyImage(m_device->getDevice(), m_image, nullptr);
-        vkFreeMemory(m_device->getDevice(), m_imageMemory, nullptr);
+        // Swapchain images belong to the swapchain, only the view is ours
+        if (m_descriptorSet)
+            m_device->getDeletionQueue().releaseImage(m_image, m_imageView, m_imageMemory);
+        else
+            m_device->getDeletionQueue().releaseImage(VK_NULL_HANDLE, m_imageView, VK_NULL_HANDLE);
     }
     m_initialized = false;
 }
 
-void RenderTexture::init(AttachmentType attachmentType, uint32_t width, uint32_t height, VkFormat format, DescriptorSetPtr descriptorSet, uint32_t binding)
+void RenderTexture::init(AttachmentType attachmentType, uint32_t width, uint32_t height, VkFormat format, const std::string& name, DescriptorSetPtr descriptorSet, uint32_t binding)
 {
     assert(!m_initialized);
     m_initialized = true;
     m_device = &Locator::getDevice();
     m_descriptorSet = descriptorSet;
     m_format = format;
+    m_attachmentType = attachmentType;
+    m_name = name;
+    m_binding = binding;
     m_mipLevels = 1;
-    createImage(attachmentType, width, height);
+    createImage(attachmentType, width, height, name);
     createImageView(attachmentType == AttachmentType::Color ? VK_IMAGE_ASPECT_COLOR_BIT : VK_IMAGE_ASPECT_DEPTH_BIT);
     createImageSampler(attachmentType == AttachmentType::Depth);
     writeDescriptorSet(binding);
     m_initialized = true;
 }
 
+// Keeps the descriptor set and rewrites it with the new image, which is only safe once the frame fence was waited on
+void RenderTexture::resize(uint32_t width, uint32_t height)
+{
+    assert(m_initialized);
+    assert(m_descriptorSet && "swapchain images are recreated with the swapchain");
+    m_device->getDeletionQueue().releaseImage(m_image, m_imageView, m_imageMemory);
+    createImage(m_attachmentType, width, height, m_name);
+    createImageView(m_attachmentType == AttachmentType::Color ? VK_IMAGE_ASPECT_COLOR_BIT : VK_IMAGE_ASPECT_DEPTH_BIT);
+    writeDescriptorSet(m_binding);
+}
+
 void RenderTexture::init(VkImage swapchainImage, VkFormat format)
 {
     assert(!m_initialized);
@@ -48,7 +63,7 @@ void RenderTexture::init(VkImage swapchainImage, VkFormat format)
     m_initialized = true;
 }
 
-void RenderTexture::createImage(AttachmentType attachmentType, uint32_t width, uint32_t height)
+void RenderTexture::createImage(AttachmentType attachmentType, uint32_t width, uint32_t height, const std::string& name)
 {
     auto usage = VkImageUsageFlags{};
     usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
@@ -60,7 +75,7 @@ void RenderTexture::createImage(AttachmentType attachmentType, uint32_t width, u
 
     m_device->createImage(
         width, height, m_mipLevels, m_format, VK_IMAGE_TILING_OPTIMAL,
-        usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_image, m_imageMemory
+        usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_image, m_imageMemory, MemoryCategory::RenderTarget, name
     );
 
     auto aspect = attachmentType == AttachmentType::Color ? VK_IMAGE_ASPECT_COLOR_BIT : VK_IMAGE_ASPECT_DEPTH_BIT;
@@ -74,28 +89,14 @@ void RenderTexture::createImageView(VkImageAspectFlags aspect)
 
 void RenderTexture::createImageSampler(bool depth)
 {
-    auto gpuProps = VkPhysicalDeviceProperties{};
-    vkGetPhysicalDeviceProperties(m_device->getGpu(), &gpuProps);
-
-    auto createInfo = VkSamplerCreateInfo{};
-    createInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-    createInfo.magFilter = VK_FILTER_LINEAR;
-    createInfo.minFilter = VK_FILTER_LINEAR;
-    createInfo.addressModeU = depth ? VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER : VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    createInfo.addressModeV = depth ? VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER : VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    createInfo.addressModeW = depth ? VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER : VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    createInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
-    createInfo.anisotropyEnable = VK_TRUE;
-    createInfo.maxAnisotropy = gpuProps.limits.maxSamplerAnisotropy;
-    createInfo.unnormalizedCoordinates = VK_FALSE;
-    createInfo.compareEnable = VK_FALSE;
-    createInfo.compareOp = VK_COMPARE_OP_ALWAYS;
-    createInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-    createInfo.mipLodBias = 0.0f;
-    createInfo.minLod = 0.0f;
-    createInfo.maxLod = static_cast<float>(m_mipLevels);
-    if (vkCreateSampler(m_device->getDevice(), &createInfo, nullptr, &m_sampler) != VK_SUCCESS)
-        throw std::runtime_error("failed to create texture sampler!");
+    auto createInfo = SamplerCache::getDefaultInfo();
+    if (depth)
+    {
+        createInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+        createInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+        createInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+    }
+    m_sampler = m_device->getSamplerCache().get(createInfo);
 }
 
 void RenderTexture::writeDescriptorSet(uint32_t binding)
@@ -116,11 +117,10 @@ void RenderTexture::writeDescriptorSet(uint32_t binding)
     vkUpdateDescriptorSets(m_device->getDevice(), 1, &descriptorWrite, 0, nullptr);
 }
 
-void RenderTexture::bind(VkCommandBuffer commandBuffer, VkPipelineLayout layout, uint32_t setId)
+void RenderTexture::bind(CommandRecorder& recorder, VkPipelineLayout layout, uint32_t setId)
 {
     assert(m_initialized);
-    auto set = m_descriptorSet->getSet();
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, setId, 1, &set, 0, nullptr);
+    recorder.bindDescriptorSet(layout, setId, m_descriptorSet->getSet());
 }
 
 VkImageView RenderTexture::getImageView()
@@ -15,16 +15,17 @@ class RenderTexture : public Texture
 {
 public:
 	~RenderTexture();
-	void init(AttachmentType attachmentType, uint32_t width, uint32_t height, VkFormat format, DescriptorSetPtr descriptorSet, uint32_t binding = 0);
+	void init(AttachmentType attachmentType, uint32_t width, uint32_t height, VkFormat format, const std::string& name, DescriptorSetPtr descriptorSet, uint32_t binding = 0);
 	void init(VkImage swapchainImage, VkFormat format);
 	void destroy();
+	void resize(uint32_t width, uint32_t height);
 
-	void bind(VkCommandBuffer commandBuffer, VkPipelineLayout layout, uint32_t setId) override;
+	void bind(CommandRecorder& recorder, VkPipelineLayout layout, uint32_t setId) override;
 	VkImageView getImageView() override;
 	VkSampler getSampler() override;
 
 private:
-	void createImage(AttachmentType attachmentType, uint32_t width, uint32_t height);
+	void createImage(AttachmentType attachmentType, uint32_t width, uint32_t height, const std::string& name);
 	void createImageView(VkImageAspectFlags aspect);
 	void createImageSampler(bool depth);
 	void writeDescriptorSet(uint32_t binding);
@@ -33,6 +34,9 @@ private:
 	bool m_initialized = false;
 	Device* m_device;
 	VkFormat m_format{};
+	AttachmentType m_attachmentType{};
+	std::string m_name{};
+	uint32_t m_binding{};
 
 	VkImage m_image{};
 	VkDeviceMemory m_imageMemory{};
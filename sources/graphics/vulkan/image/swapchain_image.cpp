@@ -13,7 +13,7 @@ void SwapchainImage::destroy()
 {
     if (m_initialized)
     {
-        vkDestroyImageView(m_device->getDevice(), m_imageView, nullptr);
+        m_device->getDeletionQueue().releaseImage(VK_NULL_HANDLE, m_imageView, VK_NULL_HANDLE);
     }
     m_initialized = false;
 }
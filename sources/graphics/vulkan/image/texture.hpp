@@ -1,9 +1,10 @@
 #pragma once
 
 #include "graphics/vulkan/image/sampler.hpp"
+#include "graphics/vulkan/command_recorder.hpp"
 
 class Texture : public Sampler
 {
 public:
-	virtual void bind(VkCommandBuffer commandBuffer, VkPipelineLayout layout, uint32_t setId) = 0;
+	virtual void bind(CommandRecorder& recorder, VkPipelineLayout layout, uint32_t setId) = 0;
 };
\ No newline at end of file
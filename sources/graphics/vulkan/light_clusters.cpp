@@ -0,0 +1,141 @@
+#include "graphics/vulkan/light_clusters.hpp"
+#include "graphics/vulkan/locator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+
+LightClusters::~LightClusters()
+{
+	destroy();
+}
+
+void LightClusters::destroy()
+{
+	if (m_initialized)
+	{
+		m_indexBuffer.destroy();
+		m_countBuffer.destroy();
+		m_lightBuffer.destroy();
+		m_pipeline.destroy();
+		m_descriptorSet.reset();
+	}
+	m_initialized = false;
+}
+
+void LightClusters::init()
+{
+	assert(!m_initialized);
+	m_initialized = true;
+	m_device = &Locator::getDevice();
+	auto& descriptorPool = Locator::getDescriptorPool();
+	m_descriptorSet = descriptorPool.createSet(3);
+
+	auto pipelineInfo = ComputePipelineProps{};
+	pipelineInfo.computePath = "resources/shaders/clusters/shader.comp.spv";
+	pipelineInfo.descriptorSetLayouts = { descriptorPool.getLayout(3) };
+	m_pipeline.init(pipelineInfo);
+
+	m_params.init(m_descriptorSet, 0);
+	createBuffers();
+	writeDescriptorSet();
+	m_lightCount = 0;
+}
+
+void LightClusters::createBuffers()
+{
+	// Lights are rewritten every frame after the frame fence, so a host visible buffer is read in place
+	m_lightBuffer.init(MAX_LIGHTS * sizeof(LocalLight), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		MemoryCategory::Buffer, "cluster lights"
+	);
+	m_lightsMapped = static_cast<LocalLight*>(m_lightBuffer.map());
+
+	auto clusterCount = getClusterCount();
+	m_countBuffer.init(clusterCount * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MemoryCategory::Buffer, "cluster light counts"
+	);
+	m_indexBuffer.init(clusterCount * MAX_LIGHTS_PER_CLUSTER * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MemoryCategory::Buffer, "cluster light indices"
+	);
+}
+
+void LightClusters::writeDescriptorSet()
+{
+	auto buffers = std::array{ &m_lightBuffer, &m_countBuffer, &m_indexBuffer };
+	auto bufferInfos = std::array<VkDescriptorBufferInfo, 3>{};
+	auto descriptorWrites = std::array<VkWriteDescriptorSet, 3>{};
+	for (uint32_t i = 0; i < buffers.size(); i++)
+	{
+		bufferInfos[i].buffer = buffers[i]->getBuffer();
+		bufferInfos[i].offset = 0;
+		bufferInfos[i].range = VK_WHOLE_SIZE;
+
+		descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrites[i].dstSet = m_descriptorSet->getSet();
+		descriptorWrites[i].dstBinding = i + 1;
+		descriptorWrites[i].dstArrayElement = 0;
+		descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		descriptorWrites[i].pBufferInfo = &bufferInfos[i];
+		descriptorWrites[i].descriptorCount = 1;
+	}
+	vkUpdateDescriptorSets(m_device->getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+}
+
+// Lights past MAX_LIGHTS are ignored
+void LightClusters::setLights(std::span<const LocalLight> lights)
+{
+	assert(m_initialized);
+	m_lightCount = static_cast<uint32_t>(std::min<size_t>(lights.size(), MAX_LIGHTS));
+	if (m_lightCount > 0)
+		memcpy(m_lightsMapped, lights.data(), m_lightCount * sizeof(LocalLight));
+}
+
+// The projection has to be the unjittered one, clusters are looked up by pixel and a subpixel offset does not matter
+void LightClusters::update(const glm::mat4& view, const glm::mat4& proj, VkExtent2D renderExtent, float nearPlane, float farPlane)
+{
+	assert(m_initialized);
+	auto params = ClusterParams{};
+	params.view = view;
+	params.invProj = glm::inverse(proj);
+	params.grid = glm::uvec4{ GRID_SIZE, MAX_LIGHTS_PER_CLUSTER };
+	params.screen = glm::vec4{ renderExtent.width, renderExtent.height, nearPlane, farPlane };
+	params.lightCount = m_lightCount;
+	m_params.write(params);
+}
+
+// Records the binning dispatch and makes its results visible to fragment shaders, outside of any render pass
+void LightClusters::build(VkCommandBuffer commandBuffer)
+{
+	assert(m_initialized);
+	m_pipeline.bind(commandBuffer);
+	auto set = m_descriptorSet->getSet();
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline.getLayout(), 0, 1, &set, 0, nullptr);
+	vkCmdDispatch(commandBuffer, (getClusterCount() + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+	auto barrier = VkMemoryBarrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+		0, 1, &barrier, 0, nullptr, 0, nullptr
+	);
+}
+
+void LightClusters::bind(CommandRecorder& recorder, VkPipelineLayout layout, uint32_t setId)
+{
+	assert(m_initialized);
+	recorder.bindDescriptorSet(layout, setId, m_descriptorSet->getSet());
+}
+
+uint32_t LightClusters::getLightCount()
+{
+	assert(m_initialized);
+	return m_lightCount;
+}
+
+uint32_t LightClusters::getClusterCount()
+{
+	return GRID_SIZE.x * GRID_SIZE.y * GRID_SIZE.z;
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "graphics/vulkan/types.hpp"
+#include "graphics/vulkan/buffer.hpp"
+#include "graphics/vulkan/uniform_buffer.hpp"
+#include "graphics/vulkan/compute_pipeline.hpp"
+#include "graphics/vulkan/descriptor/descriptor_pool.hpp"
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <span>
+
+// Bins point and spot lights into view space froxels with a compute pass. Tiles follow the render extent and
+// slices are exponential in depth, so the main pass only loops over the lights listed for its fragment's cluster
+class LightClusters
+{
+public:
+	static constexpr glm::uvec3 GRID_SIZE{ 16, 9, 24 };
+	static constexpr uint32_t MAX_LIGHTS = 16384;
+	static constexpr uint32_t MAX_LIGHTS_PER_CLUSTER = 128; // lights past this are dropped from the cluster
+	static constexpr uint32_t WORKGROUP_SIZE = 64;
+
+	~LightClusters();
+	void init();
+	void destroy();
+
+	void setLights(std::span<const LocalLight> lights);
+	void update(const glm::mat4& view, const glm::mat4& proj, VkExtent2D renderExtent, float nearPlane, float farPlane);
+	void build(VkCommandBuffer commandBuffer);
+	void bind(CommandRecorder& recorder, VkPipelineLayout layout, uint32_t setId);
+	uint32_t getLightCount();
+	uint32_t getClusterCount();
+
+private:
+	void createBuffers();
+	void writeDescriptorSet();
+
+private:
+	bool m_initialized = false;
+	Device* m_device{};
+	DescriptorSetPtr m_descriptorSet{};
+	ComputePipeline m_pipeline{};
+	UniformBuffer<ClusterParams> m_params{};
+	Buffer m_lightBuffer{};
+	LocalLight* m_lightsMapped{};
+	Buffer m_countBuffer{};
+	Buffer m_indexBuffer{};
+	uint32_t m_lightCount{};
+};
\ No newline at end of file
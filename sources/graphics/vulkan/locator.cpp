@@ -8,6 +8,10 @@ Context* Locator::m_context = nullptr;
 Device* Locator::m_device = nullptr;
 Swapchain* Locator::m_swapchain = nullptr;
 DescriptorPool* Locator::m_descriptorPool = nullptr;
+AssetLoader* Locator::m_assetLoader = nullptr;
+TextureStreamer* Locator::m_textureStreamer = nullptr;
+AssetManager* Locator::m_assetManager = nullptr;
+JobSystem* Locator::m_jobSystem = nullptr;
 
 Window& Locator::getWindow()
 {
@@ -45,6 +49,30 @@ DescriptorPool& Locator::getDescriptorPool()
 	return *m_descriptorPool;
 }
 
+AssetLoader& Locator::getAssetLoader()
+{
+	assert(m_assetLoader != nullptr);
+	return *m_assetLoader;
+}
+
+TextureStreamer& Locator::getTextureStreamer()
+{
+	assert(m_textureStreamer != nullptr);
+	return *m_textureStreamer;
+}
+
+AssetManager& Locator::getAssetManager()
+{
+	assert(m_assetManager != nullptr);
+	return *m_assetManager;
+}
+
+JobSystem& Locator::getJobSystem()
+{
+	assert(m_jobSystem != nullptr);
+	return *m_jobSystem;
+}
+
 void Locator::setWindow(Window* window)
 {
 	assert(m_window == nullptr);
@@ -79,4 +107,28 @@ void Locator::setDescriptorPool(DescriptorPool* descriptorPool)
 {
 	assert(m_descriptorPool == nullptr);
 	m_descriptorPool = descriptorPool;
+}
+
+void Locator::setAssetLoader(AssetLoader* assetLoader)
+{
+	assert(m_assetLoader == nullptr);
+	m_assetLoader = assetLoader;
+}
+
+void Locator::setTextureStreamer(TextureStreamer* textureStreamer)
+{
+	assert(m_textureStreamer == nullptr);
+	m_textureStreamer = textureStreamer;
+}
+
+void Locator::setAssetManager(AssetManager* assetManager)
+{
+	assert(m_assetManager == nullptr);
+	m_assetManager = assetManager;
+}
+
+void Locator::setJobSystem(JobSystem* jobSystem)
+{
+	assert(m_jobSystem == nullptr);
+	m_jobSystem = jobSystem;
 }
\ No newline at end of file
@@ -5,7 +5,11 @@ class Renderer;
 class Context;
 class Device;
 class DescriptorPool;
+class AssetLoader;
+class TextureStreamer;
+class AssetManager;
 class Swapchain;
+class JobSystem;
 
 class Locator
 {
@@ -16,6 +20,10 @@ public:
 	static Device& getDevice();
 	static Swapchain& getSwapchain();
 	static DescriptorPool& getDescriptorPool();
+	static AssetLoader& getAssetLoader();
+	static TextureStreamer& getTextureStreamer();
+	static AssetManager& getAssetManager();
+	static JobSystem& getJobSystem();
 
 	static void setWindow(Window* window);
 	static void setRenderer(Renderer* renderer);
@@ -23,6 +31,10 @@ public:
 	static void setDevice(Device* device);
 	static void setSwapchain(Swapchain* swapchain);
 	static void setDescriptorPool(DescriptorPool* descriptorPool);
+	static void setAssetLoader(AssetLoader* assetLoader);
+	static void setTextureStreamer(TextureStreamer* textureStreamer);
+	static void setAssetManager(AssetManager* assetManager);
+	static void setJobSystem(JobSystem* jobSystem);
 
 private:
 	static Window* m_window;
@@ -31,4 +43,8 @@ private:
 	static Device* m_device;
 	static Swapchain* m_swapchain;
 	static DescriptorPool* m_descriptorPool;
+	static AssetLoader* m_assetLoader;
+	static TextureStreamer* m_textureStreamer;
+	static AssetManager* m_assetManager;
+	static JobSystem* m_jobSystem;
 };
\ No newline at end of file
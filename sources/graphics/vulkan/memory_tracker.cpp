@@ -0,0 +1,221 @@
+#include "graphics/vulkan/memory_tracker.hpp"
+#include "graphics/vulkan/context/device.hpp"
+#include "graphics/vulkan/locator.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <print>
+#include <stdexcept>
+
+static std::string escapeJson(const std::string& text)
+{
+	auto escaped = std::string{};
+	escaped.reserve(text.size());
+	for (auto c : text)
+	{
+		if (c == '"' || c == '\\') escaped += '\\';
+		escaped += c;
+	}
+	return escaped;
+}
+
+const char* MemoryTracker::getCategoryName(MemoryCategory category)
+{
+	switch (category)
+	{
+	case MemoryCategory::Buffer: return "buffer";
+	case MemoryCategory::Staging: return "staging";
+	case MemoryCategory::Mesh: return "mesh";
+	case MemoryCategory::Texture: return "texture";
+	case MemoryCategory::RenderTarget: return "render target";
+	default: return "unknown";
+	}
+}
+
+MemoryTracker::~MemoryTracker()
+{
+	destroy();
+}
+
+void MemoryTracker::destroy()
+{
+	if (m_initialized)
+	{
+		for (auto& [memory, allocation] : m_allocations)
+			std::println("leaked {} bytes of {} memory owned by {}", allocation.size, getCategoryName(allocation.category), allocation.owner);
+		m_allocations.clear();
+	}
+	m_initialized = false;
+}
+
+void MemoryTracker::init(bool budgetSupported)
+{
+	assert(!m_initialized);
+	m_initialized = true;
+	m_device = &Locator::getDevice();
+	m_budgetSupported = budgetSupported;
+	m_categorySizes = {};
+	m_categoryCounts = {};
+
+	vkGetPhysicalDeviceMemoryProperties(m_device->getGpu(), &m_memoryProperties);
+	m_heapSizes.assign(m_memoryProperties.memoryHeapCount, 0);
+	m_heaps.resize(m_memoryProperties.memoryHeapCount);
+	update();
+}
+
+VkDeviceMemory MemoryTracker::allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, MemoryCategory category, const std::string& owner)
+{
+	assert(m_initialized);
+	auto allocInfo = VkMemoryAllocateInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocInfo.allocationSize = requirements.size;
+	allocInfo.memoryTypeIndex = m_device->findMemoryType(requirements.memoryTypeBits, properties);
+	auto memory = VkDeviceMemory{};
+	if (vkAllocateMemory(m_device->getDevice(), &allocInfo, nullptr, &memory) != VK_SUCCESS)
+		throw std::runtime_error{ "failed to allocate " + std::string{ getCategoryName(category) } + " memory for " + owner };
+	m_device->setObjectName(VK_OBJECT_TYPE_DEVICE_MEMORY, reinterpret_cast<uint64_t>(memory), owner);
+
+	auto heap = m_memoryProperties.memoryTypes[allocInfo.memoryTypeIndex].heapIndex;
+	auto lock = std::lock_guard{ m_mutex };
+	m_allocations[memory] = Allocation{ category, owner, requirements.size, heap };
+	m_categorySizes[static_cast<size_t>(category)] += requirements.size;
+	m_categoryCounts[static_cast<size_t>(category)]++;
+	m_categoryTotals[static_cast<size_t>(category)] += requirements.size;
+	m_heapSizes[heap] += requirements.size;
+	// Each category is its own memory pool in the profiler
+	TracyAllocN(reinterpret_cast<void*>(memory), requirements.size, getCategoryName(category));
+	return memory;
+}
+
+// The registry entry goes first, a handle freed here may come straight back from another thread's allocate
+void MemoryTracker::free(VkDeviceMemory memory)
+{
+	assert(m_initialized);
+	if (memory == VK_NULL_HANDLE) return;
+	{
+		auto lock = std::lock_guard{ m_mutex };
+		if (auto it = m_allocations.find(memory); it != m_allocations.end())
+		{
+			auto& allocation = it->second;
+			m_categorySizes[static_cast<size_t>(allocation.category)] -= allocation.size;
+			m_categoryCounts[static_cast<size_t>(allocation.category)]--;
+			m_heapSizes[allocation.heap] -= allocation.size;
+			TracyFreeN(reinterpret_cast<void*>(memory), getCategoryName(allocation.category));
+			m_allocations.erase(it);
+		}
+	}
+	vkFreeMemory(m_device->getDevice(), memory, nullptr);
+}
+
+void MemoryTracker::update()
+{
+	assert(m_initialized);
+	auto budgetProps = VkPhysicalDeviceMemoryBudgetPropertiesEXT{};
+	budgetProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+	if (m_budgetSupported)
+	{
+		auto memoryProps = VkPhysicalDeviceMemoryProperties2{};
+		memoryProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+		memoryProps.pNext = &budgetProps;
+		vkGetPhysicalDeviceMemoryProperties2(m_device->getGpu(), &memoryProps);
+	}
+
+	auto lock = std::lock_guard{ m_mutex };
+	for (uint32_t i = 0; i < m_memoryProperties.memoryHeapCount; i++)
+	{
+		auto& heap = m_heaps[i];
+		heap.size = m_memoryProperties.memoryHeaps[i].size;
+		heap.deviceLocal = m_memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+		heap.usage = m_budgetSupported ? budgetProps.heapUsage[i] : m_heapSizes[i];
+		heap.budget = m_budgetSupported ? budgetProps.heapBudget[i] : heap.size;
+	}
+}
+
+// Writes live allocations grouped by category, largest first, next to heap and category totals
+void MemoryTracker::dump(const std::string& path)
+{
+	assert(m_initialized);
+	auto file = std::ofstream{ path };
+	if (!file)
+		throw std::runtime_error{ "failed to open " + path };
+
+	auto lock = std::lock_guard{ m_mutex };
+	auto allocations = std::vector<const Allocation*>{};
+	allocations.reserve(m_allocations.size());
+	for (auto& [memory, allocation] : m_allocations)
+		allocations.push_back(&allocation);
+	std::sort(allocations.begin(), allocations.end(), [](auto* a, auto* b) {
+		return a->category != b->category ? a->category < b->category : a->size > b->size;
+	});
+
+	file << "{\n\t\"heaps\": [\n";
+	for (size_t i = 0; i < m_heaps.size(); i++)
+	{
+		auto& heap = m_heaps[i];
+		file << "\t\t{ \"index\": " << i << ", \"deviceLocal\": " << (heap.deviceLocal ? "true" : "false")
+			<< ", \"size\": " << heap.size << ", \"budget\": " << heap.budget << ", \"usage\": " << heap.usage
+			<< ", \"tracked\": " << m_heapSizes[i] << " }" << (i + 1 < m_heaps.size() ? "," : "") << "\n";
+	}
+	file << "\t],\n\t\"categories\": {\n";
+	for (uint32_t i = 0; i < static_cast<uint32_t>(MemoryCategory::Count); i++)
+	{
+		file << "\t\t\"" << getCategoryName(static_cast<MemoryCategory>(i)) << "\": { \"bytes\": " << m_categorySizes[i]
+			<< ", \"count\": " << m_categoryCounts[i] << " }" << (i + 1 < static_cast<uint32_t>(MemoryCategory::Count) ? "," : "") << "\n";
+	}
+	file << "\t},\n\t\"allocations\": [\n";
+	for (size_t i = 0; i < allocations.size(); i++)
+	{
+		auto& allocation = *allocations[i];
+		file << "\t\t{ \"owner\": \"" << escapeJson(allocation.owner) << "\", \"category\": \"" << getCategoryName(allocation.category)
+			<< "\", \"bytes\": " << allocation.size << ", \"heap\": " << allocation.heap << " }" << (i + 1 < allocations.size() ? "," : "") << "\n";
+	}
+	file << "\t]\n}\n";
+}
+
+const std::vector<MemoryHeapBudget>& MemoryTracker::getHeaps()
+{
+	assert(m_initialized);
+	return m_heaps;
+}
+
+// What the device local heaps can still take before the driver starts evicting or failing allocations
+VkDeviceSize MemoryTracker::getDeviceLocalHeadroom()
+{
+	assert(m_initialized);
+	auto headroom = VkDeviceSize{};
+	for (auto& heap : m_heaps)
+	{
+		if (heap.deviceLocal && heap.budget > heap.usage)
+			headroom += heap.budget - heap.usage;
+	}
+	return headroom;
+}
+
+VkDeviceSize MemoryTracker::getCategorySize(MemoryCategory category)
+{
+	assert(m_initialized);
+	auto lock = std::lock_guard{ m_mutex };
+	return m_categorySizes[static_cast<size_t>(category)];
+}
+
+uint32_t MemoryTracker::getCategoryCount(MemoryCategory category)
+{
+	assert(m_initialized);
+	auto lock = std::lock_guard{ m_mutex };
+	return m_categoryCounts[static_cast<size_t>(category)];
+}
+
+// Bytes ever allocated in the category, the staging total grows by everything uploaded
+uint64_t MemoryTracker::getCategoryTotal(MemoryCategory category)
+{
+	assert(m_initialized);
+	auto lock = std::lock_guard{ m_mutex };
+	return m_categoryTotals[static_cast<size_t>(category)];
+}
+
+bool MemoryTracker::isBudgetSupported()
+{
+	assert(m_initialized);
+	return m_budgetSupported;
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "core/profiler.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Device;
+
+enum class MemoryCategory : uint32_t
+{
+	Buffer,
+	Staging,
+	Mesh,
+	Texture,
+	RenderTarget,
+	Count
+};
+
+struct MemoryHeapBudget
+{
+	VkDeviceSize usage; // whole process, including memory not allocated through the tracker
+	VkDeviceSize budget;
+	VkDeviceSize size;
+	bool deviceLocal;
+};
+
+// Every device memory allocation goes through here, tagged with a category and the resource that owns it.
+// Heap usage and budgets come from VK_EXT_memory_budget when available, otherwise from the registry itself
+class MemoryTracker
+{
+public:
+	static const char* getCategoryName(MemoryCategory category);
+
+	~MemoryTracker();
+	void init(bool budgetSupported);
+	void destroy();
+
+	VkDeviceMemory allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, MemoryCategory category, const std::string& owner);
+	void free(VkDeviceMemory memory);
+	void update();
+	void dump(const std::string& path);
+
+	const std::vector<MemoryHeapBudget>& getHeaps();
+	VkDeviceSize getDeviceLocalHeadroom();
+	VkDeviceSize getCategorySize(MemoryCategory category);
+	uint32_t getCategoryCount(MemoryCategory category);
+	uint64_t getCategoryTotal(MemoryCategory category);
+	bool isBudgetSupported();
+
+private:
+	struct Allocation
+	{
+		MemoryCategory category;
+		std::string owner;
+		VkDeviceSize size;
+		uint32_t heap;
+	};
+
+private:
+	bool m_initialized = false;
+	Device* m_device{};
+	bool m_budgetSupported = false;
+	VkPhysicalDeviceMemoryProperties m_memoryProperties{};
+	std::vector<MemoryHeapBudget> m_heaps{};
+
+	// Staging buffers are allocated by asset decode jobs
+	TracyLockableN(std::mutex, m_mutex, "memory tracker");
+	std::unordered_map<VkDeviceMemory, Allocation> m_allocations{};
+	std::array<VkDeviceSize, static_cast<size_t>(MemoryCategory::Count)> m_categorySizes{};
+	std::array<uint32_t, static_cast<size_t>(MemoryCategory::Count)> m_categoryCounts{};
+	std::array<uint64_t, static_cast<size_t>(MemoryCategory::Count)> m_categoryTotals{};
+	std::vector<VkDeviceSize> m_heapSizes{};
+};
\ No newline at end of file
@@ -1,112 +1,248 @@
 #include "graphics/vulkan/mesh.hpp"
 #include "graphics/vulkan/locator.hpp"
+#include "assets/mesh_file.hpp"
+#include "assets/obj_importer.hpp"
+#include "assets/mesh_packer.hpp"
+#include "assets/mesh_optimizer.hpp"
+#include "assets/mesh_simplifier.hpp"
 
-#define TINYOBJLOADER_IMPLEMENTATION
-#include <tiny_obj_loader.h>
 #include <cmrc/cmrc.hpp>
 CMRC_DECLARE(models);
+CMRC_DECLARE(meshes);
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iterator>
+#include <print>
 
 void Mesh::init(const std::string& modelPath)
 {
 	assert(!m_initialized);
 	m_initialized = true;
 	m_device = &Locator::getDevice();
-	loadModel(modelPath);
-	createVertexBuffer();
-	createIndexBuffer();
+	Locator::getAssetLoader().load([this, modelPath] { return loadModel(modelPath); });
 }
 
-void Mesh::loadModel(const std::string& modelPath)
+// Runs on a job thread, nothing but the staging buffer is touched until the main thread records the upload
+AssetUpload Mesh::loadModel(const std::string& modelPath)
 {
-	auto reader = tinyobj::ObjReader{};
-	auto modelFile = cmrc::models::get_filesystem().open(modelPath);
-	auto modelString = std::string{ modelFile.begin(), modelFile.size() };
-
-	auto mtlPath = modelPath.substr(0, modelPath.find_last_of(".")) + ".mtl";
-	auto mtlFile = cmrc::models::get_filesystem().open(mtlPath);
-	auto mtlString = std::string{ mtlFile.begin(), mtlFile.size() };
-
-	reader.ParseFromString(modelString, mtlString);
-	auto attrib = reader.GetAttrib();
-	auto shapes = reader.GetShapes();
-
-	std::unordered_map<Vertex, uint32_t> uniqueVertices{};
-	for (const auto& shape : shapes) {
-		for (const auto& index : shape.mesh.indices) {
-			Vertex vertex{};
-
-			vertex.pos = {
-				attrib.vertices[3 * index.vertex_index + 0],
-				attrib.vertices[3 * index.vertex_index + 1],
-				attrib.vertices[3 * index.vertex_index + 2]
-			};
-
-			vertex.normal = {
-				attrib.normals[3 * index.normal_index + 0],
-				attrib.normals[3 * index.normal_index + 1],
-				attrib.normals[3 * index.normal_index + 2]
-			};
-
-			vertex.texCoord = {
-				attrib.texcoords[2 * index.texcoord_index + 0],
-				1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
-			};
-
-			vertex.color = { 1.0f, 0.0f, 1.0f };
-
-			if (uniqueVertices.count(vertex) == 0)
-			{
-				uniqueVertices[vertex] = static_cast<uint32_t>(m_vertices.size());
-				m_vertices.push_back(vertex);
-			}
-			m_indices.push_back(uniqueVertices[vertex]);
+	auto start = std::chrono::high_resolution_clock::now();
+	auto basePath = modelPath.substr(0, modelPath.find_last_of("."));
+	auto meshPath = basePath + ".mesh";
+	auto cooked = cmrc::meshes::get_filesystem().exists(meshPath);
+
+	auto vertexCount = uint32_t{};
+	auto indexType = VK_INDEX_TYPE_UINT32;
+	auto bounds = Bounds{};
+	auto submeshes = std::vector<Submesh>{};
+	auto lods = std::vector<MeshLod>{};
+	auto occluderPositions = std::make_shared<std::vector<glm::vec3>>();
+	auto occluderIndices = std::make_shared<std::vector<uint32_t>>();
+	auto stagingBuffer = std::make_shared<Buffer>();
+	VkDeviceSize positionSize{}, attributeSize{}, indexSize{};
+
+	auto stage = [&](std::span<const char> positions, std::span<const char> attributes, std::span<const char> indices) {
+		positionSize = positions.size();
+		attributeSize = attributes.size();
+		indexSize = indices.size();
+		stagingBuffer->init(positionSize + attributeSize + indexSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			MemoryCategory::Staging, modelPath
+		);
+		auto* data = static_cast<char*>(stagingBuffer->map());
+		memcpy(data, positions.data(), positionSize);
+		memcpy(data + positionSize, attributes.data(), attributeSize);
+		memcpy(data + positionSize + attributeSize, indices.data(), indexSize);
+		stagingBuffer->unmap();
+	};
+
+	if (cooked)
+	{
+		// Embedded resources live in the mapped executable image, so the blobs are read in place
+		auto file = cmrc::meshes::get_filesystem().open(meshPath);
+		auto meshFile = MeshFile{};
+		meshFile.init({ file.begin(), file.size() });
+		auto& header = meshFile.getHeader();
+		auto fileSubmeshes = meshFile.getSubmeshes();
+		auto fileLods = meshFile.getLods();
+
+		vertexCount = header.vertexCount;
+		indexType = header.indexSize == 2 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+		bounds = header.bounds;
+		submeshes.assign(fileSubmeshes.begin(), fileSubmeshes.end());
+		lods.assign(fileLods.begin(), fileLods.end());
+		stage(meshFile.getPositionData(), meshFile.getAttributeData(), meshFile.getIndexData());
+		extractOccluder(meshFile.getPositionData(), meshFile.getIndexData(), header.indexSize, lods, *occluderPositions, *occluderIndices);
+	}
+	else
+	{
+		auto modelFile = cmrc::models::get_filesystem().open(modelPath);
+		auto data = ObjImporter::import({ modelFile.begin(), modelFile.size() }, Locator::getJobSystem());
+		MeshSimplifier::generateLods(data);
+		MeshOptimizer::optimize(data);
+
+		auto packed = MeshPacker::pack(data);
+
+		vertexCount = static_cast<uint32_t>(packed.positions.size());
+		indexType = packed.indexSize == 2 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+		bounds = data.bounds;
+		submeshes = data.submeshes;
+		lods = data.lods;
+		stage({ reinterpret_cast<const char*>(packed.positions.data()), sizeof(VertexPosition) * packed.positions.size() },
+			{ reinterpret_cast<const char*>(packed.attributes.data()), sizeof(VertexAttributes) * packed.attributes.size() },
+			{ reinterpret_cast<const char*>(packed.indices.data()), packed.indices.size() });
+		extractOccluder({ reinterpret_cast<const char*>(packed.positions.data()), sizeof(VertexPosition) * packed.positions.size() },
+			{ reinterpret_cast<const char*>(packed.indices.data()), packed.indices.size() },
+			packed.indexSize, lods, *occluderPositions, *occluderIndices);
+	}
+
+	auto time = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - start).count();
+	std::println("{} {}: {} vertices, {} triangles, {} lods in {:.2f} ms",
+		cooked ? "loaded" : "imported", cooked ? meshPath : modelPath, vertexCount, lods[0].indexCount / 3, lods.size(), time);
+
+	auto record = [this, modelPath, stagingBuffer, positionSize, attributeSize, indexSize](VkCommandBuffer commandBuffer) {
+		m_positionBuffer = createBuffer(commandBuffer, *stagingBuffer, 0, positionSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, modelPath + " positions");
+		m_attributeBuffer = createBuffer(commandBuffer, *stagingBuffer, positionSize, attributeSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, modelPath + " attributes");
+		m_indexBuffer = createBuffer(commandBuffer, *stagingBuffer, positionSize + attributeSize, indexSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, modelPath + " indices");
+	};
+	auto complete = [this, vertexCount, indexType, bounds, submeshes, lods, occluderPositions, occluderIndices] {
+		m_vertexCount = vertexCount;
+		m_indexType = indexType;
+		m_bounds = bounds;
+		m_submeshes = submeshes;
+		m_lods = lods;
+		m_occluderPositions = std::move(*occluderPositions);
+		m_occluderIndices = std::move(*occluderIndices);
+		m_dequantization = MeshPacker::getDequantization(m_bounds);
+		m_ready = true;
+	};
+	return { record, complete };
+}
+
+// Copies the coarsest useful lod with only the vertices it references, positions stay in the normalized
+// bounds space so the vertex matrix places them like the quantized ones on the gpu
+void Mesh::extractOccluder(std::span<const char> positions, std::span<const char> indices, uint32_t indexSize,
+	const std::vector<MeshLod>& lods, std::vector<glm::vec3>& occluderPositions, std::vector<uint32_t>& occluderIndices)
+{
+	if (lods.empty()) return;
+	auto lod = std::ranges::find_if(lods, [](const MeshLod& candidate) { return candidate.indexCount / 3 <= MAX_OCCLUDER_TRIANGLES; });
+	if (lod == lods.end()) lod = std::prev(lods.end());
+
+	auto vertexCount = positions.size() / sizeof(VertexPosition);
+	auto remap = std::vector<uint32_t>(vertexCount, UINT32_MAX);
+	occluderIndices.reserve(lod->indexCount);
+	for (uint32_t i = 0; i < lod->indexCount; i++)
+	{
+		auto offset = static_cast<size_t>(lod->indexOffset + i) * indexSize;
+		auto index = uint32_t{};
+		if (indexSize == 2)
+		{
+			auto index16 = uint16_t{};
+			memcpy(&index16, indices.data() + offset, sizeof(index16));
+			index = index16;
+		}
+		else memcpy(&index, indices.data() + offset, sizeof(index));
+
+		if (remap[index] == UINT32_MAX)
+		{
+			auto position = VertexPosition{};
+			memcpy(&position, positions.data() + index * sizeof(VertexPosition), sizeof(position));
+			remap[index] = static_cast<uint32_t>(occluderPositions.size());
+			occluderPositions.push_back(glm::vec3{ position.pos } / 65535.0f);
 		}
+		occluderIndices.push_back(remap[index]);
 	}
 }
 
-void Mesh::createVertexBuffer()
+std::unique_ptr<Buffer> Mesh::createBuffer(VkCommandBuffer commandBuffer, Buffer& stagingBuffer, VkDeviceSize offset, VkDeviceSize size, VkBufferUsageFlags usage, const std::string& name)
 {
-	VkDeviceSize size = sizeof(m_vertices[0]) * m_vertices.size();
-	Buffer stagingBuffer;
-	stagingBuffer.init(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-	auto* data = stagingBuffer.map();
-	memcpy(data, m_vertices.data(), static_cast<size_t>(size));
-	stagingBuffer.unmap();
-	m_vertexBuffer.reset(new Buffer);
-	m_vertexBuffer->init(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-	);
-
-	m_device->copyBuffer(stagingBuffer, *m_vertexBuffer);
+	auto buffer = std::make_unique<Buffer>();
+	buffer->init(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MemoryCategory::Mesh, name);
+
+	auto copyRegion = VkBufferCopy{};
+	copyRegion.srcOffset = offset;
+	copyRegion.dstOffset = 0;
+	copyRegion.size = size;
+	vkCmdCopyBuffer(commandBuffer, stagingBuffer.getBuffer(), buffer->getBuffer(), 1, &copyRegion);
+	return buffer;
 }
 
-void Mesh::createIndexBuffer()
+// Until the upload completed the mesh is an empty placeholder that binds and draws nothing
+void Mesh::bindBuffers(CommandRecorder& recorder)
 {
-	VkDeviceSize size = sizeof(m_indices[0]) * m_indices.size();
-	Buffer stagingBuffer;
-	stagingBuffer.init(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-	auto* data = stagingBuffer.map();
-	memcpy(data, m_indices.data(), static_cast<size_t>(size));
-	stagingBuffer.unmap();
-	m_indexBuffer.reset(new Buffer);
-	m_indexBuffer->init(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-	);
-
-	m_device->copyBuffer(stagingBuffer, *m_indexBuffer);
+	assert(m_initialized);
+	if (!m_ready) return;
+	VkDeviceSize offsets[] = { 0, 0 };
+	VkBuffer buffers[] = { m_positionBuffer->getBuffer(), m_attributeBuffer->getBuffer() };
+	recorder.bindVertexBuffers(Vertex::Binding::Position, 2, buffers, offsets);
+	recorder.bindIndexBuffer(m_indexBuffer->getBuffer(), 0, m_indexType);
 }
 
-void Mesh::bindBuffers(VkCommandBuffer commandBuffer)
+void Mesh::bindPositions(CommandRecorder& recorder)
 {
 	assert(m_initialized);
+	if (!m_ready) return;
 	VkDeviceSize offsets[] = { 0 };
-	auto buffer = m_vertexBuffer->getBuffer();
-	vkCmdBindVertexBuffers(commandBuffer, 0, 1, &buffer, offsets);
-	vkCmdBindIndexBuffer(commandBuffer, m_indexBuffer->getBuffer(), 0, VK_INDEX_TYPE_UINT32);
+	auto buffer = m_positionBuffer->getBuffer();
+	recorder.bindVertexBuffers(Vertex::Binding::Position, 1, &buffer, offsets);
+	recorder.bindIndexBuffer(m_indexBuffer->getBuffer(), 0, m_indexType);
+}
+
+void Mesh::draw(CommandRecorder& recorder, uint32_t lod)
+{
+	assert(m_initialized);
+	if (!m_ready) return;
+	assert(lod < m_lods.size());
+	recorder.drawIndexed(m_lods[lod].indexCount, m_lods[lod].indexOffset);
+}
+
+// The command decides the lod and whether anything is drawn at all
+void Mesh::drawIndirect(CommandRecorder& recorder, VkBuffer buffer, VkDeviceSize offset)
+{
+	assert(m_initialized);
+	if (!m_ready) return;
+	recorder.drawIndexedIndirect(buffer, offset);
+}
+
+const Bounds& Mesh::getBounds()
+{
+	assert(m_initialized);
+	return m_bounds;
+}
+
+const glm::mat4& Mesh::getDequantization()
+{
+	assert(m_initialized);
+	return m_dequantization;
+}
+
+const std::vector<Submesh>& Mesh::getSubmeshes()
+{
+	assert(m_initialized);
+	return m_submeshes;
+}
+
+const std::vector<MeshLod>& Mesh::getLods()
+{
+	assert(m_initialized);
+	return m_lods;
+}
+
+const std::vector<glm::vec3>& Mesh::getOccluderPositions()
+{
+	assert(m_initialized);
+	return m_occluderPositions;
+}
+
+const std::vector<uint32_t>& Mesh::getOccluderIndices()
+{
+	assert(m_initialized);
+	return m_occluderIndices;
 }
 
-void Mesh::draw(VkCommandBuffer commandBuffer)
+bool Mesh::isReady()
 {
 	assert(m_initialized);
-	vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(m_indices.size()), 1, 0, 0, 0);
+	return m_ready;
 }
\ No newline at end of file
@@ -3,8 +3,12 @@
 #include "graphics/vulkan/types.hpp"
 #include "graphics/vulkan/context/device.hpp"
 #include "graphics/vulkan/buffer.hpp"
+#include "graphics/vulkan/asset_loader.hpp"
+#include "graphics/vulkan/command_recorder.hpp"
+#include "assets/mesh_data.hpp"
 
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -12,20 +16,41 @@ class Mesh
 {
 public:
 	void init(const std::string& modelPath);
-	void bindBuffers(VkCommandBuffer commandBuffer);
-	void draw(VkCommandBuffer commandBuffer);
+	void bindBuffers(CommandRecorder& recorder);
+	void bindPositions(CommandRecorder& recorder);
+	void draw(CommandRecorder& recorder, uint32_t lod = 0);
+	void drawIndirect(CommandRecorder& recorder, VkBuffer buffer, VkDeviceSize offset);
+	const Bounds& getBounds();
+	const glm::mat4& getDequantization();
+	const std::vector<Submesh>& getSubmeshes();
+	const std::vector<MeshLod>& getLods();
+	const std::vector<glm::vec3>& getOccluderPositions();
+	const std::vector<uint32_t>& getOccluderIndices();
+	bool isReady();
+
+	// Occluders are rasterized on the cpu, so the first lod under this budget is kept in system memory
+	static constexpr uint32_t MAX_OCCLUDER_TRIANGLES = 512;
 
 private:
-	void loadModel(const std::string& modelPath);
-	void createVertexBuffer();
-	void createIndexBuffer();
+	AssetUpload loadModel(const std::string& modelPath);
+	static void extractOccluder(std::span<const char> positions, std::span<const char> indices, uint32_t indexSize,
+		const std::vector<MeshLod>& lods, std::vector<glm::vec3>& occluderPositions, std::vector<uint32_t>& occluderIndices);
+	std::unique_ptr<Buffer> createBuffer(VkCommandBuffer commandBuffer, Buffer& stagingBuffer, VkDeviceSize offset, VkDeviceSize size, VkBufferUsageFlags usage, const std::string& name);
 
 private:
 	bool m_initialized = false;
+	bool m_ready = false;
 	Device* m_device{};
-	std::vector<Vertex> m_vertices{};
-	std::vector<uint32_t> m_indices{};
-	std::unique_ptr<Buffer> m_vertexBuffer{};
+	uint32_t m_vertexCount{};
+	VkIndexType m_indexType = VK_INDEX_TYPE_UINT32;
+	glm::mat4 m_dequantization{ 1.0f };
+	Bounds m_bounds{};
+	std::vector<Submesh> m_submeshes{};
+	std::vector<MeshLod> m_lods{};
+	std::vector<glm::vec3> m_occluderPositions{};
+	std::vector<uint32_t> m_occluderIndices{};
+	std::unique_ptr<Buffer> m_positionBuffer{};
+	std::unique_ptr<Buffer> m_attributeBuffer{};
 	std::unique_ptr<Buffer> m_indexBuffer{};
 
 };
\ No newline at end of file
@@ -9,26 +9,72 @@ void Model::init(const std::string& modelPath, const std::string& texturePath)
 	assert(!m_initialized);
 	m_initialized = true;
 	m_device = &Locator::getDevice();
-	m_mesh.reset(new Mesh);
-	m_texture.reset(new ImageTexture);
-	m_mesh->init(modelPath);
-	m_texture->init(texturePath, Locator::getDescriptorPool().createSet(1));
+	m_mesh = Locator::getAssetManager().getMesh(modelPath);
+	m_texture = Locator::getAssetManager().getTexture(texturePath);
 }
 
-void Model::bindTexture(VkCommandBuffer commandBuffer, VkPipelineLayout layout, uint32_t  set)
+void Model::bindTexture(CommandRecorder& recorder, VkPipelineLayout layout, uint32_t  set)
 {
 	assert(m_initialized);
-	m_texture->bind(commandBuffer, layout, set);
+	m_texture->bind(recorder, layout, set);
 }
 
-void Model::bindMesh(VkCommandBuffer commandBuffer)
+void Model::bindMesh(CommandRecorder& recorder)
 {
 	assert(m_initialized);
-	m_mesh->bindBuffers(commandBuffer);
+	m_mesh->bindBuffers(recorder);
 }
 
-void Model::draw(VkCommandBuffer commandBuffer, VkPipelineLayout layout)
+void Model::bindPositions(CommandRecorder& recorder)
 {
 	assert(m_initialized);
-	m_mesh->draw(commandBuffer);
+	m_mesh->bindPositions(recorder);
+}
+
+void Model::draw(CommandRecorder& recorder, VkPipelineLayout layout, uint32_t lod)
+{
+	assert(m_initialized);
+	m_mesh->draw(recorder, lod);
+}
+
+void Model::drawIndirect(CommandRecorder& recorder, VkBuffer buffer, VkDeviceSize offset)
+{
+	assert(m_initialized);
+	m_mesh->drawIndirect(recorder, buffer, offset);
+}
+
+const glm::mat4& Model::getDequantization()
+{
+	assert(m_initialized);
+	return m_mesh->getDequantization();
+}
+
+const Bounds& Model::getBounds()
+{
+	assert(m_initialized);
+	return m_mesh->getBounds();
+}
+
+const std::vector<MeshLod>& Model::getLods()
+{
+	assert(m_initialized);
+	return m_mesh->getLods();
+}
+
+const std::vector<glm::vec3>& Model::getOccluderPositions()
+{
+	assert(m_initialized);
+	return m_mesh->getOccluderPositions();
+}
+
+const std::vector<uint32_t>& Model::getOccluderIndices()
+{
+	assert(m_initialized);
+	return m_mesh->getOccluderIndices();
+}
+
+ImageTexture& Model::getTexture()
+{
+	assert(m_initialized);
+	return *m_texture;
 }
\ No newline at end of file
@@ -1,25 +1,30 @@
 #pragma once
 
 #include "graphics/vulkan/types.hpp"
-#include "graphics/vulkan/image/image_texture.hpp"	
-#include "graphics/vulkan/mesh.hpp"
+#include "graphics/vulkan/asset_manager.hpp"
 #include "graphics/vulkan/uniform_buffer.hpp"
 
 #include <vulkan/vulkan.h>
 
 #include <memory>
 #include <string>
-
-using MeshPtr = std::shared_ptr<Mesh>;
-using TexturePtr = std::shared_ptr<ImageTexture>;
+#include <vector>
 
 class Model
 {
 public:
 	void init(const std::string& modelPath, const std::string& texturePath);
-	void bindTexture(VkCommandBuffer commandBuffer, VkPipelineLayout layout, uint32_t set);
-	void bindMesh(VkCommandBuffer commandBuffer);
-	void draw(VkCommandBuffer commandBuffer, VkPipelineLayout layout);
+	void bindTexture(CommandRecorder& recorder, VkPipelineLayout layout, uint32_t set);
+	void bindMesh(CommandRecorder& recorder);
+	void bindPositions(CommandRecorder& recorder);
+	void draw(CommandRecorder& recorder, VkPipelineLayout layout, uint32_t lod = 0);
+	void drawIndirect(CommandRecorder& recorder, VkBuffer buffer, VkDeviceSize offset);
+	const glm::mat4& getDequantization();
+	const Bounds& getBounds();
+	const std::vector<MeshLod>& getLods();
+	const std::vector<glm::vec3>& getOccluderPositions();
+	const std::vector<uint32_t>& getOccluderIndices();
+	ImageTexture& getTexture();
 
 private:
 	bool m_initialized = false;
@@ -1,6 +1,10 @@
 #include "graphics/vulkan/object.hpp"
 #include "graphics/vulkan/locator.hpp"
 
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
 void Object::init(Model& model)
 {
 	assert(!m_initialized);
@@ -15,40 +19,132 @@ void Object::init(Model& model)
 	material.shininess = 32.0f;
 }
 
-void Object::draw(VkCommandBuffer commandBuffer, VkPipelineLayout layout)
+void Object::draw(CommandRecorder& recorder, VkPipelineLayout layout, uint32_t lod)
+{
+	assert(m_initialized);
+	m_model->draw(recorder, layout, lod);
+}
+
+void Object::drawIndirect(CommandRecorder& recorder, VkBuffer buffer, VkDeviceSize offset)
+{
+	assert(m_initialized);
+	m_model->drawIndirect(recorder, buffer, offset);
+}
+
+// World space bounding sphere and the index range of the lod, empty while the mesh is still loading
+CullObject Object::getCullObject(uint32_t lod)
+{
+	assert(m_initialized);
+	auto& bounds = m_model->getBounds();
+	auto scale = std::max({ std::abs(m_scale.x), std::abs(m_scale.y), std::abs(m_scale.z) });
+	auto object = CullObject{};
+	object.center = glm::vec3{ getModelMatrix() * glm::vec4{ (bounds.min + bounds.max) * 0.5f, 1.0f } };
+	object.radius = glm::length(bounds.max - bounds.min) * 0.5f * scale;
+	if (auto& lods = m_model->getLods(); lod < lods.size())
+	{
+		object.indexCount = lods[lod].indexCount;
+		object.firstIndex = lods[lod].indexOffset;
+	}
+	return object;
+}
+
+// Axis aligned box around the transformed corners of the model bounds
+Bounds Object::getWorldBounds()
+{
+	assert(m_initialized);
+	auto& bounds = m_model->getBounds();
+	auto model = getModelMatrix();
+	auto world = Bounds{ glm::vec3{ FLT_MAX }, glm::vec3{ -FLT_MAX } };
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		auto corner = glm::vec3{ i & 1 ? bounds.max.x : bounds.min.x, i & 2 ? bounds.max.y : bounds.min.y, i & 4 ? bounds.max.z : bounds.min.z };
+		auto point = glm::vec3{ model * glm::vec4{ corner, 1.0f } };
+		world.min = glm::min(world.min, point);
+		world.max = glm::max(world.max, point);
+	}
+	return world;
+}
+
+// Picks the coarsest lod whose simplification error projects to at most maxPixelError pixels
+uint32_t Object::selectLod(const glm::mat4& view, const glm::mat4& proj, float viewportHeight, float maxPixelError)
 {
 	assert(m_initialized);
-	m_model->draw(commandBuffer, layout);
+	auto& lods = m_model->getLods();
+	auto pixelsPerUnit = getPixelsPerUnit(view, proj, viewportHeight);
+
+	auto lod = uint32_t{};
+	while (lod + 1 < lods.size() && lods[lod + 1].error * pixelsPerUnit <= maxPixelError)
+		lod++;
+	return lod;
 }
 
-void Object::bindMVP(VkCommandBuffer commandBuffer, VkPipelineLayout layout, const glm::mat4& view, const glm::mat4& proj)
+// Pixels covered by one model space unit at the point of the bounds nearest to the camera
+float Object::getPixelsPerUnit(const glm::mat4& view, const glm::mat4& proj, float viewportHeight)
+{
+	assert(m_initialized);
+	auto& bounds = m_model->getBounds();
+	auto scale = std::max({ std::abs(m_scale.x), std::abs(m_scale.y), std::abs(m_scale.z) });
+	auto center = glm::vec3{ view * getModelMatrix() * glm::vec4{ (bounds.min + bounds.max) * 0.5f, 1.0f } };
+	auto radius = glm::length(bounds.max - bounds.min) * 0.5f * scale;
+
+	// Orthographic projections have the same pixel size at any depth, perspective ones measure at the nearest point
+	auto pixelsPerUnit = std::abs(proj[1][1]) * viewportHeight * 0.5f;
+	if (proj[3][3] == 0.0f)
+		pixelsPerUnit /= std::max(-center.z - radius, 0.001f);
+	return pixelsPerUnit * scale;
+}
+
+// Pixels spanned by the largest extent of the bounds, textures are assumed to stretch once across it
+float Object::getScreenSize(const glm::mat4& view, const glm::mat4& proj, float viewportHeight)
+{
+	assert(m_initialized);
+	auto extent = m_model->getBounds().max - m_model->getBounds().min;
+	return std::max({ extent.x, extent.y, extent.z }) * getPixelsPerUnit(view, proj, viewportHeight);
+}
+
+// Once per frame, the previous model matrix for motion vectors advances with every call
+void Object::updateMVP(const glm::mat4& view, const glm::mat4& proj)
 {
 	assert(m_initialized);
 	auto mvp = MVP{};
-	mvp.model = getModelMatrix();
+	mvp.model = getVertexMatrix();
 	mvp.view = view;
 	mvp.proj = proj;
+	mvp.prevModel = m_hasPrevModel ? m_prevModel : mvp.model;
+	m_prevModel = mvp.model;
+	m_hasPrevModel = true;
 	m_mvpBuffer.write(mvp);
-	m_mvpBuffer.bind(commandBuffer, layout, 0);
 }
 
-void Object::bindTexture(VkCommandBuffer commandBuffer, VkPipelineLayout layout, uint32_t set)
+void Object::bindMVP(CommandRecorder& recorder, VkPipelineLayout layout)
 {
 	assert(m_initialized);
-	m_model->bindTexture(commandBuffer, layout, set);
+	m_mvpBuffer.bind(recorder, layout, 0);
 }
 
-void Object::bindMaterial(VkCommandBuffer commandBuffer, VkPipelineLayout layout, uint32_t set)
+void Object::bindTexture(CommandRecorder& recorder, VkPipelineLayout layout, uint32_t set)
+{
+	assert(m_initialized);
+	m_model->bindTexture(recorder, layout, set);
+}
+
+void Object::bindMaterial(CommandRecorder& recorder, VkPipelineLayout layout, uint32_t set)
 {
 	assert(m_initialized);
 	m_materialBuffer.write(material);
-	m_materialBuffer.bind(commandBuffer, layout, 2);
+	m_materialBuffer.bind(recorder, layout, 2);
+}
+
+void Object::bindMesh(CommandRecorder& recorder)
+{
+	assert(m_initialized);
+	m_model->bindMesh(recorder);
 }
 
-void Object::bindMesh(VkCommandBuffer commandBuffer)
+void Object::bindPositions(CommandRecorder& recorder)
 {
 	assert(m_initialized);
-	m_model->bindMesh(commandBuffer);
+	m_model->bindPositions(recorder);
 }
 
 void Object::setPosition(glm::vec3 position)
@@ -93,4 +189,10 @@ glm::mat4 Object::getModelMatrix()
 	model = glm::rotate(model, glm::radians(m_rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
 	model = glm::scale(model, m_scale);
 	return model;
+}
+
+glm::mat4 Object::getVertexMatrix()
+{
+	assert(m_initialized);
+	return getModelMatrix() * m_model->getDequantization();
 }
\ No newline at end of file
@@ -7,11 +7,19 @@ class Object
 public:
 	void init(Model& model);
 
-	void draw(VkCommandBuffer commandBuffer, VkPipelineLayout layout);
-	void bindMVP(VkCommandBuffer commandBuffer, VkPipelineLayout layout, const glm::mat4& view, const glm::mat4& proj);
-	void bindTexture(VkCommandBuffer commandBuffer, VkPipelineLayout layout, uint32_t set);
-	void bindMaterial(VkCommandBuffer commandBuffer, VkPipelineLayout layout, uint32_t set);
-	void bindMesh(VkCommandBuffer commandBuffer);
+	void draw(CommandRecorder& recorder, VkPipelineLayout layout, uint32_t lod = 0);
+	void drawIndirect(CommandRecorder& recorder, VkBuffer buffer, VkDeviceSize offset);
+	CullObject getCullObject(uint32_t lod);
+	Bounds getWorldBounds();
+	uint32_t selectLod(const glm::mat4& view, const glm::mat4& proj, float viewportHeight, float maxPixelError);
+	float getPixelsPerUnit(const glm::mat4& view, const glm::mat4& proj, float viewportHeight);
+	float getScreenSize(const glm::mat4& view, const glm::mat4& proj, float viewportHeight);
+	void updateMVP(const glm::mat4& view, const glm::mat4& proj);
+	void bindMVP(CommandRecorder& recorder, VkPipelineLayout layout);
+	void bindTexture(CommandRecorder& recorder, VkPipelineLayout layout, uint32_t set);
+	void bindMaterial(CommandRecorder& recorder, VkPipelineLayout layout, uint32_t set);
+	void bindMesh(CommandRecorder& recorder);
+	void bindPositions(CommandRecorder& recorder);
 
 	void setPosition(glm::vec3 position);
 	void setRotation(glm::vec3 rotation);
@@ -20,6 +28,7 @@ public:
 	glm::vec3 getRotation();
 	glm::vec3 getScale();
 	glm::mat4 getModelMatrix();
+	glm::mat4 getVertexMatrix();
 
 	Material material{};
 
@@ -31,4 +40,6 @@ private:
 	glm::vec3 m_position{};
 	glm::vec3 m_rotation{};
 	glm::vec3 m_scale{ 1.0f };
+	glm::mat4 m_prevModel{};
+	bool m_hasPrevModel = false;
 };
\ No newline at end of file
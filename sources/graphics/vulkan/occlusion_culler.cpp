@@ -0,0 +1,208 @@
+#include "graphics/vulkan/occlusion_culler.hpp"
+#include "graphics/vulkan/locator.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+OcclusionCuller::~OcclusionCuller()
+{
+	destroy();
+}
+
+void OcclusionCuller::destroy()
+{
+	if (m_initialized)
+	{
+		m_statsBuffer.destroy();
+		m_visibilityBuffer.destroy();
+		m_drawBuffer.destroy();
+		m_objectBuffer.destroy();
+		m_pyramid.destroy();
+		m_pipeline.destroy();
+		for (auto& set : m_descriptorSets)
+			set.reset();
+	}
+	m_initialized = false;
+}
+
+void OcclusionCuller::init(const std::string& name, uint32_t width, uint32_t height)
+{
+	assert(!m_initialized);
+	m_initialized = true;
+	m_device = &Locator::getDevice();
+	m_name = name;
+	auto& descriptorPool = Locator::getDescriptorPool();
+
+	auto pipelineInfo = ComputePipelineProps{};
+	pipelineInfo.computePath = "resources/shaders/culling/shader.comp.spv";
+	pipelineInfo.descriptorSetLayouts = { descriptorPool.getLayout(5) };
+	m_pipeline.init(pipelineInfo);
+
+	m_pyramid.init(name, width, height);
+	// Each phase gets its own parameters, both are written before either dispatch runs
+	for (uint32_t i = 0; i < m_descriptorSets.size(); i++)
+	{
+		m_descriptorSets[i] = descriptorPool.createSet(5);
+		m_params[i].init(m_descriptorSets[i], 0);
+	}
+	createBuffers();
+	writeDescriptorSets();
+	m_objectCount = 0;
+	m_stats = {};
+}
+
+void OcclusionCuller::resize(uint32_t width, uint32_t height)
+{
+	assert(m_initialized);
+	m_pyramid.resize(width, height);
+	writeDescriptorSets();
+}
+
+void OcclusionCuller::createBuffers()
+{
+	m_objectBuffer.init(MAX_OBJECTS * sizeof(CullObject), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		MemoryCategory::Buffer, m_name + " cull objects"
+	);
+	m_objectsMapped = static_cast<CullObject*>(m_objectBuffer.map());
+
+	m_drawBuffer.init(static_cast<VkDeviceSize>(CullPhase::Count) * MAX_OBJECTS * sizeof(VkDrawIndexedIndirectCommand),
+		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MemoryCategory::Buffer, m_name + " cull draws"
+	);
+
+	// Starts out visible, the first frame has no pyramid to test against anyway
+	m_visibilityBuffer.init(MAX_OBJECTS * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		MemoryCategory::Buffer, m_name + " cull visibility"
+	);
+	auto* visibility = static_cast<uint32_t*>(m_visibilityBuffer.map());
+	std::fill_n(visibility, MAX_OBJECTS, 1u);
+	m_visibilityBuffer.unmap();
+
+	m_statsBuffer.init(sizeof(CullStats), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		MemoryCategory::Buffer, m_name + " cull stats"
+	);
+	m_statsMapped = static_cast<CullStats*>(m_statsBuffer.map());
+	*m_statsMapped = {};
+}
+
+void OcclusionCuller::writeDescriptorSets()
+{
+	auto pyramidInfo = VkDescriptorImageInfo{};
+	pyramidInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+	pyramidInfo.imageView = m_pyramid.getImageView();
+	pyramidInfo.sampler = m_pyramid.getSampler();
+
+	auto buffers = std::array{ &m_objectBuffer, &m_drawBuffer, &m_visibilityBuffer, &m_statsBuffer };
+	auto bufferInfos = std::array<VkDescriptorBufferInfo, 4>{};
+	for (uint32_t i = 0; i < buffers.size(); i++)
+	{
+		bufferInfos[i].buffer = buffers[i]->getBuffer();
+		bufferInfos[i].offset = 0;
+		bufferInfos[i].range = VK_WHOLE_SIZE;
+	}
+
+	for (auto& descriptorSet : m_descriptorSets)
+	{
+		auto descriptorWrites = std::array<VkWriteDescriptorSet, 5>{};
+		for (uint32_t i = 0; i < descriptorWrites.size(); i++)
+		{
+			descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrites[i].dstSet = descriptorSet->getSet();
+			descriptorWrites[i].dstBinding = i + 1;
+			descriptorWrites[i].dstArrayElement = 0;
+			descriptorWrites[i].descriptorCount = 1;
+			if (i == 0)
+			{
+				descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+				descriptorWrites[i].pImageInfo = &pyramidInfo;
+			}
+			else
+			{
+				descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+				descriptorWrites[i].pBufferInfo = &bufferInfos[i - 1];
+			}
+		}
+		vkUpdateDescriptorSets(m_device->getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+	}
+}
+
+// Objects past MAX_OBJECTS are ignored
+void OcclusionCuller::setObject(uint32_t id, const CullObject& object)
+{
+	assert(m_initialized);
+	if (id < MAX_OBJECTS)
+		m_objectsMapped[id] = object;
+}
+
+// Called once per frame after the frame fence, which also makes last frame's counters readable
+void OcclusionCuller::update(const glm::mat4& viewProj, uint32_t objectCount, bool occlusion)
+{
+	assert(m_initialized);
+	m_stats = *m_statsMapped;
+	*m_statsMapped = {};
+	m_objectCount = std::min(objectCount, MAX_OBJECTS);
+	m_occlusion = occlusion;
+
+	auto extent = m_pyramid.getExtent();
+	for (uint32_t i = 0; i < m_params.size(); i++)
+	{
+		auto params = CullParams{};
+		params.viewProj = viewProj;
+		// The early phase can only test once a pyramid exists, the late one always follows a build
+		auto tested = occlusion && (i == static_cast<uint32_t>(CullPhase::Late) || m_pyramid.isValid());
+		params.pyramid = { static_cast<float>(extent.width), static_cast<float>(extent.height), static_cast<float>(m_pyramid.getLevelCount()), tested ? 1.0f : 0.0f };
+		params.objectCount = m_objectCount;
+		params.phase = i;
+		params.drawOffset = i * MAX_OBJECTS;
+		m_params[i].write(params);
+	}
+}
+
+// Outside of any render pass, the commands are ready for indirect draws afterwards
+void OcclusionCuller::cull(VkCommandBuffer commandBuffer, CullPhase phase)
+{
+	assert(m_initialized);
+	m_pipeline.bind(commandBuffer);
+	auto set = m_descriptorSets[static_cast<size_t>(phase)]->getSet();
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline.getLayout(), 0, 1, &set, 0, nullptr);
+	vkCmdDispatch(commandBuffer, (std::max(m_objectCount, 1u) + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+	// The late phase reads the early commands and the visibility, the counters are read back next frame
+	auto barrier = VkMemoryBarrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_HOST_READ_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_HOST_BIT,
+		0, 1, &barrier, 0, nullptr, 0, nullptr
+	);
+}
+
+void OcclusionCuller::buildPyramid(VkCommandBuffer commandBuffer, Texture& depth, VkExtent2D depthExtent)
+{
+	assert(m_initialized);
+	m_pyramid.build(commandBuffer, depth, depthExtent);
+}
+
+VkBuffer OcclusionCuller::getDrawBuffer()
+{
+	assert(m_initialized);
+	return m_drawBuffer.getBuffer();
+}
+
+VkDeviceSize OcclusionCuller::getDrawOffset(CullPhase phase, uint32_t id)
+{
+	assert(m_initialized);
+	return (static_cast<VkDeviceSize>(phase) * MAX_OBJECTS + id) * sizeof(VkDrawIndexedIndirectCommand);
+}
+
+// Counters of the previous frame
+const CullStats& OcclusionCuller::getStats()
+{
+	assert(m_initialized);
+	return m_stats;
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "graphics/vulkan/types.hpp"
+#include "graphics/vulkan/buffer.hpp"
+#include "graphics/vulkan/uniform_buffer.hpp"
+#include "graphics/vulkan/compute_pipeline.hpp"
+#include "graphics/vulkan/hiz_buffer.hpp"
+#include "graphics/vulkan/descriptor/descriptor_pool.hpp"
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+enum class CullPhase : uint32_t
+{
+	Early,
+	Late,
+	Count
+};
+
+// Decides on the gpu which objects of one view are drawn, through indirect draw commands. The early phase draws
+// what was visible last frame plus whatever passes the previous frame's pyramid; the late phase retests the rest
+// against a pyramid rebuilt from the early depth, so disoccluded objects show up in the same frame
+class OcclusionCuller
+{
+public:
+	static constexpr uint32_t MAX_OBJECTS = 1024;
+	static constexpr uint32_t WORKGROUP_SIZE = 64;
+
+	~OcclusionCuller();
+	void init(const std::string& name, uint32_t width, uint32_t height);
+	void destroy();
+	void resize(uint32_t width, uint32_t height);
+
+	void setObject(uint32_t id, const CullObject& object);
+	void update(const glm::mat4& viewProj, uint32_t objectCount, bool occlusion);
+	void cull(VkCommandBuffer commandBuffer, CullPhase phase);
+	void buildPyramid(VkCommandBuffer commandBuffer, Texture& depth, VkExtent2D depthExtent);
+	VkBuffer getDrawBuffer();
+	VkDeviceSize getDrawOffset(CullPhase phase, uint32_t id);
+	const CullStats& getStats();
+
+private:
+	void createBuffers();
+	void writeDescriptorSets();
+
+private:
+	bool m_initialized = false;
+	Device* m_device{};
+	std::string m_name{};
+	ComputePipeline m_pipeline{};
+	HiZBuffer m_pyramid{};
+	std::array<DescriptorSetPtr, static_cast<size_t>(CullPhase::Count)> m_descriptorSets{};
+	std::array<UniformBuffer<CullParams>, static_cast<size_t>(CullPhase::Count)> m_params{};
+	Buffer m_objectBuffer{};
+	CullObject* m_objectsMapped{};
+	Buffer m_drawBuffer{};
+	Buffer m_visibilityBuffer{};
+	Buffer m_statsBuffer{};
+	CullStats* m_statsMapped{};
+	CullStats m_stats{};
+	uint32_t m_objectCount{};
+	bool m_occlusion = false;
+};
\ No newline at end of file
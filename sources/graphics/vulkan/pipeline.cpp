@@ -17,8 +17,10 @@ void Pipeline::destroy()
 {
 	if (m_initialized)
 	{
-		vkDestroyPipeline(m_device->getDevice(), m_pipeline, nullptr);
-		vkDestroyPipelineLayout(m_device->getDevice(), m_layout, nullptr);
+		m_device->getDeletionQueue().push([device = m_device->getDevice(), pipeline = m_pipeline, layout = m_layout] {
+			vkDestroyPipeline(device, pipeline, nullptr);
+			vkDestroyPipelineLayout(device, layout, nullptr);
+		});
 	}
 	m_initialized = false;
 }
@@ -72,12 +74,12 @@ void Pipeline::createPipeline()
 	auto vertexInputInfo = VkPipelineVertexInputStateCreateInfo{};
 	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 
-	auto bindDesc = Vertex::getBindDesc();
-	auto attrDesc = Vertex::getAttrDesc();
+	auto bindDesc = Vertex::getBindDesc(m_props.positionOnly);
+	auto attrDesc = Vertex::getAttrDesc(m_props.positionOnly);
 	if (m_props.vertexInput)
 	{
-		vertexInputInfo.pVertexBindingDescriptions = &bindDesc;
-		vertexInputInfo.vertexBindingDescriptionCount = 1;
+		vertexInputInfo.pVertexBindingDescriptions = bindDesc.data();
+		vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindDesc.size());
 		vertexInputInfo.pVertexAttributeDescriptions = attrDesc.data();
 		vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attrDesc.size());
 	}
@@ -171,10 +173,10 @@ VkShaderModule Pipeline::createShaderModule(const std::vector<char>& code)
 	return shaderModule;
 }
 
-void Pipeline::bind(VkCommandBuffer commandBuffer)
+void Pipeline::bind(CommandRecorder& recorder)
 {
 	assert(m_initialized);
-	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline);
+	recorder.bindPipeline(m_pipeline);
 }
 
 VkPipelineLayout Pipeline::getLayout()
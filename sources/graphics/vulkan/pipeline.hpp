@@ -17,6 +17,7 @@ struct PipelineProps
 	std::string fragmentPath;
 	std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
 	bool vertexInput;
+	bool positionOnly = false;
 	bool depthWrite = true;
 	VkCullModeFlags culling;
 };
@@ -28,7 +29,7 @@ public:
 	void init(const PipelineProps& props, const FramebufferProps& framebufferProps, RenderPass& renderPass);
 	void destroy();
 
-	void bind(VkCommandBuffer commandBuffer);
+	void bind(CommandRecorder& recorder);
 	VkPipelineLayout getLayout();
 	
 protected:
@@ -0,0 +1,99 @@
+#include "graphics/vulkan/pipeline_statistics.hpp"
+#include "graphics/vulkan/locator.hpp"
+
+#include <stdexcept>
+#include <cassert>
+
+// Results come back in bit order of the requested statistics, which matches PipelineCounters
+static constexpr VkQueryPipelineStatisticFlags STATISTICS =
+	VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+	VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT;
+
+PipelineStatistics::~PipelineStatistics()
+{
+	destroy();
+}
+
+void PipelineStatistics::destroy()
+{
+	if (m_initialized)
+	{
+		if (m_supported) vkDestroyQueryPool(m_device->getDevice(), m_queryPool, nullptr);
+	}
+	m_initialized = false;
+}
+
+void PipelineStatistics::init(uint32_t scopeCount)
+{
+	assert(!m_initialized);
+	m_initialized = true;
+	m_device = &Locator::getDevice();
+	m_scopeCount = scopeCount;
+	m_counters.resize(scopeCount);
+	createQueryPool();
+}
+
+void PipelineStatistics::createQueryPool()
+{
+	auto gpuFeatures = VkPhysicalDeviceFeatures{};
+	vkGetPhysicalDeviceFeatures(m_device->getGpu(), &gpuFeatures);
+	m_supported = gpuFeatures.pipelineStatisticsQuery;
+	if (!m_supported) return;
+
+	auto createInfo = VkQueryPoolCreateInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	createInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+	createInfo.queryCount = m_scopeCount;
+	createInfo.pipelineStatistics = STATISTICS;
+	if (vkCreateQueryPool(m_device->getDevice(), &createInfo, nullptr, &m_queryPool) != VK_SUCCESS)
+		throw std::runtime_error{ "failed to create pipeline statistics query pool" };
+}
+
+void PipelineStatistics::reset(VkCommandBuffer commandBuffer)
+{
+	assert(m_initialized);
+	if (!m_supported) return;
+	vkCmdResetQueryPool(commandBuffer, m_queryPool, 0, m_scopeCount);
+	m_pending = true;
+}
+
+void PipelineStatistics::begin(VkCommandBuffer commandBuffer, uint32_t scope)
+{
+	assert(m_initialized);
+	assert(scope < m_scopeCount);
+	if (!m_supported) return;
+	vkCmdBeginQuery(commandBuffer, m_queryPool, scope, 0);
+}
+
+void PipelineStatistics::end(VkCommandBuffer commandBuffer, uint32_t scope)
+{
+	assert(m_initialized);
+	assert(scope < m_scopeCount);
+	if (!m_supported) return;
+	vkCmdEndQuery(commandBuffer, m_queryPool, scope);
+}
+
+bool PipelineStatistics::fetch()
+{
+	assert(m_initialized);
+	if (!m_supported || !m_pending) return false;
+
+	auto result = vkGetQueryPoolResults(m_device->getDevice(), m_queryPool, 0, m_scopeCount,
+		m_counters.size() * sizeof(PipelineCounters), m_counters.data(), sizeof(PipelineCounters), VK_QUERY_RESULT_64_BIT);
+	if (result != VK_SUCCESS) return false;
+	m_pending = false;
+	return true;
+}
+
+const PipelineCounters& PipelineStatistics::getCounters(uint32_t scope)
+{
+	assert(m_initialized);
+	assert(scope < m_scopeCount);
+	return m_counters[scope];
+}
+
+bool PipelineStatistics::isSupported()
+{
+	assert(m_initialized);
+	return m_supported;
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "graphics/vulkan/context/device.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+struct PipelineCounters
+{
+	uint64_t inputPrimitives;
+	uint64_t vertexInvocations;
+};
+
+// Counts what the GPU actually did per scope, vertex invocations show how well the post transform cache is used
+class PipelineStatistics
+{
+public:
+	~PipelineStatistics();
+	void init(uint32_t scopeCount);
+	void destroy();
+
+	void reset(VkCommandBuffer commandBuffer);
+	void begin(VkCommandBuffer commandBuffer, uint32_t scope);
+	void end(VkCommandBuffer commandBuffer, uint32_t scope);
+	bool fetch();
+
+	const PipelineCounters& getCounters(uint32_t scope);
+	bool isSupported();
+
+private:
+	void createQueryPool();
+
+private:
+	bool m_initialized = false;
+	Device* m_device{};
+	VkQueryPool m_queryPool{};
+	uint32_t m_scopeCount{};
+	bool m_supported = false;
+	bool m_pending = false;
+	std::vector<PipelineCounters> m_counters{};
+};
\ No newline at end of file
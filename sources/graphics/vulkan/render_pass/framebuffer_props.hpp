@@ -3,6 +3,8 @@
 #include <vulkan/vulkan.h>
 
 #include <cstdint>
+#include <string>
+#include <vector>
 
 struct FramebufferProps
 {
@@ -10,5 +12,13 @@ struct FramebufferProps
 	bool useDepthAttachment;
 	VkFormat colorFormat;
 	VkFormat depthFormat;
+	std::vector<VkFormat> colorFormats{};
+	std::string name = "framebuffer"; // prefix of the attachment debug names
+	bool loadAttachments = false; // continues a pass that already rendered into the framebuffer this frame
 	//bool storeDepthAttachment;
+
+	VkFormat getColorFormat(uint32_t id) const
+	{
+		return id < colorFormats.size() ? colorFormats[id] : colorFormat;
+	}
 };
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include "graphics/vulkan/render_pass/render_pass.hpp"
 
 #include <stdexcept>
+#include <algorithm>
+#include <string>
 
 OffscreenFramebuffer::~OffscreenFramebuffer()
 {
@@ -18,7 +20,9 @@ void OffscreenFramebuffer::destroy()
 			colorAttachment.destroy();
 		}
 		m_depthAttachment.destroy();
-		vkDestroyFramebuffer(m_device->getDevice(), m_framebuffer, nullptr);
+		m_device->getDeletionQueue().push([device = m_device->getDevice(), framebuffer = m_framebuffer] {
+			vkDestroyFramebuffer(device, framebuffer, nullptr);
+		});
 	}
 	m_initialized = false;
 }
@@ -31,32 +35,55 @@ void OffscreenFramebuffer::init(const FramebufferProps& props, RenderPass& rende
 	m_props = props;
 	m_width = width;
 	m_height = height;
+	m_renderWidth = width;
+	m_renderHeight = height;
 	m_renderPass = &renderPass;
 	createTextures();
 	createFramebuffer();
 }
 
+// Attachments keep their descriptor sets and only swap the images behind them
 void OffscreenFramebuffer::resize(uint32_t newWidth, uint32_t newHeight)
 {
-	destroy();
-	init(m_props, *m_renderPass, newWidth, newHeight);
+	assert(m_initialized);
+	m_width = newWidth;
+	m_height = newHeight;
+	m_renderWidth = newWidth;
+	m_renderHeight = newHeight;
+	for (auto& colorAttachment : m_colorAttachments)
+		colorAttachment.resize(m_width, m_height);
+	if (m_props.useDepthAttachment)
+		m_depthAttachment.resize(m_width, m_height);
+
+	auto device = m_device->getDevice();
+	m_device->getDeletionQueue().push([device, framebuffer = m_framebuffer] {
+		vkDestroyFramebuffer(device, framebuffer, nullptr);
+	});
+	createFramebuffer();
+}
+
+void OffscreenFramebuffer::setRenderExtent(uint32_t width, uint32_t height)
+{
+	assert(m_initialized);
+	m_renderWidth = std::min(width, m_width);
+	m_renderHeight = std::min(height, m_height);
 }
 
 void OffscreenFramebuffer::createTextures()
 {
 	m_colorAttachments.resize(m_props.colorAttachmentCount);
-	for (auto& colorAttachment : m_colorAttachments)
+	for (uint32_t i = 0; i < m_props.colorAttachmentCount; i++)
 	{
-		colorAttachment.init(
-			AttachmentType::Color, m_width, m_height, m_props.colorFormat,
-			Locator::getDescriptorPool().createSet(1)
+		m_colorAttachments[i].init(
+			AttachmentType::Color, m_width, m_height, m_props.getColorFormat(i),
+			m_props.name + " color " + std::to_string(i), Locator::getDescriptorPool().createSet(1)
 		);
 	}
 	if (m_props.useDepthAttachment)
 	{
 		m_depthAttachment.init(
 			AttachmentType::Depth, m_width, m_height, m_props.depthFormat,
-			Locator::getDescriptorPool().createSet(1)
+			m_props.name + " depth", Locator::getDescriptorPool().createSet(1)
 		);
 	}
 }
@@ -65,7 +92,7 @@ void OffscreenFramebuffer::createFramebuffer()
 {
 	auto imageViews = std::vector<VkImageView>();
 	imageViews.reserve(m_colorAttachments.size()
-		+ m_props.useDepthAttachment ? 1 : 0
+		+ (m_props.useDepthAttachment ? 1 : 0)
 	);
 	for (auto& colorImage : m_colorAttachments)
 	{
@@ -105,6 +132,11 @@ Texture& OffscreenFramebuffer::getDepthTexture()
 }
 
 VkExtent2D OffscreenFramebuffer::getExtent()
+{
+	return { m_renderWidth, m_renderHeight };
+}
+
+VkExtent2D OffscreenFramebuffer::getMaxExtent()
 {
 	return { m_width, m_height };
 }
\ No newline at end of file
@@ -9,11 +9,13 @@ public:
 	void init(const FramebufferProps& props, RenderPass& renderPass, uint32_t width, uint32_t height);
 	void destroy();
 	void resize(uint32_t newWidth, uint32_t newHeight);
+	void setRenderExtent(uint32_t width, uint32_t height);
 
 	VkFramebuffer getFramebuffer() override;
 	Texture& getColorTexture(uint32_t id);
 	Texture& getDepthTexture();
 	VkExtent2D getExtent() override;
+	VkExtent2D getMaxExtent();
 
 private:
 	void createTextures();
@@ -26,6 +28,8 @@ private:
 	FramebufferProps m_props{};
 	uint32_t m_width{};
 	uint32_t m_height{};
+	uint32_t m_renderWidth{};
+	uint32_t m_renderHeight{};
 
 	VkFramebuffer m_framebuffer{};
 	std::vector<RenderTexture> m_colorAttachments;
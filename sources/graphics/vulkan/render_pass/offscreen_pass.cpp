@@ -1,5 +1,4 @@
 #include "graphics/vulkan/render_pass/offscreen_pass.hpp"
-#include "graphics/vulkan/context/swapchain.hpp"
 #include "graphics/vulkan/locator.hpp"
 
 #include <stdexcept>
@@ -13,7 +12,9 @@ void OffscreenPass::destroy()
 {
 	if (m_initialized)
 	{
-		vkDestroyRenderPass(m_device->getDevice(), m_renderPass, nullptr);
+		m_device->getDeletionQueue().push([device = m_device->getDevice(), renderPass = m_renderPass] {
+			vkDestroyRenderPass(device, renderPass, nullptr);
+		});
 	}
 	m_initialized = false;
 }
@@ -29,8 +30,6 @@ void OffscreenPass::init(const FramebufferProps& framebufferProps)
 
 void OffscreenPass::createRenderPass()
 {
-	auto details = m_device->querySwapchainSupport(m_device->getGpu());
-	auto format = Swapchain::chooseSwapchainSurfaceFormat(details.formats).format;
 	auto attachmentsCount = m_framebufferProps.colorAttachmentCount + static_cast<int>(m_framebufferProps.useDepthAttachment);
 
 	auto attachments = std::vector<VkAttachmentDescription>{};
@@ -41,13 +40,13 @@ void OffscreenPass::createRenderPass()
 	for (size_t i = 0; i < m_framebufferProps.colorAttachmentCount; i++)
 	{
 		auto colorAttachment = VkAttachmentDescription{};
-		colorAttachment.format = format;
+		colorAttachment.format = m_framebufferProps.getColorFormat(static_cast<uint32_t>(i));
 		colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-		colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		colorAttachment.loadOp = m_framebufferProps.loadAttachments ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
 		colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
 		colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 		colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		colorAttachment.initialLayout = m_framebufferProps.loadAttachments ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
 		colorAttachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 		attachments.push_back(colorAttachment);
 
@@ -60,13 +59,14 @@ void OffscreenPass::createRenderPass()
 	auto depthAttachment = VkAttachmentDescription{};
 	depthAttachment.format = m_framebufferProps.depthFormat;
 	depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-	depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-	depthAttachment.storeOp = m_framebufferProps.useDepthAttachment ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	depthAttachment.loadOp = m_framebufferProps.loadAttachments ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
+	depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
 	depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 	depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-	depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	depthAttachment.initialLayout = m_framebufferProps.loadAttachments ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
 	depthAttachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-	attachments.push_back(depthAttachment);
+	if (m_framebufferProps.useDepthAttachment)
+		attachments.push_back(depthAttachment);
 
 	auto depthAttachmentRef = VkAttachmentReference{};
 	depthAttachmentRef.attachment = m_framebufferProps.colorAttachmentCount;
@@ -75,15 +75,16 @@ void OffscreenPass::createRenderPass()
 	auto subpass = VkSubpassDescription{};
 	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
 	subpass.pColorAttachments = attachmentRefs.data();
-	subpass.pDepthStencilAttachment = &depthAttachmentRef;
+	subpass.pDepthStencilAttachment = m_framebufferProps.useDepthAttachment ? &depthAttachmentRef : nullptr;
 	subpass.colorAttachmentCount = attachmentRefs.size();
 
 	std::array<VkSubpassDependency, 2> dependencies{};
 	dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
 	dependencies[0].srcAccessMask = 0;
-	dependencies[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	// Depth pyramids are built from the attachments in compute between passes
+	dependencies[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
 	dependencies[0].dstSubpass = 0;
-	dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
 	dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
 	
 	dependencies[1].srcSubpass = 0;
@@ -91,7 +92,7 @@ void OffscreenPass::createRenderPass()
 	dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
 	dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
 	dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-	dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
 
 	auto createInfo = VkRenderPassCreateInfo{};
 	createInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
@@ -111,7 +112,8 @@ void OffscreenPass::begin(VkCommandBuffer commandBuffer, Framebuffer& framebuffe
 	auto attachmentsCount = m_framebufferProps.colorAttachmentCount + static_cast<int>(m_framebufferProps.useDepthAttachment);
 	auto clearValues = std::vector<VkClearValue>(attachmentsCount,
 			VkClearValue{.color = {{0.0f, 0.0f, 0.0f, 1.0f}}});
-	clearValues.back() = VkClearValue{ .depthStencil = {1.0f, 0} };
+	if (m_framebufferProps.useDepthAttachment)
+		clearValues.back() = VkClearValue{ .depthStencil = {1.0f, 0} };
 
 	auto renderPassInfo = VkRenderPassBeginInfo{};
 	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -15,7 +15,9 @@ void SwapchainFramebuffer::destroy()
 	{
 		m_colorAttachment.destroy();
 		m_depthAttachment.destroy();
-		vkDestroyFramebuffer(m_device->getDevice(), m_framebuffer, nullptr);
+		m_device->getDeletionQueue().push([device = m_device->getDevice(), framebuffer = m_framebuffer] {
+			vkDestroyFramebuffer(device, framebuffer, nullptr);
+		});
 	}
 	m_initialized = false;
 }
@@ -40,7 +42,7 @@ void SwapchainFramebuffer::createTextures(VkImage swapchainImage)
 	{
 		m_depthAttachment.init(
 			AttachmentType::Depth, m_width, m_height, m_props.depthFormat,
-			Locator::getDescriptorPool().createSet(1)
+			m_props.name + " depth", Locator::getDescriptorPool().createSet(1)
 		);
 	}
 }
@@ -48,7 +50,7 @@ void SwapchainFramebuffer::createTextures(VkImage swapchainImage)
 void SwapchainFramebuffer::createFramebuffer()
 {
 	auto imageViews = std::vector<VkImageView>();
-	imageViews.reserve(1 + m_props.useDepthAttachment ? 1 : 0);
+	imageViews.reserve(1 + (m_props.useDepthAttachment ? 1 : 0));
 	imageViews.push_back(m_colorAttachment.getImageView());
 	if (m_props.useDepthAttachment)
 		imageViews.push_back(m_depthAttachment.getImageView());
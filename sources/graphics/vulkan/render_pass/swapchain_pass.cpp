@@ -12,7 +12,9 @@ void SwapchainPass::destroy()
 {
 	if (m_initialized)
 	{
-		vkDestroyRenderPass(m_device->getDevice(), m_renderPass, nullptr);
+		m_device->getDeletionQueue().push([device = m_device->getDevice(), renderPass = m_renderPass] {
+			vkDestroyRenderPass(device, renderPass, nullptr);
+		});
 	}
 	m_initialized = false;
 }
@@ -43,39 +45,24 @@ void SwapchainPass::createRenderPass()
 	colorAttachmentRef.attachment = 0;
 	colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
-	auto depthAttachment = VkAttachmentDescription{};
-	depthAttachment.format = m_device->findDepthFormat();
-	depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-	depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-	depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-	depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-	depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-	depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-	auto depthAttachmentRef = VkAttachmentReference{};
-	depthAttachmentRef.attachment = 1;
-	depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
+	// The combine pass and the ui only draw full screen and 2d geometry, neither needs depth
 	auto subpass = VkSubpassDescription{};
 	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
 	subpass.pColorAttachments = &colorAttachmentRef;
-	subpass.pDepthStencilAttachment = &depthAttachmentRef;
 	subpass.colorAttachmentCount = 1;
 
 	auto dependency = VkSubpassDependency{};
 	dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
 	dependency.dstSubpass = 0;
-	dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+	dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 	dependency.srcAccessMask = 0;
-	dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-	dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
 
-	auto attachments = { colorAttachment, depthAttachment };
 	auto createInfo = VkRenderPassCreateInfo{};
 	createInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-	createInfo.pAttachments = attachments.begin();
-	createInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+	createInfo.pAttachments = &colorAttachment;
+	createInfo.attachmentCount = 1;
 	createInfo.pSubpasses = &subpass;
 	createInfo.subpassCount = 1;
 	createInfo.pDependencies = &dependency;
@@ -88,9 +75,8 @@ void SwapchainPass::createRenderPass()
 void SwapchainPass::begin(VkCommandBuffer commandBuffer, Framebuffer& framebuffer)
 {
 	auto clearValues =
-		std::array<VkClearValue, 2>{
-			VkClearValue{.color = {{0.0f, 0.0f, 0.0f, 1.0f}}},
-			VkClearValue{.depthStencil = {1.0f, 0}}
+		std::array<VkClearValue, 1>{
+			VkClearValue{.color = {{0.0f, 0.0f, 0.0f, 1.0f}}}
 	};
 	auto renderPassInfo = VkRenderPassBeginInfo{};
 	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
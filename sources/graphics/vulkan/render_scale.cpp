@@ -0,0 +1,47 @@
+#include "graphics/vulkan/render_scale.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+void RenderScale::update(float gpuTime)
+{
+	if (gpuTime <= 0.0f) return;
+	m_filteredTime = m_filteredTime == 0.0f ? gpuTime : m_filteredTime + (gpuTime - m_filteredTime) * SMOOTHING;
+	if (!enabled)
+	{
+		m_scale = maxScale;
+		return;
+	}
+
+	// Pixel cost grows with the square of the scale, so correct along sqrt of the time ratio
+	auto ratio = std::sqrt(targetTime / m_filteredTime);
+	if (std::abs(ratio - 1.0f) < HYSTERESIS) return;
+
+	auto step = std::clamp(m_scale * ratio - m_scale, -MAX_STEP, MAX_STEP);
+	m_scale = std::clamp(m_scale + step, minScale, maxScale);
+}
+
+VkExtent2D RenderScale::apply(VkExtent2D extent)
+{
+	auto scale = enabled ? m_scale : maxScale;
+	return
+	{
+		std::max(1u, static_cast<uint32_t>(std::round(extent.width * scale))),
+		std::max(1u, static_cast<uint32_t>(std::round(extent.height * scale)))
+	};
+}
+
+float RenderScale::getScale()
+{
+	return enabled ? m_scale : maxScale;
+}
+
+float RenderScale::getFilteredTime()
+{
+	return m_filteredTime;
+}
+
+void RenderScale::setScale(float scale)
+{
+	m_scale = std::clamp(scale, minScale, maxScale);
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+class RenderScale
+{
+public:
+	void update(float gpuTime);
+	VkExtent2D apply(VkExtent2D extent);
+	float getScale();
+	float getFilteredTime();
+	void setScale(float scale);
+
+	bool enabled = true;
+	float targetTime = 16.0f;
+	float minScale = 0.5f;
+	float maxScale = 1.0f;
+
+private:
+	const float SMOOTHING = 0.1f;
+	const float HYSTERESIS = 0.05f;
+	const float MAX_STEP = 0.05f;
+
+	float m_scale = 1.0f;
+	float m_filteredTime{};
+};
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "graphics/vulkan/renderer.hpp"
 #include "graphics/vulkan/render_pass/framebuffer.hpp"
 #include "window/window.hpp"
+#include "core/profiler.hpp"
 
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -17,29 +18,53 @@
 #include <set>
 #include <array>
 #include <algorithm>
+#include <cmath>
 #include <limits>
 #include <cstdint>
 #include <unordered_map>
+#include <ranges>
+#include <chrono>
 
 const std::string MODEL_PATH = "resources/models/monkey.obj";
 const std::string TEXTURE_PATH = "resources/images/container2.png";
 
-#define TRACY_ENABLE
-#include <tracy/Tracy.hpp>
-
 Renderer::Renderer(Window& window) : m_window{window}
 {
+	// Constructed on the main thread, which makes it the thread main affinity jobs run on
+	m_jobSystem.init();
+	Locator::setJobSystem(&m_jobSystem);
+#ifdef VK_PROFILING
+	TracyPlotConfig("uploaded bytes", tracy::PlotFormatType::Memory, false, true, 0);
+	for (uint32_t i = 0; i < static_cast<uint32_t>(MemoryCategory::Count); i++)
+		TracyPlotConfig(MemoryTracker::getCategoryName(static_cast<MemoryCategory>(i)), tracy::PlotFormatType::Memory, false, true, 0);
+#endif
 	createContext();
 	createDevice();
 	createDescriptorPool();
+	m_assetLoader.init();
+	m_textureStreamer.init(static_cast<VkDeviceSize>(m_textureBudget * 1024 * 1024));
+	m_assetManager.init();
 	createSyncObjects();
 	createCommandBuffers();
+	m_gpuTimer.init(static_cast<uint32_t>(GpuScope::Count));
+	m_pipelineStatistics.init(static_cast<uint32_t>(StatisticsScope::Count));
+	m_recorder.init(static_cast<uint32_t>(GpuScope::Count));
 	createRenderPass();
 	createSwapchain();
 	createGraphicsPipeline();
+	m_framePacer.init(m_window.getWindow(), m_swapchain);
+	m_lightClusters.init();
+	{
+		auto maxExtent = m_renderFramebuffer.getMaxExtent();
+		m_sceneCuller.init("scene", maxExtent.width, maxExtent.height);
+		m_shadowCuller.init("shadow", 2048, 2048);
+	}
+	m_softwareOcclusion.init();
+	m_simulation.init();
+	m_simulation.setLocalLights(m_localLightCount, m_localLightRange, m_localLightIntensity);
 
-	m_specularMap.init("resources/images/container2_specular.png", m_descriptorPool.createSet(1));
-	m_planeSpecularMap.init("resources/images/brown_specular.png", m_descriptorPool.createSet(1));
+	m_specularMap = m_assetManager.getTexture("resources/images/container2_specular.png");
+	m_planeSpecularMap = m_assetManager.getTexture("resources/images/brown_specular.png");
 
 	m_skybox.init("resources/images/skybox", m_descriptorPool.createSet(1));
 
@@ -51,9 +76,6 @@ Renderer::Renderer(Window& window) : m_window{window}
 	m_skyboxCube.init(m_cube);
 	m_skyboxMvp.init(m_descriptorPool.createSet(0));
 
-	m_object.setPosition({ 0.f, 1.f, 0.f });
-	m_plane.setPosition({0.f, .0f, 0.f});
-
 	m_light.init(m_descriptorPool.createSet(0));
 	light.direction = { -0.2f, -1.0f, -0.3f };
 	light.ambient = { 0.2f, 0.2f, 0.2f };
@@ -67,6 +89,10 @@ Renderer::Renderer(Window& window) : m_window{window}
 	m_shadowMvp2.init(m_descriptorPool.createSet(0));
 	m_globalBuffer.init(m_descriptorPool.createSet(0));
 	m_lightSpace.init(m_descriptorPool.createSet(0));
+	m_temporalBuffer.init(m_descriptorPool.createSet(0));
+	m_temporalResolveBuffer.init(m_descriptorPool.createSet(0));
+	m_temporalResolve.blend = 0.1f;
+	m_deferredBuffer.init(m_descriptorPool.createSet(0));
 
 	ImGui::CreateContext();
 	ImGuiIO& io = ImGui::GetIO(); (void)io;
@@ -90,6 +116,10 @@ Renderer::Renderer(Window& window) : m_window{window}
 Renderer::~Renderer()
 {
 	vkDeviceWaitIdle(m_device.getDevice());
+	m_simulation.destroy();
+	m_softwareOcclusion.destroy();
+	m_assetLoader.destroy();
+	m_jobSystem.destroy();
 
 	ImGui_ImplVulkan_Shutdown();
 	ImGui_ImplGlfw_Shutdown();
@@ -132,7 +162,41 @@ void Renderer::createDescriptorPool()
 			{
 				.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
 			}
-		}, VK_SHADER_STAGE_ALL_GRAPHICS, 100 }
+		}, VK_SHADER_STAGE_ALL_GRAPHICS, 100 },
+		// Material textures all sample the same way, so their sampler is part of the layout
+		DescriptorSetInfo
+		{{
+			BindingInfo
+			{
+				.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+				.immutableSampler = m_device.getSamplerCache().get(SamplerCache::getDefaultInfo()),
+			}
+		}, VK_SHADER_STAGE_ALL_GRAPHICS, 100 },
+		// Light clusters: parameters, lights, per cluster counts and index lists
+		DescriptorSetInfo
+		{{
+			BindingInfo{ .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+			BindingInfo{ .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+			BindingInfo{ .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+			BindingInfo{ .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+		}, VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 4 },
+		// Depth pyramid level: sizes, the level or depth read and the level written
+		DescriptorSetInfo
+		{{
+			BindingInfo{ .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+			BindingInfo{ .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+			BindingInfo{ .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE },
+		}, VK_SHADER_STAGE_COMPUTE_BIT, 2 * HiZBuffer::MAX_LEVELS },
+		// Occlusion culling phase: parameters, pyramid, objects, draw commands, visibility and counters
+		DescriptorSetInfo
+		{{
+			BindingInfo{ .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+			BindingInfo{ .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+			BindingInfo{ .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+			BindingInfo{ .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+			BindingInfo{ .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+			BindingInfo{ .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+		}, VK_SHADER_STAGE_COMPUTE_BIT, 2 * static_cast<uint32_t>(CullPhase::Count) }
 	};
 	m_descriptorPool.init(props);
 }
@@ -141,21 +205,67 @@ void Renderer::createRenderPass()
 {
 	m_swapchainPass.init();
 
-	m_renderFramebufferProps.colorAttachmentCount = 1;
+	m_swapchainFramebufferProps.colorAttachmentCount = 1;
+	m_swapchainFramebufferProps.useDepthAttachment = false;
+	m_swapchainFramebufferProps.colorFormat = VK_FORMAT_B8G8R8A8_UNORM;
+	m_swapchainFramebufferProps.depthFormat = VK_FORMAT_D32_SFLOAT;
+	m_swapchainFramebufferProps.name = "swapchain";
+
+	m_renderFramebufferProps.colorAttachmentCount = 2;
 	m_renderFramebufferProps.useDepthAttachment = true;
 	m_renderFramebufferProps.colorFormat = VK_FORMAT_B8G8R8A8_UNORM;
+	m_renderFramebufferProps.colorFormats = { VK_FORMAT_B8G8R8A8_UNORM, VK_FORMAT_R16G16_SFLOAT };
 	m_renderFramebufferProps.depthFormat = VK_FORMAT_D32_SFLOAT;
+	m_renderFramebufferProps.name = "scene";
 
+	auto maxExtent = getMaxRenderExtent();
 	m_renderPass.init(m_renderFramebufferProps);
-	m_renderFramebuffer.init(m_renderFramebufferProps, m_renderPass, 1280, 720);
+	m_renderFramebuffer.init(m_renderFramebufferProps, m_renderPass, maxExtent.width, maxExtent.height);
+	{
+		auto resumeProps = m_renderFramebufferProps;
+		resumeProps.loadAttachments = true;
+		m_renderResumePass.init(resumeProps);
+	}
+
+	// Compact g-buffer: albedo with specular intensity, octahedral normal with shininess, motion
+	m_gbufferFramebufferProps.colorAttachmentCount = 3;
+	m_gbufferFramebufferProps.useDepthAttachment = true;
+	m_gbufferFramebufferProps.colorFormat = VK_FORMAT_R8G8B8A8_UNORM;
+	m_gbufferFramebufferProps.colorFormats = { VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_A2B10G10R10_UNORM_PACK32, VK_FORMAT_R16G16_SFLOAT };
+	m_gbufferFramebufferProps.depthFormat = VK_FORMAT_D32_SFLOAT;
+	m_gbufferFramebufferProps.name = "gbuffer";
+
+	m_gbufferPass.init(m_gbufferFramebufferProps);
+	m_gbufferFramebuffer.init(m_gbufferFramebufferProps, m_gbufferPass, maxExtent.width, maxExtent.height);
+	{
+		auto resumeProps = m_gbufferFramebufferProps;
+		resumeProps.loadAttachments = true;
+		m_gbufferResumePass.init(resumeProps);
+	}
 
 	m_shadowFramebufferProps.colorAttachmentCount = 0;
 	m_shadowFramebufferProps.useDepthAttachment = true;
 	m_shadowFramebufferProps.colorFormat = VK_FORMAT_B8G8R8A8_UNORM;
 	m_shadowFramebufferProps.depthFormat = VK_FORMAT_D32_SFLOAT;
+	m_shadowFramebufferProps.name = "shadow";
 
 	m_shadowPass.init(m_shadowFramebufferProps);
 	m_shadowFramebuffer.init(m_shadowFramebufferProps, m_shadowPass, 2048, 2048);
+	{
+		auto resumeProps = m_shadowFramebufferProps;
+		resumeProps.loadAttachments = true;
+		m_shadowResumePass.init(resumeProps);
+	}
+
+	m_historyFramebufferProps.colorAttachmentCount = 1;
+	m_historyFramebufferProps.useDepthAttachment = false;
+	m_historyFramebufferProps.colorFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+	m_historyFramebufferProps.depthFormat = VK_FORMAT_D32_SFLOAT;
+	m_historyFramebufferProps.name = "history";
+
+	m_taaPass.init(m_historyFramebufferProps);
+	for (auto& framebuffer : m_historyFramebuffers)
+		framebuffer.init(m_historyFramebufferProps, m_taaPass, maxExtent.width, maxExtent.height);
 }
 
 void Renderer::createSwapchain()
@@ -163,10 +273,19 @@ void Renderer::createSwapchain()
 	int width, height;
 	glfwGetFramebufferSize(m_window.getWindow(), &width, &height);
 	auto extent = VkExtent2D{ static_cast<uint32_t>(width), static_cast<uint32_t>(height) };
-	m_swapchain.init(m_renderFramebufferProps, m_swapchainPass, [&](uint32_t width, uint32_t height)
+	m_swapchain.init(m_swapchainFramebufferProps, m_swapchainPass, [&](uint32_t width, uint32_t height)
 	{
-			m_renderFramebuffer.resize(width, height);
+		// Scene targets are allocated at the max size once, only grow them when the window outgrows it
+		auto maxExtent = m_renderFramebuffer.getMaxExtent();
+		if (width > maxExtent.width || height > maxExtent.height)
+		{
+			m_renderFramebuffer.resize(std::max(width, maxExtent.width), std::max(height, maxExtent.height));
+			m_gbufferFramebuffer.resize(std::max(width, maxExtent.width), std::max(height, maxExtent.height));
+			m_sceneCuller.resize(std::max(width, maxExtent.width), std::max(height, maxExtent.height));
+		}
+		resizeHistory(width, height);
 	});
+	resizeHistory(extent.width, extent.height);
 }
 
 void Renderer::createGraphicsPipeline()
@@ -177,6 +296,7 @@ void Renderer::createGraphicsPipeline()
 		pipelineInfo.fragmentPath = "resources/shaders/shadow/shader.frag.spv";
 		pipelineInfo.descriptorSetLayouts = { m_descriptorPool.getLayout(0) };
 		pipelineInfo.vertexInput = true;
+		pipelineInfo.positionOnly = true;
 		pipelineInfo.culling = VK_CULL_MODE_BACK_BIT;
 		m_shadowPipeline.init(pipelineInfo, m_shadowFramebufferProps, m_shadowPass);
 	}
@@ -184,7 +304,7 @@ void Renderer::createGraphicsPipeline()
 		auto pipelineInfo = PipelineProps{};
 		pipelineInfo.vertexPath = "resources/shaders/main/shader.vert.spv";
 		pipelineInfo.fragmentPath = "resources/shaders/main/shader.frag.spv";
-		pipelineInfo.descriptorSetLayouts = { m_descriptorPool.getLayout(0), m_descriptorPool.getLayout(0), m_descriptorPool.getLayout(0), m_descriptorPool.getLayout(1), m_descriptorPool.getLayout(1), m_descriptorPool.getLayout(1), m_descriptorPool.getLayout(0), m_descriptorPool.getLayout(1) };
+		pipelineInfo.descriptorSetLayouts = { m_descriptorPool.getLayout(0), m_descriptorPool.getLayout(0), m_descriptorPool.getLayout(0), m_descriptorPool.getLayout(2), m_descriptorPool.getLayout(2), m_descriptorPool.getLayout(1), m_descriptorPool.getLayout(0), m_descriptorPool.getLayout(1), m_descriptorPool.getLayout(0), m_descriptorPool.getLayout(3) };
 		pipelineInfo.vertexInput = true;
 		pipelineInfo.culling = VK_CULL_MODE_BACK_BIT;
 		m_renderPipeline.init(pipelineInfo, m_renderFramebufferProps, m_renderPass);
@@ -193,7 +313,7 @@ void Renderer::createGraphicsPipeline()
 		auto pipelineInfo = PipelineProps{};
 		pipelineInfo.vertexPath = "resources/shaders/skybox/shader.vert.spv";
 		pipelineInfo.fragmentPath = "resources/shaders/skybox/shader.frag.spv";
-		pipelineInfo.descriptorSetLayouts = { m_descriptorPool.getLayout(0), m_descriptorPool.getLayout(1) };
+		pipelineInfo.descriptorSetLayouts = { m_descriptorPool.getLayout(0), m_descriptorPool.getLayout(1), m_descriptorPool.getLayout(0) };
 		pipelineInfo.vertexInput = true;
 		pipelineInfo.depthWrite = false;
 		pipelineInfo.culling = VK_CULL_MODE_NONE;
@@ -206,7 +326,34 @@ void Renderer::createGraphicsPipeline()
 		pipelineInfo.descriptorSetLayouts = { m_descriptorPool.getLayout(1), m_descriptorPool.getLayout(0) };
 		pipelineInfo.vertexInput = false;
 		pipelineInfo.culling = VK_CULL_MODE_NONE;
-		m_combinePipeline.init(pipelineInfo, m_renderFramebufferProps, m_swapchainPass);
+		m_combinePipeline.init(pipelineInfo, m_swapchainFramebufferProps, m_swapchainPass);
+	}
+	{
+		auto pipelineInfo = PipelineProps{};
+		pipelineInfo.vertexPath = "resources/shaders/taa/shader.vert.spv";
+		pipelineInfo.fragmentPath = "resources/shaders/taa/shader.frag.spv";
+		pipelineInfo.descriptorSetLayouts = { m_descriptorPool.getLayout(1), m_descriptorPool.getLayout(1), m_descriptorPool.getLayout(1), m_descriptorPool.getLayout(1), m_descriptorPool.getLayout(0) };
+		pipelineInfo.vertexInput = false;
+		pipelineInfo.culling = VK_CULL_MODE_NONE;
+		m_taaPipeline.init(pipelineInfo, m_historyFramebufferProps, m_taaPass);
+	}
+	{
+		auto pipelineInfo = PipelineProps{};
+		pipelineInfo.vertexPath = "resources/shaders/main/shader.vert.spv";
+		pipelineInfo.fragmentPath = "resources/shaders/deferred/gbuffer.frag.spv";
+		pipelineInfo.descriptorSetLayouts = { m_descriptorPool.getLayout(0), m_descriptorPool.getLayout(0), m_descriptorPool.getLayout(0), m_descriptorPool.getLayout(2), m_descriptorPool.getLayout(2), m_descriptorPool.getLayout(1), m_descriptorPool.getLayout(0), m_descriptorPool.getLayout(1), m_descriptorPool.getLayout(0) };
+		pipelineInfo.vertexInput = true;
+		pipelineInfo.culling = VK_CULL_MODE_BACK_BIT;
+		m_gbufferPipeline.init(pipelineInfo, m_gbufferFramebufferProps, m_gbufferPass);
+	}
+	{
+		auto pipelineInfo = PipelineProps{};
+		pipelineInfo.vertexPath = "resources/shaders/deferred/lighting.vert.spv";
+		pipelineInfo.fragmentPath = "resources/shaders/deferred/lighting.frag.spv";
+		pipelineInfo.descriptorSetLayouts = { m_descriptorPool.getLayout(1), m_descriptorPool.getLayout(1), m_descriptorPool.getLayout(1), m_descriptorPool.getLayout(1), m_descriptorPool.getLayout(0), m_descriptorPool.getLayout(0), m_descriptorPool.getLayout(1), m_descriptorPool.getLayout(1), m_descriptorPool.getLayout(0), m_descriptorPool.getLayout(3) };
+		pipelineInfo.vertexInput = false;
+		pipelineInfo.culling = VK_CULL_MODE_NONE;
+		m_deferredLightingPipeline.init(pipelineInfo, m_renderFramebufferProps, m_renderPass);
 	}
 }
 
@@ -230,7 +377,7 @@ void Renderer::createCommandBuffers()
 	m_commandBuffer = m_device.createCommandBuffers(1).back();
 }
 
-void Renderer::setViewport(VkCommandBuffer commandBuffer)
+void Renderer::setViewport(CommandRecorder& recorder)
 {
 	auto viewport = VkViewport{};
 	viewport.x = 0.0f;
@@ -239,29 +386,120 @@ void Renderer::setViewport(VkCommandBuffer commandBuffer)
 	viewport.height = static_cast<float>(m_swapchain.getExtent().height);
 	viewport.minDepth = 0.0f;
 	viewport.maxDepth = 1.0f;
-	vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+	recorder.setViewport(viewport);
 
 	auto scissor = VkRect2D{};
 	scissor.offset = { 0, 0 };
 	scissor.extent = m_swapchain.getExtent();
-	vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+	recorder.setScissor(scissor);
 }
 
-void Renderer::setViewport(VkCommandBuffer commandBuffer, uint32_t width, uint32_t height)
+void Renderer::setViewport(CommandRecorder& recorder, uint32_t width, uint32_t height)
 {
 	auto viewport = VkViewport{};
 	viewport.x = 0.0f;
 	viewport.y = 0.0f;
 	viewport.width = static_cast<float>(width);
-	viewport.height = static_cast<float>(width);
+	viewport.height = static_cast<float>(height);
 	viewport.minDepth = 0.0f;
 	viewport.maxDepth = 1.0f;
-	vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+	recorder.setViewport(viewport);
 
 	auto scissor = VkRect2D{};
 	scissor.offset = { 0, 0 };
 	scissor.extent = { width, height };
-	vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+	recorder.setScissor(scissor);
+}
+
+VkExtent2D Renderer::getMaxRenderExtent()
+{
+	int width, height;
+	glfwGetFramebufferSize(m_window.getWindow(), &width, &height);
+	auto extent = VkExtent2D{ static_cast<uint32_t>(width), static_cast<uint32_t>(height) };
+	if (auto* mode = glfwGetVideoMode(glfwGetPrimaryMonitor()); mode != nullptr)
+	{
+		extent.width = std::max(extent.width, static_cast<uint32_t>(mode->width));
+		extent.height = std::max(extent.height, static_cast<uint32_t>(mode->height));
+	}
+	return extent;
+}
+
+void Renderer::updateRenderExtent()
+{
+	if (m_gpuTimer.fetch())
+		m_renderScale.update(m_gpuTimer.getTime(static_cast<uint32_t>(GpuScope::Frame)));
+	m_pipelineStatistics.fetch();
+
+	auto extent = m_renderScale.apply(m_swapchain.getExtent());
+	m_renderFramebuffer.setRenderExtent(extent.width, extent.height);
+	m_gbufferFramebuffer.setRenderExtent(extent.width, extent.height);
+
+	if (m_taaEnabled)
+		m_camera.jitter(extent.width, extent.height);
+	else
+		m_camera.resetJitter();
+}
+
+void Renderer::updateMemory()
+{
+	auto& memoryTracker = m_device.getMemoryTracker();
+	memoryTracker.update();
+#ifdef VK_PROFILING
+	for (uint32_t i = 0; i < static_cast<uint32_t>(MemoryCategory::Count); i++)
+	{
+		auto category = static_cast<MemoryCategory>(i);
+		TracyPlot(MemoryTracker::getCategoryName(category), static_cast<int64_t>(memoryTracker.getCategorySize(category)));
+	}
+#endif
+
+	// Textures may take the configured budget, but never more than the device local heaps still have room for
+	auto textureBudget = static_cast<VkDeviceSize>(m_textureBudget * 1024 * 1024);
+	auto available = m_textureStreamer.getStats().residentBytes + memoryTracker.getDeviceLocalHeadroom();
+	m_textureStreamer.setBudget(std::min(textureBudget, available));
+}
+
+// Counters of the last finished frame, the gpu side ones come from the queries fetched in updateRenderExtent.
+// Compiled out without profiling, nothing else reads them
+void Renderer::plotCounters()
+{
+#ifdef VK_PROFILING
+	auto uploaded = m_device.getMemoryTracker().getCategoryTotal(MemoryCategory::Staging);
+	TracyPlot("uploaded bytes", static_cast<int64_t>(uploaded - m_uploadedTotal));
+	m_uploadedTotal = uploaded;
+	TracyPlot("pending assets", static_cast<int64_t>(m_assetLoader.getPendingCount()));
+	TracyPlot("local lights", static_cast<int64_t>(m_lightClusters.getLightCount()));
+
+	for (auto [name, scope] : { std::pair{ "shadow draws", GpuScope::Shadow }, std::pair{ "scene draws", GpuScope::Scene } })
+		TracyPlot(name, static_cast<int64_t>(m_recorder.getStats(static_cast<uint32_t>(scope)).draws));
+	{
+		auto total = m_recorder.getTotal();
+		TracyPlot("draw calls", static_cast<int64_t>(total.draws));
+		TracyPlot("binds", static_cast<int64_t>(total.binds));
+		TracyPlot("skipped binds", static_cast<int64_t>(total.skipped));
+	}
+	if (m_softwareOcclusionEnabled)
+		TracyPlot("software culled", static_cast<int64_t>(m_softwareOcclusion.getStats().culled));
+	if (m_pipelineStatistics.isSupported())
+	{
+		auto triangles = m_pipelineStatistics.getCounters(static_cast<uint32_t>(StatisticsScope::Shadow)).inputPrimitives
+			+ m_pipelineStatistics.getCounters(static_cast<uint32_t>(StatisticsScope::Scene)).inputPrimitives;
+		TracyPlot("triangles", static_cast<int64_t>(triangles));
+	}
+	if (m_gpuTimer.isSupported())
+		TracyPlot("gpu frame ms", static_cast<double>(m_gpuTimer.getTime(static_cast<uint32_t>(GpuScope::Frame))));
+#endif
+}
+
+void Renderer::resizeHistory(uint32_t width, uint32_t height)
+{
+	for (auto& framebuffer : m_historyFramebuffers)
+	{
+		auto maxExtent = framebuffer.getMaxExtent();
+		if (width > maxExtent.width || height > maxExtent.height)
+			framebuffer.resize(std::max(width, maxExtent.width), std::max(height, maxExtent.height));
+		framebuffer.setRenderExtent(width, height);
+	}
+	m_historyValid = false;
 }
 
 auto View =
@@ -280,12 +518,9 @@ glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, -2.0f, 8.0f);
 glm::perspective(glm::radians(60.0f), 1.0f, 0.5f, 30.f);
 #endif
 
-void Renderer::renderShadows(VkCommandBuffer commandBuffer, RenderPass& renderPass, Pipeline& pipeline)
+void Renderer::renderShadows(CommandRecorder& recorder, RenderPass& renderPass, Pipeline& pipeline)
 {
-	renderPass.begin(commandBuffer, m_shadowFramebuffer);
-	setViewport(commandBuffer, 2048, 2048);
-	pipeline.bind(commandBuffer);
-	
+	auto commandBuffer = recorder.getCommandBuffer();
 	auto mvp = MVP{};
 	mvp.proj = Proj;
 	mvp.proj[1][1] *= -1.0f;
@@ -296,38 +531,60 @@ void Renderer::renderShadows(VkCommandBuffer commandBuffer, RenderPass& renderPa
 			glm::vec3{ 0.0f, 1.0f, 0.0f }
 		);
 
-	mvp.model = m_object.getModelMatrix();
+	mvp.model = m_object.getVertexMatrix();
 	m_shadowMvp.write(mvp);
-	m_shadowMvp.bind(commandBuffer, pipeline.getLayout(), 0);
-	m_object.bindMesh(commandBuffer);
-	m_object.draw(commandBuffer, pipeline.getLayout());
+	// Shadow casters tolerate coarser lods, their silhouette is blurred by filtering anyway
+	auto maxShadowError = m_lodPixelError * m_shadowLodBias;
+	m_objectShadowLod = m_object.selectLod(mvp.view, mvp.proj, 2048.0f, maxShadowError);
+	m_shadowCuller.setObject(static_cast<uint32_t>(CullId::Object), m_object.getCullObject(m_objectShadowLod));
 
-	mvp.model = m_plane.getModelMatrix();
+	mvp.model = m_plane.getVertexMatrix();
 	m_shadowMvp2.write(mvp);
-	m_shadowMvp2.bind(commandBuffer, pipeline.getLayout(), 0);
-	m_plane.bindMesh(commandBuffer);
-	m_plane.draw(commandBuffer, pipeline.getLayout());
+	m_shadowCuller.setObject(static_cast<uint32_t>(CullId::Plane), m_plane.getCullObject(m_plane.selectLod(mvp.view, mvp.proj, 2048.0f, maxShadowError)));
+	m_shadowCuller.update(mvp.proj * mvp.view, static_cast<uint32_t>(CullId::Count), m_occlusionCulling);
 
+	m_shadowCuller.cull(commandBuffer, CullPhase::Early);
+	renderPass.begin(commandBuffer, m_shadowFramebuffer);
+	setViewport(recorder, 2048, 2048);
+	drawShadowCasters(recorder, pipeline, CullPhase::Early);
 	renderPass.end(commandBuffer);
+
+	// Casters are culled from the light's point of view, hidden from the camera they can still shadow what it sees
+	if (m_occlusionCulling)
+	{
+		m_shadowCuller.buildPyramid(commandBuffer, m_shadowFramebuffer.getDepthTexture(), { 2048, 2048 });
+		m_shadowCuller.cull(commandBuffer, CullPhase::Late);
+		m_shadowResumePass.begin(commandBuffer, m_shadowFramebuffer);
+		drawShadowCasters(recorder, pipeline, CullPhase::Late);
+		m_shadowResumePass.end(commandBuffer);
+	}
 }
 
-void Renderer::renderScene(VkCommandBuffer commandBuffer, RenderPass& renderPass, Pipeline& pipeline)
+void Renderer::drawShadowCasters(CommandRecorder& recorder, Pipeline& pipeline, CullPhase phase)
 {
-	static auto lastTime = std::chrono::high_resolution_clock::now();
-	auto now = std::chrono::high_resolution_clock::now();
-	auto delta = std::chrono::duration<float, std::chrono::seconds::period>(now - lastTime).count();
-	lastTime = now;
+	pipeline.bind(recorder);
+	auto drawBuffer = m_shadowCuller.getDrawBuffer();
 
-	renderPass.begin(commandBuffer, m_renderFramebuffer);
-	setViewport(commandBuffer);
+	m_shadowMvp.bind(recorder, pipeline.getLayout(), 0);
+	m_object.bindPositions(recorder);
+	m_object.drawIndirect(recorder, drawBuffer, m_shadowCuller.getDrawOffset(phase, static_cast<uint32_t>(CullId::Object)));
 
+	m_shadowMvp2.bind(recorder, pipeline.getLayout(), 0);
+	m_plane.bindPositions(recorder);
+	m_plane.drawIndirect(recorder, drawBuffer, m_shadowCuller.getDrawOffset(phase, static_cast<uint32_t>(CullId::Plane)));
+}
+
+// Polled on the main thread, the simulation applies it on its next step
+void Renderer::submitInput()
+{
 	static auto& input = m_window.getInput();
 	auto cameraMove = glm::vec3{};
+	auto cameraLook = glm::vec2{};
 	if (input.getKeyDown(GLFW_KEY_Q))
 		input.lockCursor(!input.getCursorLock());
 	if (input.getCursorLock())
 	{
-		m_camera.rotate(input.getCursorDelta(), delta);
+		cameraLook = input.getCursorDelta();
 	}
 	if (input.getKey('W')) cameraMove.z += 1;
 	if (input.getKey('S')) cameraMove.z -= 1;
@@ -335,30 +592,58 @@ void Renderer::renderScene(VkCommandBuffer commandBuffer, RenderPass& renderPass
 	if (input.getKey('A')) cameraMove.x -= 1;
 	if (input.getKey(GLFW_KEY_SPACE)) cameraMove.y += 1;
 	if (input.getKey(GLFW_KEY_LEFT_SHIFT)) cameraMove.y -= 1;
-	m_camera.move(cameraMove, delta);
+	m_simulation.addInput(cameraMove, cameraLook);
+}
+
+// Everything the simulation owns is taken from its packets, blended to the time this frame starts
+void Renderer::applyFramePacket()
+{
+	auto frame = m_simulation.getFrame(std::chrono::steady_clock::now());
+	m_camera.setState(frame.camera);
+	for (auto [object, id] : { std::pair{ &m_object, EntityId::Object }, std::pair{ &m_plane, EntityId::Plane } })
+	{
+		auto& transform = frame.transforms[static_cast<size_t>(id)];
+		object->setPosition(transform.position);
+		object->setRotation(transform.rotation);
+		object->setScale(transform.scale);
+	}
+	m_localLights = std::move(frame.localLights);
+}
+
+void Renderer::cullLights(VkCommandBuffer commandBuffer)
+{
+	m_lightClusters.setLights(m_localLights);
+
+	auto extent = m_swapchain.getExtent();
+	auto aspect = extent.width / (float)extent.height;
+	m_lightClusters.update(m_camera.getViewMatrix(), m_camera.getProjMatrix(aspect, false), m_renderFramebuffer.getExtent(), m_camera.getNear(), m_camera.getFar());
+	m_lightClusters.build(commandBuffer);
+}
+
+void Renderer::renderScene(CommandRecorder& recorder, RenderPass& renderPass, Pipeline& pipeline)
+{
+	auto commandBuffer = recorder.getCommandBuffer();
 	auto extent = m_swapchain.getExtent();
 
 	auto view = m_camera.getViewMatrix();
-	auto proj = glm::perspective(glm::radians(80.0f), extent.width / (float)extent.height, 0.1f, 100.0f);
-	proj[1][1] *= -1;
+	auto aspect = extent.width / (float)extent.height;
+	auto proj = m_camera.getProjMatrix(aspect, m_taaEnabled);
 
 	light.viewPosition = m_camera.getPosition();
+	m_light.write(light);
 
 	{
-		m_skyboxPipeline.bind(commandBuffer);
-
-		auto mvp = MVP{};
-		mvp.view = glm::mat4{ glm::mat3{ view } };
-		mvp.proj = proj;
-		m_skyboxMvp.write(mvp);
-		m_skyboxMvp.bind(commandBuffer, m_skyboxPipeline.getLayout(), 0);
-		m_skybox.bind(commandBuffer, m_skyboxPipeline.getLayout(), 1);
-		m_skyboxCube.bindMesh(commandBuffer);
-		m_skyboxCube.draw(commandBuffer, m_skyboxPipeline.getLayout());
+		// Motion vectors are computed without jitter so a static scene has zero motion
+		auto temporal = Temporal{};
+		temporal.viewProj = m_camera.getProjMatrix(aspect, false) * view;
+		temporal.prevViewProj = m_historyValid ? m_prevViewProj : temporal.viewProj;
+		// Only the temporal resolve reconstructs that detail, a plain upscale would just alias
+		if (m_taaEnabled)
+			temporal.mipBias = std::log2(static_cast<float>(m_renderFramebuffer.getExtent().width) / extent.width);
+		m_prevViewProj = temporal.viewProj;
+		m_temporalBuffer.write(temporal);
 	}
 
-	pipeline.bind(commandBuffer);
-	m_skybox.bind(commandBuffer, pipeline.getLayout(), 7);
 	{
 		auto view =
 			glm::lookAt(
@@ -370,48 +655,269 @@ void Renderer::renderScene(VkCommandBuffer commandBuffer, RenderPass& renderPass
 		proj[1][1] *= -1;
 		alignas (16) glm::mat4 lightSpace = proj * view;
 		m_lightSpace.write(lightSpace);
-		m_lightSpace.bind(commandBuffer, pipeline.getLayout(), 6);
 	}
 
-	m_light.write(light);
-	m_light.bind(commandBuffer, pipeline.getLayout(), 1);
-	m_shadowFramebuffer.getDepthTexture().bind(commandBuffer, pipeline.getLayout(), 5);
-
-	m_specularMap.bind(commandBuffer, pipeline.getLayout(), 4);
-	m_object.bindMVP(commandBuffer, pipeline.getLayout(), view, proj);
-	m_object.bindMaterial(commandBuffer, pipeline.getLayout(), 2);
-	m_object.bindTexture(commandBuffer, pipeline.getLayout(), 3);
-	m_object.bindMesh(commandBuffer);
-	m_object.draw(commandBuffer, pipeline.getLayout());
-
-	m_planeSpecularMap.bind(commandBuffer, pipeline.getLayout(), 4);
-	m_plane.bindMVP(commandBuffer, pipeline.getLayout(), view, proj);
-	m_plane.bindMaterial(commandBuffer, pipeline.getLayout(), 2);
-	m_plane.bindTexture(commandBuffer, pipeline.getLayout(), 3);
-	m_plane.bindMesh(commandBuffer);
-	m_plane.draw(commandBuffer, pipeline.getLayout());
+	if (m_softwareOcclusionEnabled)
+	{
+		ZoneScopedN("software occlusion wait");
+		m_softwareOcclusion.wait();
+	}
+	prepareObjects(view, proj);
+	m_sceneCuller.cull(commandBuffer, CullPhase::Early);
+
+	if (m_deferredEnabled)
+		renderGBuffer(recorder, m_gbufferPass, m_gbufferPipeline);
+
+	renderPass.begin(commandBuffer, m_renderFramebuffer);
+	auto renderExtent = m_renderFramebuffer.getExtent();
+	setViewport(recorder, renderExtent.width, renderExtent.height);
+	drawSkybox(recorder, view, proj);
+	if (m_deferredEnabled)
+	{
+		lightGBuffer(recorder, m_deferredLightingPipeline, proj * view);
+	}
+	else
+	{
+		bindForward(recorder, pipeline);
+		drawObjects(recorder, pipeline, CullPhase::Early);
+	}
+	renderPass.end(commandBuffer);
+
+	// Objects the early phase skipped are retested against depth that already has this frame's occluders
+	if (!m_deferredEnabled && m_occlusionCulling)
+	{
+		m_sceneCuller.buildPyramid(commandBuffer, m_renderFramebuffer.getDepthTexture(), renderExtent);
+		m_sceneCuller.cull(commandBuffer, CullPhase::Late);
+		m_renderResumePass.begin(commandBuffer, m_renderFramebuffer);
+		setViewport(recorder, renderExtent.width, renderExtent.height);
+		bindForward(recorder, pipeline);
+		drawObjects(recorder, pipeline, CullPhase::Late);
+		m_renderResumePass.end(commandBuffer);
+	}
+}
+
+void Renderer::drawSkybox(CommandRecorder& recorder, const glm::mat4& view, const glm::mat4& proj)
+{
+	m_skyboxPipeline.bind(recorder);
+
+	auto mvp = MVP{};
+	mvp.model = m_skyboxCube.getVertexMatrix();
+	mvp.view = glm::mat4{ glm::mat3{ view } };
+	mvp.proj = proj;
+	m_skyboxMvp.write(mvp);
+	m_skyboxMvp.bind(recorder, m_skyboxPipeline.getLayout(), 0);
+	m_skybox.bind(recorder, m_skyboxPipeline.getLayout(), 1);
+	m_temporalBuffer.bind(recorder, m_skyboxPipeline.getLayout(), 2);
+	m_skyboxCube.bindMesh(recorder);
+	m_skyboxCube.draw(recorder, m_skyboxPipeline.getLayout());
+}
+
+void Renderer::bindForward(CommandRecorder& recorder, Pipeline& pipeline)
+{
+	pipeline.bind(recorder);
+	m_skybox.bind(recorder, pipeline.getLayout(), 7);
+	m_temporalBuffer.bind(recorder, pipeline.getLayout(), 8);
+	m_lightSpace.bind(recorder, pipeline.getLayout(), 6);
+	m_light.bind(recorder, pipeline.getLayout(), 1);
+	m_lightClusters.bind(recorder, pipeline.getLayout(), 9);
+	m_shadowFramebuffer.getDepthTexture().bind(recorder, pipeline.getLayout(), 5);
+}
+
+// Geometry only writes surface attributes, lighting cost no longer scales with overdraw
+void Renderer::renderGBuffer(CommandRecorder& recorder, RenderPass& renderPass, Pipeline& pipeline)
+{
+	auto commandBuffer = recorder.getCommandBuffer();
+	auto renderExtent = m_gbufferFramebuffer.getExtent();
+	renderPass.begin(commandBuffer, m_gbufferFramebuffer);
+	setViewport(recorder, renderExtent.width, renderExtent.height);
+	pipeline.bind(recorder);
+	m_temporalBuffer.bind(recorder, pipeline.getLayout(), 8);
+	drawObjects(recorder, pipeline, CullPhase::Early);
+	renderPass.end(commandBuffer);
+
+	if (m_occlusionCulling)
+	{
+		m_sceneCuller.buildPyramid(commandBuffer, m_gbufferFramebuffer.getDepthTexture(), renderExtent);
+		m_sceneCuller.cull(commandBuffer, CullPhase::Late);
+		m_gbufferResumePass.begin(commandBuffer, m_gbufferFramebuffer);
+		setViewport(recorder, renderExtent.width, renderExtent.height);
+		pipeline.bind(recorder);
+		m_temporalBuffer.bind(recorder, pipeline.getLayout(), 8);
+		drawObjects(recorder, pipeline, CullPhase::Late);
+		m_gbufferResumePass.end(commandBuffer);
+	}
+}
+
+// One full screen triangle shades every covered pixel once, the depth is carried over for the temporal resolve
+void Renderer::lightGBuffer(CommandRecorder& recorder, Pipeline& pipeline, const glm::mat4& viewProj)
+{
+	pipeline.bind(recorder);
+	{
+		auto extent = m_gbufferFramebuffer.getExtent();
+		auto params = DeferredParams{};
+		params.invViewProj = glm::inverse(viewProj);
+		params.viewport = { static_cast<float>(extent.width), static_cast<float>(extent.height), 0.0f, 0.0f };
+		m_deferredBuffer.write(params);
+		m_deferredBuffer.bind(recorder, pipeline.getLayout(), 8);
+	}
+	m_gbufferFramebuffer.getColorTexture(0).bind(recorder, pipeline.getLayout(), 0);
+	m_gbufferFramebuffer.getColorTexture(1).bind(recorder, pipeline.getLayout(), 1);
+	m_gbufferFramebuffer.getColorTexture(2).bind(recorder, pipeline.getLayout(), 2);
+	m_gbufferFramebuffer.getDepthTexture().bind(recorder, pipeline.getLayout(), 3);
+	m_light.bind(recorder, pipeline.getLayout(), 4);
+	m_lightSpace.bind(recorder, pipeline.getLayout(), 5);
+	m_shadowFramebuffer.getDepthTexture().bind(recorder, pipeline.getLayout(), 6);
+	m_skybox.bind(recorder, pipeline.getLayout(), 7);
+	m_lightClusters.bind(recorder, pipeline.getLayout(), 9);
+	recorder.draw(3);
+}
+
+// Rasterizes the scene objects as their own occluders on the worker threads, the shadow and light passes
+// are recorded in the meantime and renderScene collects the results before anything is drawn
+void Renderer::beginSoftwareOcclusion()
+{
+	if (!m_softwareOcclusionEnabled) return;
+	auto extent = m_swapchain.getExtent();
+	auto aspect = extent.width / (float)extent.height;
+	auto viewProj = m_camera.getProjMatrix(aspect, false) * m_camera.getViewMatrix();
+
+	// Both lists follow the CullId order
+	auto occluders = std::vector<Occluder>{
+		{ m_model.getOccluderPositions(), m_model.getOccluderIndices(), m_object.getVertexMatrix() },
+		{ m_planeModel.getOccluderPositions(), m_planeModel.getOccluderIndices(), m_plane.getVertexMatrix() },
+	};
+	auto occludees = std::vector<Bounds>{ m_object.getWorldBounds(), m_plane.getWorldBounds() };
+	m_softwareOcclusion.begin(viewProj, std::move(occluders), std::move(occludees));
+}
+
+bool Renderer::isSoftwareVisible(CullId id)
+{
+	return !m_softwareOcclusionEnabled || m_softwareOcclusion.isVisible(static_cast<uint32_t>(id));
+}
+
+// Lods, matrices and texture requests are settled once per frame, before either culling phase draws
+void Renderer::prepareObjects(const glm::mat4& view, const glm::mat4& proj)
+{
+	auto viewportHeight = static_cast<float>(m_renderFramebuffer.getExtent().height);
+	m_objectLod = m_object.selectLod(view, proj, viewportHeight, m_lodPixelError);
+	m_object.updateMVP(view, proj);
+	m_sceneCuller.setObject(static_cast<uint32_t>(CullId::Object), isSoftwareVisible(CullId::Object) ? m_object.getCullObject(m_objectLod) : CullObject{});
+	auto objectSize = m_object.getScreenSize(view, proj, viewportHeight);
+	m_textureStreamer.request(m_model.getTexture(), objectSize);
+	m_textureStreamer.request(*m_specularMap, objectSize);
+
+	m_plane.updateMVP(view, proj);
+	m_sceneCuller.setObject(static_cast<uint32_t>(CullId::Plane),
+		isSoftwareVisible(CullId::Plane) ? m_plane.getCullObject(m_plane.selectLod(view, proj, viewportHeight, m_lodPixelError)) : CullObject{});
+	auto planeSize = m_plane.getScreenSize(view, proj, viewportHeight);
+	m_textureStreamer.request(m_planeModel.getTexture(), planeSize);
+	m_textureStreamer.request(*m_planeSpecularMap, planeSize);
+
+	m_sceneCuller.update(proj * view, static_cast<uint32_t>(CullId::Count), m_occlusionCulling);
+}
+
+void Renderer::drawObjects(CommandRecorder& recorder, Pipeline& pipeline, CullPhase phase)
+{
+	auto drawBuffer = m_sceneCuller.getDrawBuffer();
+
+	// Objects the software pass hid are not even recorded
+	if (isSoftwareVisible(CullId::Object))
+	{
+		m_specularMap->bind(recorder, pipeline.getLayout(), 4);
+		m_object.bindMVP(recorder, pipeline.getLayout());
+		m_object.bindMaterial(recorder, pipeline.getLayout(), 2);
+		m_object.bindTexture(recorder, pipeline.getLayout(), 3);
+		m_object.bindMesh(recorder);
+		m_object.drawIndirect(recorder, drawBuffer, m_sceneCuller.getDrawOffset(phase, static_cast<uint32_t>(CullId::Object)));
+	}
+
+	if (isSoftwareVisible(CullId::Plane))
+	{
+		m_planeSpecularMap->bind(recorder, pipeline.getLayout(), 4);
+		m_plane.bindMVP(recorder, pipeline.getLayout());
+		m_plane.bindMaterial(recorder, pipeline.getLayout(), 2);
+		m_plane.bindTexture(recorder, pipeline.getLayout(), 3);
+		m_plane.bindMesh(recorder);
+		m_plane.drawIndirect(recorder, drawBuffer, m_sceneCuller.getDrawOffset(phase, static_cast<uint32_t>(CullId::Plane)));
+	}
+}
 
+void Renderer::resolveTemporal(CommandRecorder& recorder, RenderPass& renderPass, Pipeline& pipeline)
+{
+	auto commandBuffer = recorder.getCommandBuffer();
+	auto& history = m_historyFramebuffers[m_historyIndex ^ 1];
+	auto& target = m_historyFramebuffers[m_historyIndex];
+
+	renderPass.begin(commandBuffer, target);
+	auto outputExtent = target.getExtent();
+	setViewport(recorder, outputExtent.width, outputExtent.height);
+	pipeline.bind(recorder);
+	{
+		auto sceneExtent = m_renderFramebuffer.getExtent();
+		auto sceneMaxExtent = m_renderFramebuffer.getMaxExtent();
+		auto historyMaxExtent = history.getMaxExtent();
+		m_temporalResolve.sceneViewport = {
+			static_cast<float>(sceneExtent.width), static_cast<float>(sceneExtent.height),
+			1.0f / sceneMaxExtent.width, 1.0f / sceneMaxExtent.height
+		};
+		m_temporalResolve.historyViewport = {
+			static_cast<float>(outputExtent.width), static_cast<float>(outputExtent.height),
+			1.0f / historyMaxExtent.width, 1.0f / historyMaxExtent.height
+		};
+		m_temporalResolve.jitter = m_camera.getJitter() * glm::vec2{ sceneExtent.width, sceneExtent.height } * 0.5f;
+		m_temporalResolve.reset = !m_historyValid;
+		m_temporalResolveBuffer.write(m_temporalResolve);
+		m_temporalResolveBuffer.bind(recorder, pipeline.getLayout(), 4);
+	}
+	m_renderFramebuffer.getColorTexture(0).bind(recorder, pipeline.getLayout(), 0);
+	m_renderFramebuffer.getColorTexture(1).bind(recorder, pipeline.getLayout(), 1);
+	m_renderFramebuffer.getDepthTexture().bind(recorder, pipeline.getLayout(), 2);
+	history.getColorTexture(0).bind(recorder, pipeline.getLayout(), 3);
+	recorder.draw(3);
 	renderPass.end(commandBuffer);
+
+	m_historyValid = true;
 }
 
-void Renderer::combine(VkCommandBuffer commandBuffer, RenderPass& renderPass, Pipeline& pipeline, uint32_t imageIndex)
+void Renderer::combine(CommandRecorder& recorder, RenderPass& renderPass, Pipeline& pipeline, uint32_t imageIndex)
 {
+	auto commandBuffer = recorder.getCommandBuffer();
 	renderPass.begin(commandBuffer, m_swapchain.getFramebuffer(imageIndex));
-	setViewport(commandBuffer);
-	pipeline.bind(commandBuffer);
+	setViewport(recorder);
+	pipeline.bind(recorder);
+	// With TAA the resolve has already upscaled the scene into the history at output resolution
+	auto& source = m_taaEnabled ? m_historyFramebuffers[m_historyIndex] : m_renderFramebuffer;
 	{
+		auto sceneExtent = source.getExtent();
+		auto maxExtent = source.getMaxExtent();
+		auto outputExtent = m_swapchain.getExtent();
+		m_global.upscale = sceneExtent.width != outputExtent.width || sceneExtent.height != outputExtent.height;
+		m_global.viewport = {
+			static_cast<float>(sceneExtent.width), static_cast<float>(sceneExtent.height),
+			1.0f / maxExtent.width, 1.0f / maxExtent.height
+		};
 		m_globalBuffer.write(m_global);
-		m_globalBuffer.bind(commandBuffer, pipeline.getLayout(), 1);
+		m_globalBuffer.bind(recorder, pipeline.getLayout(), 1);
 	}
-	m_renderFramebuffer.getColorTexture(0).bind(commandBuffer, pipeline.getLayout(), 0);
-	vkCmdDraw(commandBuffer, 6, 1, 0, 0);
+	source.getColorTexture(0).bind(recorder, pipeline.getLayout(), 0);
+	recorder.draw(6);
 	ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), commandBuffer);
+	recorder.invalidate();
 	renderPass.end(commandBuffer);
 }
 
+// Called before input is polled, everything the frame shows is sampled after the wait
+void Renderer::waitFrame()
+{
+	ZoneScopedN("frame pacing");
+	m_framePacer.wait();
+	vkWaitForFences(m_device.getDevice(), 1, &m_inFlightFence, VK_TRUE, UINT64_MAX);
+}
+
 void Renderer::render()
 {
 	ZoneScopedN("render");
+	m_jobSystem.pump();
 
 	ImGui_ImplVulkan_NewFrame();
 	ImGui_ImplGlfw_NewFrame();
@@ -428,18 +934,176 @@ void Renderer::render()
 		ImGui::DragFloat("shininess", &m_object.material.shininess, 0.5f, 0.5f, 128.0f);
 		ImGui::End();
 
-		if (pos != cachePos) m_object.setPosition(pos);
+		if (pos != cachePos) m_simulation.setTransform(EntityId::Object, { pos, m_object.getRotation(), m_object.getScale() });
 
 		ImGui::Begin("Light");
 		ImGui::DragFloat3("direction", (float*)&light.direction, 0.05f, -1.f, 1.f);
 		ImGui::ColorEdit3("ambient", (float*)&light.ambient);
 		ImGui::ColorEdit3("diffuse", (float*)&light.diffuse);
 		ImGui::ColorEdit3("specular", (float*)&light.specular);
+		ImGui::Separator();
+		{
+			auto regenerate = ImGui::SliderInt("local lights", &m_localLightCount, 0, static_cast<int>(LightClusters::MAX_LIGHTS));
+			ImGui::SameLine();
+			if (ImGui::Button("stress"))
+			{
+				// Short ranges keep the 10k lights at a few dozen per cluster
+				m_localLightCount = 10000;
+				m_localLightRange = 0.5f;
+				regenerate = true;
+			}
+			regenerate |= ImGui::DragFloat("light range", &m_localLightRange, 0.05f, 0.1f, 10.0f);
+			regenerate |= ImGui::DragFloat("light intensity", &m_localLightIntensity, 0.05f, 0.0f, 10.0f);
+			if (regenerate) m_simulation.setLocalLights(m_localLightCount, m_localLightRange, m_localLightIntensity);
+		}
+		if (ImGui::Checkbox("animate lights", &m_animateLights))
+			m_simulation.setAnimateLights(m_animateLights);
+		ImGui::Text("%u lights in %u clusters", m_lightClusters.getLightCount(), m_lightClusters.getClusterCount());
 		ImGui::End();
 
 		ImGui::Begin("Render");
 		ImGui::DragFloat("gamma", (float*)&m_global.gamma, 0.05f, 0.f, 10.f);
 		ImGui::DragFloat("exposure", (float*)&m_global.exposure, 0.05f, 0.f, 5.f);
+		ImGui::Separator();
+		if (ImGui::Checkbox("temporal aa", &m_taaEnabled))
+			m_historyValid = false;
+		ImGui::Checkbox("deferred shading", &m_deferredEnabled);
+		{
+			const char* presets[] = { "native", "quality", "balanced", "performance" };
+			const float scales[] = { 1.0f, 0.67f, 0.58f, 0.5f };
+			auto preset = 0;
+			for (int i = 0; i < 4; i++)
+				if (std::abs(m_renderScale.maxScale - scales[i]) < 0.005f) preset = i;
+			if (ImGui::Combo("upscale", &preset, presets, 4))
+			{
+				m_renderScale.maxScale = scales[preset];
+				m_renderScale.minScale = std::min(m_renderScale.minScale, m_renderScale.maxScale);
+				m_renderScale.setScale(m_renderScale.maxScale);
+			}
+		}
+		ImGui::DragFloat("lod pixel error", &m_lodPixelError, 0.1f, 0.f, 50.f, "%.1f px");
+		ImGui::DragFloat("shadow lod bias", &m_shadowLodBias, 0.1f, 1.f, 16.f);
+		ImGui::Text("object lod %u, shadow lod %u", m_objectLod, m_objectShadowLod);
+		ImGui::Checkbox("occlusion culling", &m_occlusionCulling);
+		for (auto [name, culler] : { std::pair{ "scene", &m_sceneCuller }, std::pair{ "shadow", &m_shadowCuller } })
+		{
+			auto& stats = culler->getStats();
+			ImGui::Text("%s: %u early, %u late, %u occluded, %u outside", name, stats.drawn[0], stats.drawn[1], stats.occluded, stats.outside);
+		}
+		ImGui::Checkbox("software occlusion", &m_softwareOcclusionEnabled);
+		if (m_softwareOcclusionEnabled)
+		{
+			auto& stats = m_softwareOcclusion.getStats();
+			auto rate = stats.tested > 0 ? 100.0f * stats.culled / stats.tested : 0.0f;
+			ImGui::Text("software: %u/%u culled (%.0f%%), %u triangles, %.2f ms", stats.culled, stats.tested, rate, stats.triangles, stats.time);
+		}
+		if (auto pending = m_assetLoader.getPendingCount(); pending > 0)
+			ImGui::Text("loading %u assets", pending);
+		{
+			auto stats = m_assetManager.getStats();
+			ImGui::Text("%u meshes (%u refs), %u textures (%u refs)", stats.meshCount, stats.meshReferences, stats.textureCount, stats.textureReferences);
+		}
+		ImGui::Text("%u samplers", m_device.getSamplerCache().getSamplerCount());
+		ImGui::Text("%u pending releases", m_device.getDeletionQueue().getPendingCount());
+		ImGui::Separator();
+		ImGui::DragFloat("texture budget", &m_textureBudget, 0.25f, 0.f, 4096.f, "%.2f MiB");
+		{
+			auto& stats = m_textureStreamer.getStats();
+			ImGui::Text("%u textures, %.2f MiB resident", stats.textureCount, stats.residentBytes / (1024.0f * 1024.0f));
+			ImGui::Text("%u misses (%llu total), %llu levels streamed, %llu evicted", stats.misses,
+				static_cast<unsigned long long>(stats.totalMisses), static_cast<unsigned long long>(stats.streamedLevels), static_cast<unsigned long long>(stats.evictedLevels));
+		}
+		ImGui::Separator();
+		ImGui::Checkbox("dynamic resolution", &m_renderScale.enabled);
+		ImGui::DragFloat("target gpu time", &m_renderScale.targetTime, 0.1f, 1.f, 50.f, "%.1f ms");
+		ImGui::DragFloat("min scale", &m_renderScale.minScale, 0.01f, 0.25f, 1.f);
+		auto sceneExtent = m_renderFramebuffer.getExtent();
+		ImGui::Text("scale %.2f (%u x %u)", m_renderScale.getScale(), sceneExtent.width, sceneExtent.height);
+		if (m_gpuTimer.isSupported())
+		{
+			ImGui::Text("gpu frame %.2f ms", m_gpuTimer.getTime(static_cast<uint32_t>(GpuScope::Frame)));
+			ImGui::Text("shadow %.2f ms, lights %.2f ms, scene %.2f ms, taa %.2f ms, post %.2f ms",
+				m_gpuTimer.getTime(static_cast<uint32_t>(GpuScope::Shadow)),
+				m_gpuTimer.getTime(static_cast<uint32_t>(GpuScope::Lights)),
+				m_gpuTimer.getTime(static_cast<uint32_t>(GpuScope::Scene)),
+				m_gpuTimer.getTime(static_cast<uint32_t>(GpuScope::Temporal)),
+				m_gpuTimer.getTime(static_cast<uint32_t>(GpuScope::Post)));
+		}
+		if (m_pipelineStatistics.isSupported())
+		{
+			for (auto [name, scope] : { std::pair{ "shadow", StatisticsScope::Shadow }, std::pair{ "scene", StatisticsScope::Scene } })
+			{
+				auto& counters = m_pipelineStatistics.getCounters(static_cast<uint32_t>(scope));
+				auto acmr = counters.inputPrimitives > 0 ? static_cast<float>(counters.vertexInvocations) / counters.inputPrimitives : 0.0f;
+				ImGui::Text("%s: %llu vs invocations, %llu triangles, acmr %.2f", name,
+					static_cast<unsigned long long>(counters.vertexInvocations), static_cast<unsigned long long>(counters.inputPrimitives), acmr);
+			}
+		}
+		// Recorded by the previous frame, triangles of indirect draws are left to the statistics above
+		for (auto [name, scope] : { std::pair{ "shadow", GpuScope::Shadow }, std::pair{ "scene", GpuScope::Scene }, std::pair{ "taa", GpuScope::Temporal }, std::pair{ "post", GpuScope::Post } })
+		{
+			auto& stats = m_recorder.getStats(static_cast<uint32_t>(scope));
+			ImGui::Text("%s: %u draws, %u binds, %u skipped, %llu triangles", name, stats.draws, stats.binds, stats.skipped,
+				static_cast<unsigned long long>(stats.triangles));
+		}
+		ImGui::End();
+
+		ImGui::Begin("Frame");
+		{
+			const VkPresentModeKHR modes[] = { VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR };
+			const char* names[] = { "fifo", "mailbox", "immediate" };
+			auto& available = m_swapchain.getPresentModes();
+			auto current = m_swapchain.getPresentMode();
+			for (int i = 0; i < 3; i++)
+			{
+				if (std::find(available.begin(), available.end(), modes[i]) == available.end()) continue;
+				if (ImGui::RadioButton(names[i], current == modes[i]) && current != modes[i])
+					m_swapchain.setPresentMode(modes[i]);
+				ImGui::SameLine();
+			}
+			ImGui::NewLine();
+		}
+		ImGui::Checkbox("frame limit", &m_framePacer.limitEnabled);
+		ImGui::DragFloat("target fps", &m_framePacer.targetFps, 1.f, 10.f, 1000.f, "%.0f");
+		ImGui::DragFloat("background fps", &m_framePacer.backgroundFps, 1.f, 1.f, 240.f, "%.0f");
+		if (m_device.isPresentWaitSupported())
+		{
+			ImGui::Checkbox("present wait", &m_framePacer.presentWait);
+			auto queued = static_cast<int>(m_framePacer.maxQueuedFrames);
+			if (ImGui::SliderInt("queued presents", &queued, 1, 3))
+				m_framePacer.maxQueuedFrames = static_cast<uint32_t>(queued);
+		}
+		else
+			ImGui::Text("present wait not supported");
+		ImGui::Text("frame %.2f ms%s", m_framePacer.getFrameTime(), m_framePacer.isThrottled() ? " (throttled)" : "");
+		ImGui::Text("simulation tick %llu at %.0f Hz", static_cast<unsigned long long>(m_simulation.getTick()), 1.0f / Simulation::STEP);
+		{
+			auto stats = m_jobSystem.getStats();
+			ImGui::Text("%u job threads, %llu jobs run, %llu stolen", m_jobSystem.getThreadCount(),
+				static_cast<unsigned long long>(stats.executed), static_cast<unsigned long long>(stats.stolen));
+		}
+		ImGui::End();
+
+		ImGui::Begin("Memory");
+		{
+			auto& memoryTracker = m_device.getMemoryTracker();
+			const auto mib = 1024.0f * 1024.0f;
+			ImGui::Text("heaps (%s)", memoryTracker.isBudgetSupported() ? "memory budget" : "tracked only");
+			for (auto [i, heap] : std::views::enumerate(memoryTracker.getHeaps()))
+			{
+				ImGui::Text("%d%s: %.1f / %.1f MiB of %.1f MiB", static_cast<int>(i), heap.deviceLocal ? " device" : " host",
+					heap.usage / mib, heap.budget / mib, heap.size / mib);
+			}
+			ImGui::Separator();
+			for (uint32_t i = 0; i < static_cast<uint32_t>(MemoryCategory::Count); i++)
+			{
+				auto category = static_cast<MemoryCategory>(i);
+				ImGui::Text("%s: %.2f MiB in %u allocations", MemoryTracker::getCategoryName(category),
+					memoryTracker.getCategorySize(category) / mib, memoryTracker.getCategoryCount(category));
+			}
+			if (ImGui::Button("dump allocations"))
+				memoryTracker.dump("gpu_memory.json");
+		}
 		ImGui::End();
 
 		ImGui::Render();
@@ -451,6 +1115,20 @@ void Renderer::render()
 		imageIndex = m_swapchain.beginFrame(m_inFlightFence, m_imageAvailableSemaphore);
 		if (imageIndex == UINT32_MAX) return;
 	}
+	{
+		ZoneScopedN("asset uploads");
+		m_device.getDeletionQueue().update();
+		m_assetLoader.update();
+		updateMemory();
+		m_textureStreamer.update();
+		m_assetManager.update();
+	}
+	updateRenderExtent();
+	plotCounters();
+
+	submitInput();
+	applyFramePacket();
+	beginSoftwareOcclusion();
 
 	auto commandBuffer = m_commandBuffer;
 	auto beginInfo = VkCommandBufferBeginInfo{};
@@ -458,18 +1136,54 @@ void Renderer::render()
 	if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
 		throw std::runtime_error{ "failed to record command buffer" };
 
+	m_gpuTimer.reset(commandBuffer);
+	m_pipelineStatistics.reset(commandBuffer);
+	m_recorder.begin(commandBuffer);
+	m_gpuTimer.begin(commandBuffer, static_cast<uint32_t>(GpuScope::Frame));
 	{
 		ZoneScopedN("shadow pass");
-		renderShadows(commandBuffer, m_shadowPass, m_shadowPipeline);
+		m_gpuTimer.begin(commandBuffer, static_cast<uint32_t>(GpuScope::Shadow));
+		m_recorder.setScope(static_cast<uint32_t>(GpuScope::Shadow));
+		m_pipelineStatistics.begin(commandBuffer, static_cast<uint32_t>(StatisticsScope::Shadow));
+		renderShadows(m_recorder, m_shadowPass, m_shadowPipeline);
+		m_pipelineStatistics.end(commandBuffer, static_cast<uint32_t>(StatisticsScope::Shadow));
+		m_gpuTimer.end(commandBuffer, static_cast<uint32_t>(GpuScope::Shadow));
+	}
+	{
+		ZoneScopedN("light culling");
+		m_gpuTimer.begin(commandBuffer, static_cast<uint32_t>(GpuScope::Lights));
+		cullLights(commandBuffer);
+		m_gpuTimer.end(commandBuffer, static_cast<uint32_t>(GpuScope::Lights));
 	}
 	{
 		ZoneScopedN("main pass");
-		renderScene(commandBuffer, m_renderPass, m_renderPipeline);
+		m_gpuTimer.begin(commandBuffer, static_cast<uint32_t>(GpuScope::Scene));
+		m_recorder.setScope(static_cast<uint32_t>(GpuScope::Scene));
+		m_pipelineStatistics.begin(commandBuffer, static_cast<uint32_t>(StatisticsScope::Scene));
+		renderScene(m_recorder, m_renderPass, m_renderPipeline);
+		m_pipelineStatistics.end(commandBuffer, static_cast<uint32_t>(StatisticsScope::Scene));
+		m_gpuTimer.end(commandBuffer, static_cast<uint32_t>(GpuScope::Scene));
+	}
+	{
+		ZoneScopedN("taa pass");
+		// Written even when skipped, the timer only reads back a pool where every query is available
+		m_gpuTimer.begin(commandBuffer, static_cast<uint32_t>(GpuScope::Temporal));
+		if (m_taaEnabled)
+		{
+			m_recorder.setScope(static_cast<uint32_t>(GpuScope::Temporal));
+			resolveTemporal(m_recorder, m_taaPass, m_taaPipeline);
+		}
+		m_gpuTimer.end(commandBuffer, static_cast<uint32_t>(GpuScope::Temporal));
 	}
 	{
 		ZoneScopedN("postproc pass");
-		combine(commandBuffer, m_swapchainPass, m_combinePipeline, imageIndex);
+		m_gpuTimer.begin(commandBuffer, static_cast<uint32_t>(GpuScope::Post));
+		m_recorder.setScope(static_cast<uint32_t>(GpuScope::Post));
+		combine(m_recorder, m_swapchainPass, m_combinePipeline, imageIndex);
+		m_gpuTimer.end(commandBuffer, static_cast<uint32_t>(GpuScope::Post));
 	}
+	m_gpuTimer.end(commandBuffer, static_cast<uint32_t>(GpuScope::Frame));
+	m_historyIndex ^= 1;
 
 	if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
 		throw std::runtime_error{ "failed to end command buffer" };
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "core/job_system.hpp"
 #include "graphics/vulkan/config.hpp"
 #include "graphics/vulkan/types.hpp"
 #include "graphics/vulkan/context/context.hpp"
@@ -12,6 +13,18 @@
 #include "graphics/vulkan/model.hpp"
 #include "graphics/vulkan/camera.hpp"
 #include "graphics/vulkan/object.hpp"
+#include "graphics/vulkan/gpu_timer.hpp"
+#include "graphics/vulkan/pipeline_statistics.hpp"
+#include "graphics/vulkan/command_recorder.hpp"
+#include "graphics/vulkan/render_scale.hpp"
+#include "graphics/vulkan/frame_pacer.hpp"
+#include "graphics/vulkan/asset_loader.hpp"
+#include "graphics/vulkan/texture_streamer.hpp"
+#include "graphics/vulkan/asset_manager.hpp"
+#include "graphics/vulkan/light_clusters.hpp"
+#include "graphics/vulkan/occlusion_culler.hpp"
+#include "graphics/vulkan/software_occlusion.hpp"
+#include "graphics/vulkan/simulation.hpp"
 #include "graphics/vulkan/render_pass/swapchain_pass.hpp"
 #include "graphics/vulkan/render_pass/offscreen_pass.hpp"
 #include "graphics/vulkan/render_pass/offscreen_framebuffer.hpp"
@@ -24,6 +37,7 @@
 #include <glm/glm.hpp>
 
 #include <vector>
+#include <array>
 #include <optional>
 #include <memory>
 
@@ -35,6 +49,7 @@ class Renderer
 public:
 	Renderer(Window& window);
 	~Renderer();
+	void waitFrame();
 	void render();
 
 private:
@@ -54,13 +69,57 @@ private:
 		Vertical
 	};
 
-	void renderShadows(VkCommandBuffer commandBuffer, RenderPass& renderPass, Pipeline& pipeline);
-	void renderScene(VkCommandBuffer commandBuffer, RenderPass& renderPass, Pipeline& pipeline);
-	void combine(VkCommandBuffer commandBuffer, RenderPass& renderPass, Pipeline& pipeline, uint32_t imageIndex);
+	enum class GpuScope : uint32_t
+	{
+		Frame,
+		Shadow,
+		Lights,
+		Scene,
+		Temporal,
+		Post,
+		Count
+	};
+
+	enum class StatisticsScope : uint32_t
+	{
+		Shadow,
+		Scene,
+		Count
+	};
+
+	// Slots of the scene objects in the occlusion cullers
+	enum class CullId : uint32_t
+	{
+		Object,
+		Plane,
+		Count
+	};
+
+	void submitInput();
+	void applyFramePacket();
+	void cullLights(VkCommandBuffer commandBuffer);
+	void renderShadows(CommandRecorder& recorder, RenderPass& renderPass, Pipeline& pipeline);
+	void drawShadowCasters(CommandRecorder& recorder, Pipeline& pipeline, CullPhase phase);
+	void renderScene(CommandRecorder& recorder, RenderPass& renderPass, Pipeline& pipeline);
+	void bindForward(CommandRecorder& recorder, Pipeline& pipeline);
+	void renderGBuffer(CommandRecorder& recorder, RenderPass& renderPass, Pipeline& pipeline);
+	void lightGBuffer(CommandRecorder& recorder, Pipeline& pipeline, const glm::mat4& viewProj);
+	void beginSoftwareOcclusion();
+	bool isSoftwareVisible(CullId id);
+	void prepareObjects(const glm::mat4& view, const glm::mat4& proj);
+	void drawObjects(CommandRecorder& recorder, Pipeline& pipeline, CullPhase phase);
+	void drawSkybox(CommandRecorder& recorder, const glm::mat4& view, const glm::mat4& proj);
+	void resolveTemporal(CommandRecorder& recorder, RenderPass& renderPass, Pipeline& pipeline);
+	void combine(CommandRecorder& recorder, RenderPass& renderPass, Pipeline& pipeline, uint32_t imageIndex);
 
 private:
-	void setViewport(VkCommandBuffer commandBuffer);
-	void setViewport(VkCommandBuffer commandBuffer, uint32_t width, uint32_t height);
+	void setViewport(CommandRecorder& recorder);
+	void setViewport(CommandRecorder& recorder, uint32_t width, uint32_t height);
+	VkExtent2D getMaxRenderExtent();
+	void updateRenderExtent();
+	void updateMemory();
+	void plotCounters();
+	void resizeHistory(uint32_t width, uint32_t height);
 
 private:
 	Camera m_camera;
@@ -71,19 +130,44 @@ private:
 	VkSemaphore m_renderFinishedSemaphore;
 	VkFence m_inFlightFence;
 
+	JobSystem m_jobSystem;
 	Context m_context;
 	Device m_device;
 	Swapchain m_swapchain;
 	DescriptorPool m_descriptorPool;
+	AssetLoader m_assetLoader;
+	TextureStreamer m_textureStreamer;
+	AssetManager m_assetManager;
 	SwapchainPass m_swapchainPass;
 	OffscreenPass m_renderPass;
 	OffscreenPass m_shadowPass;
+	OffscreenPass m_taaPass;
+	OffscreenPass m_gbufferPass;
+	// Same passes loading what the early culling phase drew, for the late phase
+	OffscreenPass m_renderResumePass;
+	OffscreenPass m_shadowResumePass;
+	OffscreenPass m_gbufferResumePass;
 	OffscreenFramebuffer m_renderFramebuffer;
 	OffscreenFramebuffer m_shadowFramebuffer;
+	OffscreenFramebuffer m_gbufferFramebuffer;
+	std::array<OffscreenFramebuffer, 2> m_historyFramebuffers;
+	GpuTimer m_gpuTimer;
+	PipelineStatistics m_pipelineStatistics;
+	CommandRecorder m_recorder;
+	RenderScale m_renderScale;
+	FramePacer m_framePacer;
 	Pipeline m_combinePipeline;
 	Pipeline m_renderPipeline;
 	Pipeline m_shadowPipeline;
 	Pipeline m_skyboxPipeline;
+	Pipeline m_taaPipeline;
+	Pipeline m_gbufferPipeline;
+	Pipeline m_deferredLightingPipeline;
+	LightClusters m_lightClusters;
+	OcclusionCuller m_sceneCuller;
+	OcclusionCuller m_shadowCuller;
+	SoftwareOcclusion m_softwareOcclusion;
+	Simulation m_simulation;
 	LightBuffer m_light;
 	Model m_model;
 	Model m_cube;
@@ -91,8 +175,8 @@ private:
 	Object m_object;
 	Object m_plane;
 	Object m_skyboxCube;
-	ImageTexture m_specularMap;
-	ImageTexture m_planeSpecularMap;
+	TexturePtr m_specularMap;
+	TexturePtr m_planeSpecularMap;
 	CubemapTexture m_skybox;
 
 	UniformBuffer<MVP> m_shadowMvp;
@@ -100,8 +184,35 @@ private:
 	UniformBuffer<MVP> m_skyboxMvp;
 	UniformBuffer<Global> m_globalBuffer;
 	UniformBuffer<glm::mat4> m_lightSpace;
+	UniformBuffer<Temporal> m_temporalBuffer;
+	UniformBuffer<TemporalResolve> m_temporalResolveBuffer;
+	UniformBuffer<DeferredParams> m_deferredBuffer;
 	Light light{};
+	std::vector<LocalLight> m_localLights{};
+	int m_localLightCount = 256;
+	float m_localLightRange = 1.5f;
+	float m_localLightIntensity = 1.0f;
+	bool m_animateLights = true;
 	Global m_global{};
+	TemporalResolve m_temporalResolve{};
+	glm::mat4 m_prevViewProj{};
+	uint32_t m_historyIndex{};
+	bool m_taaEnabled = true;
+	bool m_historyValid = false;
+	bool m_deferredEnabled = false;
+	bool m_occlusionCulling = true;
+	bool m_softwareOcclusionEnabled = false;
+	float m_lodPixelError = 1.0f;
+	float m_shadowLodBias = 4.0f;
+	float m_textureBudget = 256.0f; // MiB
+	uint32_t m_objectLod{};
+	uint32_t m_objectShadowLod{};
+#ifdef VK_PROFILING
+	uint64_t m_uploadedTotal{};
+#endif
+	FramebufferProps m_swapchainFramebufferProps{};
 	FramebufferProps m_renderFramebufferProps{};
 	FramebufferProps m_shadowFramebufferProps{};
+	FramebufferProps m_historyFramebufferProps{};
+	FramebufferProps m_gbufferFramebufferProps{};
 };
\ No newline at end of file
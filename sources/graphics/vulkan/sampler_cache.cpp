@@ -0,0 +1,103 @@
+#include "graphics/vulkan/sampler_cache.hpp"
+#include "graphics/vulkan/context/device.hpp"
+#include "graphics/vulkan/locator.hpp"
+
+#include <cassert>
+#include <functional>
+#include <stdexcept>
+#include <tuple>
+
+static auto tie(const VkSamplerCreateInfo& info)
+{
+	return std::tie(info.flags, info.magFilter, info.minFilter, info.mipmapMode, info.addressModeU, info.addressModeV, info.addressModeW,
+		info.mipLodBias, info.anisotropyEnable, info.maxAnisotropy, info.compareEnable, info.compareOp, info.minLod, info.maxLod,
+		info.borderColor, info.unnormalizedCoordinates);
+}
+
+size_t SamplerCache::Hash::operator()(const VkSamplerCreateInfo& info) const
+{
+	auto hash = size_t{ 0xcbf29ce484222325 };
+	std::apply([&](const auto&... fields) { ((hash = (hash ^ std::hash<std::decay_t<decltype(fields)>>{}(fields)) * 0x100000001b3), ...); }, tie(info));
+	return hash;
+}
+
+bool SamplerCache::Equal::operator()(const VkSamplerCreateInfo& a, const VkSamplerCreateInfo& b) const
+{
+	return tie(a) == tie(b);
+}
+
+VkSamplerCreateInfo SamplerCache::getDefaultInfo()
+{
+	auto createInfo = VkSamplerCreateInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	createInfo.magFilter = VK_FILTER_LINEAR;
+	createInfo.minFilter = VK_FILTER_LINEAR;
+	createInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	createInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	createInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	createInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+	createInfo.anisotropyEnable = VK_TRUE;
+	createInfo.maxAnisotropy = Locator::getDevice().getSamplerCache().getMaxAnisotropy();
+	createInfo.unnormalizedCoordinates = VK_FALSE;
+	createInfo.compareEnable = VK_FALSE;
+	createInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+	createInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+	createInfo.mipLodBias = 0.0f;
+	createInfo.minLod = 0.0f;
+	// Views select the mip range, so one sampler serves textures with any level count
+	createInfo.maxLod = VK_LOD_CLAMP_NONE;
+	return createInfo;
+}
+
+SamplerCache::~SamplerCache()
+{
+	destroy();
+}
+
+void SamplerCache::destroy()
+{
+	if (m_initialized)
+	{
+		for (auto& [createInfo, sampler] : m_samplers)
+			vkDestroySampler(m_device->getDevice(), sampler, nullptr);
+		m_samplers.clear();
+	}
+	m_initialized = false;
+}
+
+void SamplerCache::init()
+{
+	assert(!m_initialized);
+	m_initialized = true;
+	m_device = &Locator::getDevice();
+
+	auto gpuProps = VkPhysicalDeviceProperties{};
+	vkGetPhysicalDeviceProperties(m_device->getGpu(), &gpuProps);
+	m_maxAnisotropy = gpuProps.limits.maxSamplerAnisotropy;
+}
+
+VkSampler SamplerCache::get(const VkSamplerCreateInfo& createInfo)
+{
+	assert(m_initialized);
+	assert(createInfo.pNext == nullptr);
+	if (auto it = m_samplers.find(createInfo); it != m_samplers.end())
+		return it->second;
+
+	auto sampler = VkSampler{};
+	if (vkCreateSampler(m_device->getDevice(), &createInfo, nullptr, &sampler) != VK_SUCCESS)
+		throw std::runtime_error{ "failed to create sampler" };
+	m_samplers.emplace(createInfo, sampler);
+	return sampler;
+}
+
+float SamplerCache::getMaxAnisotropy()
+{
+	assert(m_initialized);
+	return m_maxAnisotropy;
+}
+
+uint32_t SamplerCache::getSamplerCount()
+{
+	assert(m_initialized);
+	return static_cast<uint32_t>(m_samplers.size());
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+class Device;
+
+// Samplers are deduplicated by their create info. Every texture asks the cache instead of owning one,
+// so the handful of distinct configurations stays far below maxSamplerAllocationCount
+class SamplerCache
+{
+public:
+	// Linear filtering with repeat addressing and full anisotropy, the configuration most textures use
+	static VkSamplerCreateInfo getDefaultInfo();
+
+	~SamplerCache();
+	void init();
+	void destroy();
+
+	VkSampler get(const VkSamplerCreateInfo& createInfo);
+	float getMaxAnisotropy();
+	uint32_t getSamplerCount();
+
+private:
+	struct Hash
+	{
+		size_t operator()(const VkSamplerCreateInfo& info) const;
+	};
+
+	struct Equal
+	{
+		bool operator()(const VkSamplerCreateInfo& a, const VkSamplerCreateInfo& b) const;
+	};
+
+private:
+	bool m_initialized = false;
+	Device* m_device{};
+	float m_maxAnisotropy{};
+	std::unordered_map<VkSamplerCreateInfo, VkSampler, Hash, Equal> m_samplers{};
+};
\ No newline at end of file
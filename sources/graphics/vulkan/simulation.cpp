@@ -0,0 +1,221 @@
+#include "graphics/vulkan/simulation.hpp"
+#include "core/profiler.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <random>
+#include <ranges>
+#include <utility>
+
+namespace
+{
+	// Angles are in degrees, blending the shorter way around keeps a wrap between two packets from spinning
+	float mixAngle(float from, float to, float alpha)
+	{
+		return from + std::remainder(to - from, 360.0f) * alpha;
+	}
+
+	glm::vec3 mixAngles(const glm::vec3& from, const glm::vec3& to, float alpha)
+	{
+		return { mixAngle(from.x, to.x, alpha), mixAngle(from.y, to.y, alpha), mixAngle(from.z, to.z, alpha) };
+	}
+}
+
+Simulation::~Simulation()
+{
+	destroy();
+}
+
+void Simulation::destroy()
+{
+	if (m_initialized)
+	{
+		{
+			auto lock = std::lock_guard{ m_mutex };
+			m_stopping = true;
+		}
+		m_condition.notify_all();
+		m_thread.join();
+		m_commands.clear();
+		m_previous.reset();
+		m_current.reset();
+	}
+	m_initialized = false;
+}
+
+void Simulation::init()
+{
+	assert(!m_initialized);
+	m_initialized = true;
+	m_stopping = false;
+	m_tick = 0;
+	m_transforms[static_cast<size_t>(EntityId::Object)].position = { 0.0f, 1.0f, 0.0f };
+	m_transforms[static_cast<size_t>(EntityId::Plane)].position = { 0.0f, 0.0f, 0.0f };
+
+	// Renders before the first step see the initial state
+	publish(std::chrono::steady_clock::now());
+	m_thread = std::thread{ &Simulation::run, this };
+}
+
+void Simulation::run()
+{
+	ProfilerThreadName("simulation");
+	auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>{ STEP });
+	auto next = std::chrono::steady_clock::now() + interval;
+	while (true)
+	{
+		{
+			auto lock = std::unique_lock{ m_mutex };
+			if (m_condition.wait_until(lock, next, [this] { return m_stopping; })) return;
+		}
+
+		// Missed steps are replayed back to back, a stall longer than that is dropped instead of sped through
+		auto now = std::chrono::steady_clock::now();
+		for (uint32_t i = 0; i < MAX_CATCH_UP && next <= now; i++)
+		{
+			step();
+			publish(next);
+			next += interval;
+			FrameMarkNamed("simulation");
+		}
+		if (next <= now) next = now + interval;
+	}
+}
+
+void Simulation::step()
+{
+	ZoneScopedN("simulation step");
+	auto move = glm::vec3{};
+	auto look = glm::vec2{};
+	auto commands = std::vector<std::function<void()>>{};
+	{
+		auto lock = std::lock_guard{ m_mutex };
+		move = m_move;
+		look = std::exchange(m_look, {});
+		commands.swap(m_commands);
+	}
+	for (auto& command : commands)
+		command();
+
+	m_camera.rotate(look, STEP);
+	m_camera.move(move, STEP);
+
+	m_tick++;
+	if (m_animateLights)
+	{
+		auto time = m_tick * STEP;
+		for (auto [light, orbit] : std::views::zip(m_localLights, m_localLightOrbits))
+		{
+			auto angle = time * orbit.speed;
+			light.position = orbit.center + glm::vec3{ std::cos(angle), 0.0f, std::sin(angle) } * orbit.radius;
+		}
+	}
+}
+
+void Simulation::publish(std::chrono::steady_clock::time_point timestamp)
+{
+	auto packet = std::make_shared<FramePacket>();
+	packet->tick = m_tick;
+	packet->time = m_tick * STEP;
+	packet->timestamp = timestamp;
+	packet->camera = m_camera.getState();
+	packet->transforms = m_transforms;
+	packet->localLights = m_localLights;
+
+	auto lock = std::lock_guard{ m_mutex };
+	m_previous = m_current ? m_current : packet;
+	m_current = std::move(packet);
+}
+
+// Blends the two newest packets, so what is shown trails the simulation by at most one step
+FramePacket Simulation::getFrame(std::chrono::steady_clock::time_point now)
+{
+	assert(m_initialized);
+	auto previous = std::shared_ptr<const FramePacket>{};
+	auto current = std::shared_ptr<const FramePacket>{};
+	{
+		auto lock = std::lock_guard{ m_mutex };
+		previous = m_previous;
+		current = m_current;
+	}
+
+	auto alpha = std::clamp(std::chrono::duration<float>{ now - current->timestamp }.count() / STEP, 0.0f, 1.0f);
+	auto frame = *current;
+	frame.time = glm::mix(previous->time, current->time, alpha);
+	frame.camera.position = glm::mix(previous->camera.position, current->camera.position, alpha);
+	frame.camera.yaw = mixAngle(previous->camera.yaw, current->camera.yaw, alpha);
+	frame.camera.pitch = glm::mix(previous->camera.pitch, current->camera.pitch, alpha);
+	for (auto [transform, from] : std::views::zip(frame.transforms, previous->transforms))
+	{
+		transform.position = glm::mix(from.position, transform.position, alpha);
+		transform.rotation = mixAngles(from.rotation, transform.rotation, alpha);
+		transform.scale = glm::mix(from.scale, transform.scale, alpha);
+	}
+	// Regenerated lights have nothing to blend from
+	if (previous->localLights.size() == frame.localLights.size())
+	{
+		for (auto [light, from] : std::views::zip(frame.localLights, previous->localLights))
+			light.position = glm::mix(from.position, light.position, alpha);
+	}
+	return frame;
+}
+
+uint64_t Simulation::getTick()
+{
+	assert(m_initialized);
+	auto lock = std::lock_guard{ m_mutex };
+	return m_current->tick;
+}
+
+// Movement is held until the next input replaces it, look deltas add up until a step consumes them
+void Simulation::addInput(glm::vec3 move, glm::vec2 look)
+{
+	assert(m_initialized);
+	auto lock = std::lock_guard{ m_mutex };
+	m_move = move;
+	m_look += look;
+}
+
+void Simulation::setTransform(EntityId id, const Transform& transform)
+{
+	assert(m_initialized);
+	auto lock = std::lock_guard{ m_mutex };
+	m_commands.push_back([this, id, transform] { m_transforms[static_cast<size_t>(id)] = transform; });
+}
+
+void Simulation::setLocalLights(uint32_t count, float range, float intensity)
+{
+	assert(m_initialized);
+	auto lock = std::lock_guard{ m_mutex };
+	m_commands.push_back([this, count, range, intensity] { createLocalLights(count, range, intensity); });
+}
+
+void Simulation::setAnimateLights(bool animate)
+{
+	assert(m_initialized);
+	auto lock = std::lock_guard{ m_mutex };
+	m_commands.push_back([this, animate] { m_animateLights = animate; });
+}
+
+void Simulation::createLocalLights(uint32_t count, float range, float intensity)
+{
+	// Deterministic so the stress scene looks the same between runs
+	auto random = std::mt19937{ 1337 };
+	auto uniform = [&](float min, float max) { return std::uniform_real_distribution<float>{ min, max }(random); };
+
+	m_localLights.resize(count);
+	m_localLightOrbits.resize(count);
+	for (auto [light, orbit] : std::views::zip(m_localLights, m_localLightOrbits))
+	{
+		light.position = { uniform(-10.0f, 10.0f), uniform(0.1f, 2.5f), uniform(-10.0f, 10.0f) };
+		light.range = range * uniform(0.5f, 1.0f);
+		light.color = glm::vec3{ uniform(0.1f, 1.0f), uniform(0.1f, 1.0f), uniform(0.1f, 1.0f) } * intensity;
+		light.direction = { 0.0f, -1.0f, 0.0f };
+		// Every fourth light is a spot pointing down
+		auto spot = random() % 4 == 0;
+		light.spotCosOuter = spot ? std::cos(glm::radians(35.0f)) : -1.0f;
+		light.spotCosInner = spot ? std::cos(glm::radians(25.0f)) : -1.0f;
+		orbit = { light.position, uniform(0.2f, 1.0f), uniform(-2.0f, 2.0f) };
+	}
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "graphics/vulkan/types.hpp"
+#include "graphics/vulkan/camera.hpp"
+#include "core/profiler.hpp"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Slots of the simulated objects in a frame packet
+enum class EntityId : uint32_t
+{
+	Object,
+	Plane,
+	Count
+};
+
+struct Transform
+{
+	glm::vec3 position{};
+	glm::vec3 rotation{};
+	glm::vec3 scale{ 1.0f };
+};
+
+// Result of one simulation step, never written again once published so the render thread reads it without locks
+struct FramePacket
+{
+	uint64_t tick;
+	float time;
+	std::chrono::steady_clock::time_point timestamp;
+	CameraState camera;
+	std::array<Transform, static_cast<size_t>(EntityId::Count)> transforms;
+	std::vector<LocalLight> localLights;
+};
+
+// Advances the scene at a fixed rate on its own thread, a slow render frame only changes how far apart
+// the packets it interpolates between are
+class Simulation
+{
+public:
+	static constexpr float STEP = 1.0f / 60.0f;
+	static constexpr uint32_t MAX_CATCH_UP = 5;
+
+	~Simulation();
+	void init();
+	void destroy();
+
+	void addInput(glm::vec3 move, glm::vec2 look);
+	void setTransform(EntityId id, const Transform& transform);
+	void setLocalLights(uint32_t count, float range, float intensity);
+	void setAnimateLights(bool animate);
+	FramePacket getFrame(std::chrono::steady_clock::time_point now);
+	uint64_t getTick();
+
+private:
+	// Stress scene lights circle around where they were spawned
+	struct LightOrbit
+	{
+		glm::vec3 center;
+		float radius;
+		float speed;
+	};
+
+	void run();
+	void step();
+	void publish(std::chrono::steady_clock::time_point timestamp);
+	void createLocalLights(uint32_t count, float range, float intensity);
+
+private:
+	bool m_initialized = false;
+	std::thread m_thread{};
+	TracyLockableN(std::mutex, m_mutex, "simulation");
+	std::condition_variable_any m_condition{};
+	bool m_stopping = false;
+
+	// Written by the render thread, taken by the next step
+	glm::vec3 m_move{};
+	glm::vec2 m_look{};
+	std::vector<std::function<void()>> m_commands{};
+
+	std::shared_ptr<const FramePacket> m_previous{};
+	std::shared_ptr<const FramePacket> m_current{};
+
+	// Owned by the simulation thread once it started
+	Camera m_camera{};
+	std::array<Transform, static_cast<size_t>(EntityId::Count)> m_transforms{};
+	std::vector<LocalLight> m_localLights{};
+	std::vector<LightOrbit> m_localLightOrbits{};
+	bool m_animateLights = true;
+	uint64_t m_tick{};
+};
\ No newline at end of file
@@ -0,0 +1,268 @@
+#include "graphics/vulkan/software_occlusion.hpp"
+#include "graphics/vulkan/locator.hpp"
+#include "core/profiler.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define OCCLUSION_SSE2
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+
+SoftwareOcclusion::~SoftwareOcclusion()
+{
+	destroy();
+}
+
+void SoftwareOcclusion::destroy()
+{
+	if (m_initialized)
+	{
+		wait();
+	}
+	m_initialized = false;
+}
+
+void SoftwareOcclusion::init()
+{
+	assert(!m_initialized);
+	m_initialized = true;
+	m_jobSystem = &Locator::getJobSystem();
+	m_depth.assign(WIDTH * HEIGHT, 1.0f);
+}
+
+// The spans in occluders have to stay valid until wait returned
+void SoftwareOcclusion::begin(const glm::mat4& viewProj, std::vector<Occluder> occluders, std::vector<Bounds> occludees)
+{
+	assert(m_initialized);
+	wait();
+	m_viewProj = viewProj;
+	m_occluders = std::move(occluders);
+	m_occludees = std::move(occludees);
+	m_visible.assign(m_occludees.size(), 1);
+
+	m_vertexOffsets.clear();
+	auto vertexCount = uint32_t{};
+	for (auto& occluder : m_occluders)
+	{
+		m_vertexOffsets.push_back(vertexCount);
+		vertexCount += static_cast<uint32_t>(occluder.positions.size());
+	}
+	m_vertices.resize(vertexCount);
+
+	m_start = std::chrono::high_resolution_clock::now();
+	m_jobSystem->run([this] { work(); }, &m_counter);
+}
+
+// Runs jobs while waiting, the calling thread may end up doing part of the rasterization itself
+void SoftwareOcclusion::wait()
+{
+	assert(m_initialized);
+	m_jobSystem->wait(m_counter);
+}
+
+// Only meaningful after wait, anything begin did not know about is drawn
+bool SoftwareOcclusion::isVisible(uint32_t occludee)
+{
+	assert(m_initialized);
+	return occludee >= m_visible.size() || m_visible[occludee];
+}
+
+const SoftwareOcclusionStats& SoftwareOcclusion::getStats()
+{
+	assert(m_initialized);
+	return m_stats;
+}
+
+// Each parallelFor returns once its phase is done everywhere, which is all the ordering the phases need
+void SoftwareOcclusion::work()
+{
+	auto vertexCount = static_cast<uint32_t>(m_vertices.size());
+	m_jobSystem->parallelFor((vertexCount + VERTEX_GRAIN - 1) / VERTEX_GRAIN, 1, [this, vertexCount](size_t chunk) {
+		auto first = static_cast<uint32_t>(chunk) * VERTEX_GRAIN;
+		transform(first, std::min(first + VERTEX_GRAIN, vertexCount));
+	});
+	m_jobSystem->parallelFor(BANDS, 1, [this](size_t band) {
+		rasterize(static_cast<uint32_t>(band));
+	});
+	auto occludeeCount = static_cast<uint32_t>(m_occludees.size());
+	m_jobSystem->parallelFor((occludeeCount + OCCLUDEE_GRAIN - 1) / OCCLUDEE_GRAIN, 1, [this, occludeeCount](size_t chunk) {
+		auto first = static_cast<uint32_t>(chunk) * OCCLUDEE_GRAIN;
+		test(first, std::min(first + OCCLUDEE_GRAIN, occludeeCount));
+	});
+
+	auto triangles = uint32_t{};
+	for (auto& occluder : m_occluders)
+		triangles += static_cast<uint32_t>(occluder.indices.size() / 3);
+	m_stats.tested = occludeeCount;
+	m_stats.culled = static_cast<uint32_t>(std::count(m_visible.begin(), m_visible.end(), uint8_t{ 0 }));
+	m_stats.triangles = triangles;
+	m_stats.time = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - m_start).count();
+}
+
+void SoftwareOcclusion::transform(uint32_t first, uint32_t last)
+{
+	ZoneScopedN("occluder transform");
+	for (size_t i = 0; i < m_occluders.size(); i++)
+	{
+		auto& occluder = m_occluders[i];
+		auto offset = m_vertexOffsets[i];
+		auto begin = std::max(first, offset);
+		auto end = std::min(last, offset + static_cast<uint32_t>(occluder.positions.size()));
+		if (begin >= end) continue;
+
+		auto matrix = m_viewProj * occluder.transform;
+		for (auto v = begin; v < end; v++)
+		{
+			auto clip = matrix * glm::vec4{ occluder.positions[v - offset], 1.0f };
+			auto& vertex = m_vertices[v];
+			vertex.clipped = clip.w <= FLT_EPSILON;
+			if (vertex.clipped) continue;
+			auto ndc = glm::vec3{ clip } / clip.w;
+			vertex.position = { (ndc.x * 0.5f + 0.5f) * WIDTH, (ndc.y * 0.5f + 0.5f) * HEIGHT, ndc.z };
+		}
+	}
+}
+
+void SoftwareOcclusion::rasterize(uint32_t band)
+{
+	ZoneScopedN("occluder raster");
+	auto firstRow = HEIGHT * band / BANDS;
+	auto lastRow = HEIGHT * (band + 1) / BANDS;
+	std::fill(m_depth.begin() + firstRow * WIDTH, m_depth.begin() + lastRow * WIDTH, 1.0f);
+
+	for (size_t i = 0; i < m_occluders.size(); i++)
+	{
+		auto& indices = m_occluders[i].indices;
+		auto* vertices = m_vertices.data() + m_vertexOffsets[i];
+		for (size_t t = 0; t + 2 < indices.size(); t += 3)
+			rasterizeTriangle(vertices[indices[t]], vertices[indices[t + 1]], vertices[indices[t + 2]], firstRow, lastRow);
+	}
+}
+
+// Triangles crossing the eye plane are dropped and the farthest vertex depth is written flat,
+// both only ever make the buffer farther than the real occluder so nothing visible gets culled
+void SoftwareOcclusion::rasterizeTriangle(const ScreenVertex& v0, const ScreenVertex& v1, const ScreenVertex& v2, uint32_t firstRow, uint32_t lastRow)
+{
+	if (v0.clipped || v1.clipped || v2.clipped) return;
+	auto a = glm::vec2{ v0.position };
+	auto b = glm::vec2{ v1.position };
+	auto c = glm::vec2{ v2.position };
+	auto area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+	if (area == 0.0f) return;
+	if (area < 0.0f) std::swap(b, c);
+
+	auto minX = static_cast<int32_t>(std::floor(std::min({ a.x, b.x, c.x })));
+	auto maxX = static_cast<int32_t>(std::ceil(std::max({ a.x, b.x, c.x })));
+	auto minY = static_cast<int32_t>(std::floor(std::min({ a.y, b.y, c.y })));
+	auto maxY = static_cast<int32_t>(std::ceil(std::max({ a.y, b.y, c.y })));
+	minX = std::max(minX, 0) & ~3;
+	maxX = std::min(maxX, static_cast<int32_t>(WIDTH));
+	minY = std::max(minY, static_cast<int32_t>(firstRow));
+	maxY = std::min(maxY, static_cast<int32_t>(lastRow));
+	if (minX >= maxX || minY >= maxY) return;
+
+	// Edge functions as e = A * x + B * y + C, positive on the inner side of each edge
+	const glm::vec2 from[] = { a, b, c };
+	const glm::vec2 to[] = { b, c, a };
+	float edgeA[3], edgeB[3], edgeC[3];
+	for (uint32_t e = 0; e < 3; e++)
+	{
+		edgeA[e] = from[e].y - to[e].y;
+		edgeB[e] = to[e].x - from[e].x;
+		edgeC[e] = -(edgeA[e] * from[e].x + edgeB[e] * from[e].y);
+	}
+	auto depth = std::max({ v0.position.z, v1.position.z, v2.position.z });
+
+#ifdef OCCLUSION_SSE2
+	auto zero = _mm_setzero_ps();
+	auto depth4 = _mm_set1_ps(depth);
+	auto offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+	__m128 a4[3];
+	for (uint32_t e = 0; e < 3; e++)
+		a4[e] = _mm_set1_ps(edgeA[e]);
+
+	for (auto y = minY; y < maxY; y++)
+	{
+		auto py = static_cast<float>(y) + 0.5f;
+		__m128 row[3];
+		for (uint32_t e = 0; e < 3; e++)
+			row[e] = _mm_set1_ps(edgeB[e] * py + edgeC[e]);
+
+		auto* line = m_depth.data() + y * WIDTH;
+		for (auto x = minX; x < maxX; x += 4)
+		{
+			auto px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), offsets);
+			auto inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a4[0], px), row[0]), zero);
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a4[1], px), row[1]), zero));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a4[2], px), row[2]), zero));
+			if (_mm_movemask_ps(inside) == 0) continue;
+
+			auto current = _mm_loadu_ps(line + x);
+			auto nearest = _mm_min_ps(current, depth4);
+			_mm_storeu_ps(line + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current)));
+		}
+	}
+#else
+	for (auto y = minY; y < maxY; y++)
+	{
+		auto py = static_cast<float>(y) + 0.5f;
+		auto* line = m_depth.data() + y * WIDTH;
+		for (auto x = minX; x < maxX; x++)
+		{
+			auto px = static_cast<float>(x) + 0.5f;
+			auto inside = true;
+			for (uint32_t e = 0; e < 3; e++)
+				inside = inside && edgeA[e] * px + edgeB[e] * py + edgeC[e] >= 0.0f;
+			if (inside) line[x] = std::min(line[x], depth);
+		}
+	}
+#endif
+}
+
+void SoftwareOcclusion::test(uint32_t first, uint32_t last)
+{
+	ZoneScopedN("occludee test");
+	for (auto i = first; i < last; i++)
+		m_visible[i] = testBounds(m_occludees[i]);
+}
+
+// A box is visible when its nearest corner is in front of the buffer anywhere inside its screen rectangle
+bool SoftwareOcclusion::testBounds(const Bounds& bounds)
+{
+	auto min = glm::vec3{ FLT_MAX };
+	auto max = glm::vec3{ -FLT_MAX };
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		auto corner = glm::vec3{ i & 1 ? bounds.max.x : bounds.min.x, i & 2 ? bounds.max.y : bounds.min.y, i & 4 ? bounds.max.z : bounds.min.z };
+		auto clip = m_viewProj * glm::vec4{ corner, 1.0f };
+		if (clip.w <= FLT_EPSILON) return true;
+		auto ndc = glm::vec3{ clip } / clip.w;
+		auto screen = glm::vec3{ (ndc.x * 0.5f + 0.5f) * WIDTH, (ndc.y * 0.5f + 0.5f) * HEIGHT, ndc.z };
+		min = glm::min(min, screen);
+		max = glm::max(max, screen);
+	}
+
+	auto minX = std::max(static_cast<int32_t>(std::floor(min.x)), 0) & ~3;
+	auto maxX = std::min(static_cast<int32_t>(std::ceil(max.x)), static_cast<int32_t>(WIDTH));
+	auto minY = std::max(static_cast<int32_t>(std::floor(min.y)), 0);
+	auto maxY = std::min(static_cast<int32_t>(std::ceil(max.y)), static_cast<int32_t>(HEIGHT));
+	if (minX >= maxX || minY >= maxY) return false;
+
+	for (auto y = minY; y < maxY; y++)
+	{
+		auto* line = m_depth.data() + y * WIDTH;
+#ifdef OCCLUSION_SSE2
+		auto nearest = _mm_set1_ps(min.z);
+		for (auto x = minX; x < maxX; x += 4)
+			if (_mm_movemask_ps(_mm_cmple_ps(nearest, _mm_loadu_ps(line + x))) != 0) return true;
+#else
+		for (auto x = minX; x < maxX; x++)
+			if (min.z <= line[x]) return true;
+#endif
+	}
+	return false;
+}
\ No newline at end of file
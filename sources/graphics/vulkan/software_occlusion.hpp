@@ -0,0 +1,77 @@
+#pragma once
+
+#include "assets/mesh_data.hpp"
+#include "core/job_system.hpp"
+
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <span>
+#include <vector>
+
+// Triangles in the normalized bounds space of a mesh, placed by the same vertex matrix the gpu uses
+struct Occluder
+{
+	std::span<const glm::vec3> positions;
+	std::span<const uint32_t> indices;
+	glm::mat4 transform;
+};
+
+struct SoftwareOcclusionStats
+{
+	uint32_t tested;
+	uint32_t culled;
+	uint32_t triangles;
+	float time;
+};
+
+// Rasterizes a few occluders into a small depth buffer on the job system while the render thread keeps
+// recording, then tests world space boxes against it so hidden objects never reach the command buffer
+class SoftwareOcclusion
+{
+public:
+	static constexpr uint32_t WIDTH = 256;
+	static constexpr uint32_t HEIGHT = 128;
+	// Each raster job owns a band of rows, more than a handful of bands only adds synchronization
+	static constexpr uint32_t BANDS = 4;
+	static constexpr uint32_t VERTEX_GRAIN = 1024;
+	static constexpr uint32_t OCCLUDEE_GRAIN = 64;
+
+	~SoftwareOcclusion();
+	void init();
+	void destroy();
+
+	void begin(const glm::mat4& viewProj, std::vector<Occluder> occluders, std::vector<Bounds> occludees);
+	void wait();
+	bool isVisible(uint32_t occludee);
+	const SoftwareOcclusionStats& getStats();
+
+private:
+	struct ScreenVertex
+	{
+		glm::vec3 position;
+		bool clipped;
+	};
+
+	void work();
+	void transform(uint32_t first, uint32_t last);
+	void rasterize(uint32_t band);
+	void test(uint32_t first, uint32_t last);
+	void rasterizeTriangle(const ScreenVertex& v0, const ScreenVertex& v1, const ScreenVertex& v2, uint32_t firstRow, uint32_t lastRow);
+	bool testBounds(const Bounds& bounds);
+
+private:
+	bool m_initialized = false;
+	JobSystem* m_jobSystem{};
+	JobCounter m_counter{};
+
+	glm::mat4 m_viewProj{ 1.0f };
+	std::vector<Occluder> m_occluders{};
+	std::vector<uint32_t> m_vertexOffsets{};
+	std::vector<ScreenVertex> m_vertices{};
+	std::vector<Bounds> m_occludees{};
+	std::vector<uint8_t> m_visible{};
+	std::vector<float> m_depth{};
+	std::chrono::high_resolution_clock::time_point m_start{};
+	SoftwareOcclusionStats m_stats{};
+};
\ No newline at end of file
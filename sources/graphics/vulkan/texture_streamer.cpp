@@ -0,0 +1,134 @@
+#include "graphics/vulkan/texture_streamer.hpp"
+#include "graphics/vulkan/image/image_texture.hpp"
+#include "graphics/vulkan/locator.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+uint32_t TextureStreamer::getTailLevel(uint32_t width, uint32_t height, uint32_t levelCount)
+{
+	auto level = uint32_t{};
+	while (level + 1 < levelCount && std::max(width >> level, height >> level) > TAIL_SIZE)
+		level++;
+	return level;
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	destroy();
+}
+
+void TextureStreamer::destroy()
+{
+	if (m_initialized)
+	{
+		m_entries.clear();
+	}
+	m_initialized = false;
+}
+
+void TextureStreamer::init(VkDeviceSize budget)
+{
+	assert(!m_initialized);
+	m_initialized = true;
+	m_budget = budget;
+	m_frame = 0;
+	m_stats = {};
+	Locator::setTextureStreamer(this);
+}
+
+void TextureStreamer::add(ImageTexture& texture)
+{
+	assert(m_initialized);
+	m_entries[&texture] = Entry{ texture.getResidentLevel(), m_frame, false };
+}
+
+void TextureStreamer::remove(ImageTexture& texture)
+{
+	assert(m_initialized);
+	m_entries.erase(&texture);
+}
+
+// screenSize is how many pixels the texture's full extent covers, one texel per pixel needs no finer level
+void TextureStreamer::request(ImageTexture& texture, float screenSize)
+{
+	assert(m_initialized);
+	auto it = m_entries.find(&texture);
+	if (it == m_entries.end()) return;
+
+	auto& entry = it->second;
+	auto texelsPerPixel = static_cast<float>(texture.getSize()) / std::max(screenSize, 1.0f);
+	auto level = static_cast<uint32_t>(std::clamp(std::floor(std::log2(std::max(texelsPerPixel, 1.0f))), 0.0f, static_cast<float>(texture.getLevelCount() - 1)));
+	entry.requestedLevel = entry.requested ? std::min(entry.requestedLevel, level) : level;
+	entry.requested = true;
+	entry.lastUsed = m_frame;
+}
+
+void TextureStreamer::update()
+{
+	assert(m_initialized);
+	m_frame++;
+	m_stats.misses = 0;
+	m_stats.textureCount = static_cast<uint32_t>(m_entries.size());
+
+	// Every texture keeps its tail, the remaining budget goes to the most recently drawn ones first
+	auto textures = std::vector<std::pair<ImageTexture*, Entry*>>{};
+	auto available = static_cast<int64_t>(m_budget);
+	for (auto& [texture, entry] : m_entries)
+	{
+		if (entry.requested && entry.requestedLevel < texture->getResidentLevel())
+			m_stats.misses++;
+		available -= texture->getLevelsSize(texture->getTailLevel());
+		textures.emplace_back(texture, &entry);
+	}
+	m_stats.totalMisses += m_stats.misses;
+	std::sort(textures.begin(), textures.end(), [](auto& a, auto& b) { return a.second->lastUsed > b.second->lastUsed; });
+
+	auto streamIns = uint32_t{};
+	m_stats.residentBytes = 0;
+	for (auto [texture, entry] : textures)
+	{
+		auto tail = texture->getTailLevel();
+		auto target = entry->requested ? std::min(entry->requestedLevel, tail) : std::min(texture->getResidentLevel(), tail);
+		while (target < tail && static_cast<int64_t>(texture->getLevelsSize(target) - texture->getLevelsSize(tail)) > available)
+			target++;
+		available -= texture->getLevelsSize(target) - texture->getLevelsSize(tail);
+		entry->requested = false;
+
+		auto resident = texture->getResidentLevel();
+		m_stats.residentBytes += texture->getLevelsSize(resident);
+		if (texture->isStreaming() || target == resident)
+			continue;
+		if (target > resident)
+		{
+			m_stats.evictedLevels += target - resident;
+			texture->streamLevels(target);
+		}
+		else if (streamIns < MAX_STREAM_INS)
+		{
+			m_stats.streamedLevels += resident - target;
+			texture->streamLevels(target);
+			streamIns++;
+		}
+	}
+}
+
+void TextureStreamer::setBudget(VkDeviceSize budget)
+{
+	assert(m_initialized);
+	m_budget = budget;
+}
+
+VkDeviceSize TextureStreamer::getBudget()
+{
+	assert(m_initialized);
+	return m_budget;
+}
+
+const StreamingStats& TextureStreamer::getStats()
+{
+	assert(m_initialized);
+	return m_stats;
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <unordered_map>
+
+class ImageTexture;
+
+struct StreamingStats
+{
+	VkDeviceSize residentBytes;
+	uint32_t textureCount;
+	uint32_t misses; // textures drawn this frame coarser than their screen size asked for
+	uint64_t totalMisses;
+	uint64_t streamedLevels;
+	uint64_t evictedLevels;
+};
+
+// Keeps cooked textures resident from their mip tail up to what their screen size asks for. When the wanted levels
+// do not fit the budget, the least recently drawn textures are coarsened first
+class TextureStreamer
+{
+public:
+	static constexpr uint32_t TAIL_SIZE = 64; // levels this size and smaller stay resident
+	static constexpr uint32_t MAX_STREAM_INS = 2; // finer residency requests issued per update
+
+	static uint32_t getTailLevel(uint32_t width, uint32_t height, uint32_t levelCount);
+
+	~TextureStreamer();
+	void init(VkDeviceSize budget);
+	void destroy();
+
+	void add(ImageTexture& texture);
+	void remove(ImageTexture& texture);
+	void request(ImageTexture& texture, float screenSize);
+	void update();
+
+	void setBudget(VkDeviceSize budget);
+	VkDeviceSize getBudget();
+	const StreamingStats& getStats();
+
+private:
+	struct Entry
+	{
+		uint32_t requestedLevel;
+		uint64_t lastUsed;
+		bool requested;
+	};
+
+private:
+	bool m_initialized = false;
+	VkDeviceSize m_budget{};
+	uint64_t m_frame{};
+	StreamingStats m_stats{};
+	std::unordered_map<ImageTexture*, Entry> m_entries{};
+};
\ No newline at end of file
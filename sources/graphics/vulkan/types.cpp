@@ -1,37 +1,42 @@
 #include "graphics/vulkan/types.hpp"
 
-VkVertexInputBindingDescription Vertex::getBindDesc()
+std::vector<VkVertexInputBindingDescription> Vertex::getBindDesc(bool positionOnly)
 {
-	auto bindDesc = VkVertexInputBindingDescription{};
-	bindDesc.binding = 0;
-	bindDesc.stride = sizeof(Vertex);
-	bindDesc.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+	auto bindDesc = std::vector<VkVertexInputBindingDescription>(positionOnly ? 1 : 2);
+	bindDesc[0].binding = Binding::Position;
+	bindDesc[0].stride = sizeof(VertexPosition);
+	bindDesc[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+	if (positionOnly) return bindDesc;
+
+	bindDesc[1].binding = Binding::Attributes;
+	bindDesc[1].stride = sizeof(VertexAttributes);
+	bindDesc[1].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 	return bindDesc;
 }
 
-std::array<VkVertexInputAttributeDescription, 4> Vertex::getAttrDesc()
+std::array<VertexAttribute, 3> Vertex::getAttributes()
 {
-	auto attrDesc = std::array<VkVertexInputAttributeDescription, 4>{};
-
-	attrDesc[0].binding = 0;
-	attrDesc[0].location = 0;
-	attrDesc[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-	attrDesc[0].offset = offsetof(Vertex, pos);
-
-	attrDesc[1].binding = 0;
-	attrDesc[1].location = 1;
-	attrDesc[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-	attrDesc[1].offset = offsetof(Vertex, color);
-
-	attrDesc[2].binding = 0;
-	attrDesc[2].location = 2;
-	attrDesc[2].format = VK_FORMAT_R32G32B32_SFLOAT;
-	attrDesc[2].offset = offsetof(Vertex, normal);
-
-	attrDesc[3].binding = 0;
-    attrDesc[3].location = 3;
-    attrDesc[3].format = VK_FORMAT_R32G32_SFLOAT;
-    attrDesc[3].offset = offsetof(Vertex, texCoord);
+	return
+	{
+		VertexAttribute{ "inPosition", "vec4", Binding::Position, VK_FORMAT_R16G16B16A16_UNORM, offsetof(VertexPosition, pos) },
+		VertexAttribute{ "inNormal", "vec2", Binding::Attributes, VK_FORMAT_R16G16_SNORM, offsetof(VertexAttributes, normal) },
+		VertexAttribute{ "inTexCoord", "vec2", Binding::Attributes, VK_FORMAT_R16G16_SFLOAT, offsetof(VertexAttributes, texCoord) },
+	};
+}
 
+std::vector<VkVertexInputAttributeDescription> Vertex::getAttrDesc(bool positionOnly)
+{
+	auto attrDesc = std::vector<VkVertexInputAttributeDescription>{};
+	auto attributes = getAttributes();
+	for (uint32_t i = 0; i < attributes.size(); i++)
+	{
+		if (positionOnly && attributes[i].binding != Binding::Position) continue;
+		auto desc = VkVertexInputAttributeDescription{};
+		desc.binding = attributes[i].binding;
+		desc.location = i;
+		desc.format = attributes[i].format;
+		desc.offset = attributes[i].offset;
+		attrDesc.push_back(desc);
+	}
 	return attrDesc;
 }
\ No newline at end of file
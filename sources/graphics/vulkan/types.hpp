@@ -1,13 +1,13 @@
 #pragma once
 
 #include <vulkan/vulkan.h>
-#define GLM_ENABLE_EXPERIMENTAL
 #include <glm/glm.hpp>
-#include <glm/gtx/hash.hpp>
+#include <glm/gtc/type_precision.hpp>
 
 #include <functional>
 #include <optional>
 #include <array>
+#include <vector>
 
 struct QueueFamilyIndices
 {
@@ -24,35 +24,64 @@ struct SwapchainSupportDetails
 
 using FindQueueFamilyFunc = std::function<QueueFamilyIndices(VkPhysicalDevice gpu)>;
 
+struct VertexAttribute
+{
+	const char* name;
+	const char* glslType;
+	uint32_t binding;
+	VkFormat format;
+	uint32_t offset;
+};
+
+// Positions are unorm within the mesh bounds and dequantized by the model matrix
+struct VertexPosition
+{
+	glm::u16vec4 pos;
+};
+
+// Normals are octahedral encoded and texture coordinates are half floats
+struct VertexAttributes
+{
+	glm::i16vec2 normal;
+	glm::u16vec2 texCoord;
+};
+
+// Positions live in their own stream so depth only passes fetch nothing else
 struct Vertex
 {
-	glm::vec3 pos;
-	glm::vec3 color;
-	glm::vec3 normal;
-	glm::vec2 texCoord;
-
-	static VkVertexInputBindingDescription getBindDesc();
-	static std::array<VkVertexInputAttributeDescription, 4> getAttrDesc();
-	inline bool operator==(const Vertex& other) const {
-		return pos == other.pos && color == other.color && texCoord == other.texCoord;
-	}
-};
-
-namespace std {
-	template<> struct hash<Vertex> {
-		size_t operator()(Vertex const& vertex) const {
-			return ((hash<glm::vec3>()(vertex.pos) ^
-				(hash<glm::vec3>()(vertex.color) << 1)) >> 1) ^
-				(hash<glm::vec2>()(vertex.texCoord) << 1);
-		}
+	enum Binding : uint32_t
+	{
+		Position,
+		Attributes
 	};
-}
+
+	static std::vector<VkVertexInputBindingDescription> getBindDesc(bool positionOnly = false);
+	static std::array<VertexAttribute, 3> getAttributes();
+	static std::vector<VkVertexInputAttributeDescription> getAttrDesc(bool positionOnly = false);
+};
 
 struct MVP
 {
 	glm::mat4 model;
 	glm::mat4 view;
 	glm::mat4 proj;
+	glm::mat4 prevModel;
+};
+
+struct Temporal
+{
+	glm::mat4 viewProj;
+	glm::mat4 prevViewProj;
+	float mipBias; // negative below native resolution so textures keep the detail of the output
+};
+
+struct TemporalResolve
+{
+	alignas(16) glm::vec4 sceneViewport;
+	alignas(16) glm::vec4 historyViewport;
+	alignas(16) glm::vec2 jitter;
+	float blend;
+	uint32_t reset;
 };
 
 struct Light
@@ -64,6 +93,65 @@ struct Light
 	alignas(16) glm::vec3 specular;
 };
 
+// Point or spot light shaded through the light clusters, std430 layout
+struct LocalLight
+{
+	alignas(16) glm::vec3 position;
+	float range;
+	alignas(16) glm::vec3 color;
+	float spotCosOuter; // -1 makes it a point light
+	alignas(16) glm::vec3 direction;
+	float spotCosInner;
+};
+
+struct DeferredParams
+{
+	glm::mat4 invViewProj;
+	alignas(16) glm::vec4 viewport; // render width and height
+};
+
+struct ClusterParams
+{
+	glm::mat4 view;
+	glm::mat4 invProj;
+	alignas(16) glm::uvec4 grid; // clusters along x, y and z, lights per cluster
+	alignas(16) glm::vec4 screen; // render width and height, near and far planes
+	uint32_t lightCount;
+};
+
+struct HiZLevel
+{
+	alignas(8) glm::uvec2 sourceSize; // texels of the level read, only the render extent for the depth buffer
+	alignas(8) glm::uvec2 levelSize;
+};
+
+// World space bounding sphere and the lod range drawn for one object, std430 layout
+struct CullObject
+{
+	alignas(16) glm::vec3 center;
+	float radius;
+	uint32_t indexCount;
+	uint32_t firstIndex;
+	int32_t vertexOffset;
+	uint32_t padding;
+};
+
+struct CullParams
+{
+	glm::mat4 viewProj;
+	alignas(16) glm::vec4 pyramid; // level 0 width and height, level count, 1 when occlusion is tested
+	uint32_t objectCount;
+	uint32_t phase;
+	uint32_t drawOffset; // first command written by this phase
+};
+
+struct CullStats
+{
+	uint32_t drawn[2]; // by the early and the late phase
+	uint32_t occluded;
+	uint32_t outside;
+};
+
 struct Material 
 {
 	alignas(16) glm::vec3 ambient;
@@ -82,4 +170,6 @@ struct Global
 {
 	alignas(16) float gamma;
 	float exposure;
+	uint32_t upscale;
+	alignas(16) glm::vec4 viewport;
 };
\ No newline at end of file
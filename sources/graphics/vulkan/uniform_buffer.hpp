@@ -4,6 +4,7 @@
 #include "graphics/vulkan/buffer.hpp"
 #include "graphics/vulkan/context/device.hpp"
 #include "graphics/vulkan/locator.hpp"
+#include "graphics/vulkan/command_recorder.hpp"
 
 #include <vulkan/vulkan.h>
 
@@ -22,7 +23,9 @@ public:
 		m_descriptorSet = descriptorSet;
 
 		m_size = sizeof(T);
-		m_buffer.init(m_size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		m_buffer.init(m_size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			MemoryCategory::Buffer, "uniform buffer"
+		);
 		m_bufferMapped = m_buffer.map();
 
 		auto bufferInfo = VkDescriptorBufferInfo{};
@@ -48,11 +51,10 @@ public:
 		memcpy(m_bufferMapped, &data, sizeof(T));
 	}
 
-	void bind(VkCommandBuffer commandBuffer, VkPipelineLayout layout, uint32_t setId)
+	void bind(CommandRecorder& recorder, VkPipelineLayout layout, uint32_t setId)
 	{
 		assert(m_initialized);
-		auto set = m_descriptorSet->getSet();
-		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, setId, 1, &set, 0, nullptr);
+		recorder.bindDescriptorSet(layout, setId, m_descriptorSet->getSet());
 	}
 
 	Buffer& getBuffer()
@@ -1,12 +1,10 @@
 #include "window/window.hpp"
+#include "core/profiler.hpp"
 
 #include <GLFW/glfw3.h>
 
 #include <print>
 
-#define TRACY_ENABLE
-#include <tracy/Tracy.hpp>
-
 int main()
 {
 	try
@@ -18,8 +16,10 @@ int main()
 		while (!window.shouldClose())
 		{
 			ZoneScopedN("main loop");
+			renderer.waitFrame();
 			input.update();
 			renderer.render();
+			FrameMark;
 			if (input.getKey(GLFW_KEY_ESCAPE)) break;
 		}
 	}
@@ -0,0 +1,385 @@
+#include "assets/mesh_file.hpp"
+#include "assets/obj_importer.hpp"
+#include "assets/mesh_optimizer.hpp"
+#include "assets/mesh_simplifier.hpp"
+#include "assets/ktx_file.hpp"
+#include "assets/texture_encoder.hpp"
+#include "core/job_system.hpp"
+#include "graphics/vulkan/types.hpp"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <functional>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <print>
+#include <random>
+#include <ranges>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+static std::string readFile(const std::filesystem::path& path)
+{
+	auto file = std::ifstream{ path, std::ios::binary };
+	if (!file)
+		throw std::runtime_error{ "failed to open " + path.string() };
+	auto stream = std::ostringstream{};
+	stream << file.rdbuf();
+	return stream.str();
+}
+
+static float elapsed(std::chrono::high_resolution_clock::time_point start)
+{
+	return std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static constexpr uint32_t ANALYZE_CACHE_SIZE = 16;
+
+static void cookMesh(const std::filesystem::path& input, const std::filesystem::path& output)
+{
+	auto objSource = readFile(input);
+
+	auto jobs = JobSystem{};
+	jobs.init();
+	auto start = std::chrono::high_resolution_clock::now();
+	auto data = ObjImporter::import(objSource, jobs);
+	auto importTime = elapsed(start);
+
+	start = std::chrono::high_resolution_clock::now();
+	MeshSimplifier::generateLods(data);
+	auto simplifyTime = elapsed(start);
+
+	auto before = MeshOptimizer::analyzeVertexCache(std::span{ data.indices }.first(data.lods[0].indexCount), data.vertices.size(), ANALYZE_CACHE_SIZE);
+	start = std::chrono::high_resolution_clock::now();
+	MeshOptimizer::optimize(data);
+	auto optimizeTime = elapsed(start);
+	auto after = MeshOptimizer::analyzeVertexCache(std::span{ data.indices }.first(data.lods[0].indexCount), data.vertices.size(), ANALYZE_CACHE_SIZE);
+
+	std::filesystem::create_directories(output.parent_path());
+	MeshFile::write(output.string(), data);
+
+	// Read the result back the way the runtime does to validate it and compare load times
+	auto cooked = readFile(output);
+	start = std::chrono::high_resolution_clock::now();
+	auto meshFile = MeshFile{};
+	meshFile.init(cooked);
+	auto staging = std::vector<char>{};
+	for (auto blob : { meshFile.getPositionData(), meshFile.getAttributeData(), meshFile.getIndexData() })
+		staging.insert(staging.end(), blob.begin(), blob.end());
+	auto loadTime = elapsed(start);
+
+	std::println("{}: {} vertices, {} triangles, {} submeshes, {} -> {} bytes",
+		input.filename().string(), data.vertices.size(), data.lods[0].indexCount / 3, data.submeshes.size(), objSource.size(), cooked.size());
+	for (auto [level, lod] : std::views::enumerate(data.lods))
+		std::println("  lod {}: {} triangles, error {:.5f}", level, lod.indexCount / 3, lod.error);
+	std::println("  acmr {:.3f} -> {:.3f}, atvr {:.3f} -> {:.3f}", before.acmr, after.acmr, before.atvr, after.atvr);
+	std::println("  obj import {:.2f} ms, lods {:.2f} ms, optimize {:.2f} ms, cooked load {:.3f} ms", importTime, simplifyTime, optimizeTime, loadTime);
+}
+
+// A regular grid with its triangles shuffled, the worst case input for the post transform cache
+static MeshData generateGrid(uint32_t size)
+{
+	auto data = MeshData{};
+	for (uint32_t y = 0; y <= size; y++)
+		for (uint32_t x = 0; x <= size; x++)
+			data.vertices.push_back({ { static_cast<float>(x), 0.0f, static_cast<float>(y) }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f } });
+
+	auto triangles = std::vector<std::array<uint32_t, 3>>{};
+	for (uint32_t y = 0; y < size; y++)
+	{
+		for (uint32_t x = 0; x < size; x++)
+		{
+			auto corner = y * (size + 1) + x;
+			triangles.push_back({ corner, corner + size + 1, corner + 1 });
+			triangles.push_back({ corner + 1, corner + size + 1, corner + size + 2 });
+		}
+	}
+	std::shuffle(triangles.begin(), triangles.end(), std::mt19937{ 1 });
+	for (auto& triangle : triangles)
+		data.indices.insert(data.indices.end(), triangle.begin(), triangle.end());
+
+	data.bounds = { glm::vec3{ 0.0f }, glm::vec3{ static_cast<float>(size), 0.0f, static_cast<float>(size) } };
+	data.submeshes.push_back({ 0, static_cast<uint32_t>(data.indices.size()), data.bounds });
+	return data;
+}
+
+// The same grid as OBJ text with positions, texture coordinates and normals on every corner
+static std::string generateObj(uint32_t size)
+{
+	auto source = std::string{ "o grid\n" };
+	for (uint32_t y = 0; y <= size; y++)
+		for (uint32_t x = 0; x <= size; x++)
+			source += std::format("v {:.6f} 0.0 {:.6f}\nvt {:.6f} {:.6f}\n", x * 0.01f, y * 0.01f, static_cast<float>(x) / size, static_cast<float>(y) / size);
+	source += "vn 0.0 1.0 0.0\n";
+	for (uint32_t y = 0; y < size; y++)
+	{
+		for (uint32_t x = 0; x < size; x++)
+		{
+			auto corner = y * (size + 1) + x + 1;
+			source += std::format("f {0}/{0}/1 {1}/{1}/1 {2}/{2}/1 {3}/{3}/1\n", corner, corner + size + 1, corner + size + 2, corner + 1);
+		}
+	}
+	return source;
+}
+
+// Overhead of the scheduler itself, every job does close to nothing
+static void benchJobs()
+{
+	constexpr uint32_t jobCount = 1 << 18;
+	auto jobs = JobSystem{};
+	jobs.init();
+	std::println("jobs: {} threads, {} jobs per run", jobs.getThreadCount(), jobCount);
+	auto sink = std::atomic<uint32_t>{};
+	auto report = [&](const char* name, std::chrono::high_resolution_clock::time_point start, JobStats before) {
+		auto time = elapsed(start);
+		auto stats = jobs.getStats();
+		std::println("  {:<12} {:.1f} ms, {:.0f} ns per job, {} stolen", name, time, time * 1e6 / jobCount, stats.stolen - before.stolen);
+	};
+
+	// Spawned from the main thread and drained by the workers stealing from its deque
+	auto before = jobs.getStats();
+	auto start = std::chrono::high_resolution_clock::now();
+	{
+		auto counter = JobCounter{};
+		for (uint32_t i = 0; i < jobCount; i++)
+			jobs.run([&sink] { sink.fetch_add(1, std::memory_order_relaxed); }, &counter);
+		jobs.wait(counter);
+	}
+	report("spawn", start, before);
+
+	// Every job spawns its children on its own deque, so work only spreads by stealing
+	before = jobs.getStats();
+	start = std::chrono::high_resolution_clock::now();
+	{
+		auto counter = JobCounter{};
+		std::function<void(uint32_t)> split = [&](uint32_t count) {
+			if (count == 1)
+			{
+				sink.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			jobs.run([&split, count] { split(count / 2); }, &counter);
+			jobs.run([&split, count] { split(count - count / 2); }, &counter);
+		};
+		jobs.run([&split] { split(jobCount); }, &counter);
+		jobs.wait(counter);
+	}
+	report("steal tree", start, before);
+
+	// A chain where each job waits for the previous one through its counter
+	before = jobs.getStats();
+	start = std::chrono::high_resolution_clock::now();
+	{
+		auto counters = std::make_unique<JobCounter[]>(jobCount);
+		jobs.run([&sink] { sink.fetch_add(1, std::memory_order_relaxed); }, &counters[0]);
+		for (uint32_t i = 1; i < jobCount; i++)
+			jobs.after(counters[i - 1], [&sink] { sink.fetch_add(1, std::memory_order_relaxed); }, &counters[i]);
+		jobs.wait(counters[jobCount - 1]);
+	}
+	report("dependencies", start, before);
+
+	before = jobs.getStats();
+	start = std::chrono::high_resolution_clock::now();
+	jobs.parallelFor(jobCount, 64, [&sink](size_t) { sink.fetch_add(1, std::memory_order_relaxed); });
+	report("parallel for", start, before);
+}
+
+static void benchImport(const std::string& name, const std::string& source)
+{
+	std::println("{}: {:.1f} MB of obj", name, source.size() / 1e6);
+	auto threadCounts = std::vector<uint32_t>{ 1 };
+	for (auto threads = 2u; threads < std::thread::hardware_concurrency(); threads *= 2)
+		threadCounts.push_back(threads);
+	threadCounts.push_back(std::thread::hardware_concurrency());
+	for (auto threads : threadCounts)
+	{
+		auto jobs = JobSystem{};
+		jobs.init(threads);
+		auto start = std::chrono::high_resolution_clock::now();
+		auto data = ObjImporter::import(source, jobs);
+		auto time = elapsed(start);
+		std::println("  {:>2} threads: {:.1f} ms, {:.0f} MB/s, {:.1f} M triangles/s, {} vertices welded from {}",
+			threads, time, source.size() / 1e3 / time, data.indices.size() / 3 / 1e3 / time, data.vertices.size(), data.indices.size());
+	}
+}
+
+// Vertex shader invocations are simulated on FIFO caches of the sizes GPUs roughly dedupe over
+static void benchMesh(const std::string& name, MeshData data)
+{
+	auto report = [&](const char* stage, float time) {
+		std::print("  {:<10}", stage);
+		for (auto cacheSize : { 16u, 32u })
+		{
+			auto stats = MeshOptimizer::analyzeVertexCache(data.indices, data.vertices.size(), cacheSize);
+			std::print(" | fifo {:2}: {:>9} vs invocations, acmr {:.3f}, atvr {:.3f}", cacheSize, stats.vertexInvocations, stats.acmr, stats.atvr);
+		}
+		std::println(" | {:.1f} ms", time);
+	};
+
+	std::println("{}: {} vertices, {} triangles", name, data.vertices.size(), data.indices.size() / 3);
+	report("input", 0.0f);
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (auto& submesh : data.submeshes)
+		MeshOptimizer::optimizeVertexCache(std::span<uint32_t>{ data.indices }.subspan(submesh.indexOffset, submesh.indexCount), data.vertices.size());
+	report("cache", elapsed(start));
+
+	start = std::chrono::high_resolution_clock::now();
+	for (auto& submesh : data.submeshes)
+		MeshOptimizer::optimizeOverdraw(std::span<uint32_t>{ data.indices }.subspan(submesh.indexOffset, submesh.indexCount), data.vertices, MeshOptimizer::OVERDRAW_THRESHOLD);
+	report("overdraw", elapsed(start));
+
+	start = std::chrono::high_resolution_clock::now();
+	MeshOptimizer::optimizeVertexFetch(data);
+	report("fetch", elapsed(start));
+}
+
+static void cookTexture(const std::filesystem::path& input, const std::filesystem::path& output, const std::string& formatName)
+{
+	static const std::map<std::string, VkFormat> formats = {
+		{ "bc7", VK_FORMAT_BC7_SRGB_BLOCK },
+		{ "bc7_linear", VK_FORMAT_BC7_UNORM_BLOCK },
+		{ "bc5", VK_FORMAT_BC5_UNORM_BLOCK },
+		{ "bc1", VK_FORMAT_BC1_RGB_SRGB_BLOCK },
+		{ "bc1_linear", VK_FORMAT_BC1_RGB_UNORM_BLOCK },
+		{ "rgba8", VK_FORMAT_R8G8B8A8_SRGB },
+		{ "rgba8_linear", VK_FORMAT_R8G8B8A8_UNORM },
+	};
+	auto format = formats.find(formatName);
+	if (format == formats.end())
+		throw std::runtime_error{ "unknown texture format " + formatName };
+	auto srgb = format->second == VK_FORMAT_BC7_SRGB_BLOCK || format->second == VK_FORMAT_BC1_RGB_SRGB_BLOCK || format->second == VK_FORMAT_R8G8B8A8_SRGB;
+
+	auto source = readFile(input);
+	auto start = std::chrono::high_resolution_clock::now();
+	int width, height, channels;
+	auto* pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(source.data()), static_cast<int>(source.size()), &width, &height, &channels, STBI_rgb_alpha);
+	if (pixels == nullptr)
+		throw std::runtime_error{ "failed to load image " + input.string() };
+	auto image = ImageData{ static_cast<uint32_t>(width), static_cast<uint32_t>(height), std::vector<uint8_t>(pixels, pixels + width * height * 4) };
+	stbi_image_free(pixels);
+	auto decodeTime = elapsed(start);
+
+	start = std::chrono::high_resolution_clock::now();
+	auto mips = TextureEncoder::generateMips(image, srgb);
+	auto data = TextureEncoder::encode(mips, format->second);
+	auto encodeTime = elapsed(start);
+
+	std::filesystem::create_directories(output.parent_path());
+	KtxFile::write(output.string(), data);
+
+	auto rgbaSize = size_t{};
+	for (auto& mip : mips) rgbaSize += mip.pixels.size();
+	auto encodedSize = size_t{};
+	for (auto& level : data.levels) encodedSize += level.size();
+	std::println("{}: {}x{} {}, {} mips, {} -> {} bytes in vram",
+		input.filename().string(), width, height, formatName, data.levels.size(), rgbaSize, encodedSize);
+	std::println("  decode {:.2f} ms, mips and encode {:.2f} ms", decodeTime, encodeTime);
+}
+
+static void generateVertexGlsl(const std::filesystem::path& output)
+{
+	// Depth only shaders define VERTEX_POSITION_ONLY to match pipelines that bind just the position stream
+	auto source = std::string{ "// Generated by vk_cooker from Vertex::getAttributes, do not edit\n\n" };
+	auto attributes = std::string{};
+	for (auto [location, attribute] : std::views::enumerate(Vertex::getAttributes()))
+	{
+		auto& target = attribute.binding == Vertex::Binding::Position ? source : attributes;
+		target += std::format("layout(location = {}) in {} {};\n", location, attribute.glslType, attribute.name);
+	}
+
+	source += R"(
+vec3 decodePosition()
+{
+    return inPosition.xyz;
+}
+
+#ifndef VERTEX_POSITION_ONLY
+)";
+	source += attributes;
+	source += R"(
+
+vec3 decodeNormal()
+{
+    vec3 normal = vec3(inNormal, 1.0 - abs(inNormal.x) - abs(inNormal.y));
+    float fold = max(-normal.z, 0.0);
+    normal.x += normal.x >= 0.0 ? -fold : fold;
+    normal.y += normal.y >= 0.0 ? -fold : fold;
+    return normalize(normal);
+}
+
+vec2 decodeTexCoord()
+{
+    return inTexCoord;
+}
+#endif
+)";
+
+	// Keep the timestamp when nothing changed so shaders are not rebuilt for every cooker rebuild
+	if (std::filesystem::exists(output) && readFile(output) == source) return;
+	std::filesystem::create_directories(output.parent_path());
+	auto file = std::ofstream{ output, std::ios::binary | std::ios::trunc };
+	if (!file.write(source.data(), source.size()))
+		throw std::runtime_error{ "failed to write " + output.string() };
+}
+
+int main(int argc, char** argv)
+{
+	auto args = std::vector<std::string>(argv + 1, argv + argc);
+	try
+	{
+		if (args.size() == 3 && args[0] == "mesh")
+		{
+			cookMesh(args[1], args[2]);
+			return 0;
+		}
+		if (!args.empty() && args[0] == "bench")
+		{
+			benchJobs();
+			benchImport("generated grid", generateObj(1536));
+			benchMesh("shuffled grid", generateGrid(1024));
+			auto jobs = JobSystem{};
+			jobs.init();
+			for (auto& input : std::span{ args }.subspan(1))
+			{
+				auto name = std::filesystem::path{ input }.filename().string();
+				auto source = readFile(input);
+				benchImport(name, source);
+				benchMesh(name, ObjImporter::import(source, jobs));
+			}
+			return 0;
+		}
+		if (args.size() == 2 && args[0] == "glsl")
+		{
+			generateVertexGlsl(args[1]);
+			return 0;
+		}
+		if ((args.size() == 3 || args.size() == 4) && args[0] == "texture")
+		{
+			cookTexture(args[1], args[2], args.size() == 4 ? args[3] : "bc7");
+			return 0;
+		}
+		std::println("usage: vk_cooker mesh <input.obj> <output.mesh>");
+		std::println("       vk_cooker texture <input.png> <output.ktx2> [bc7|bc5|bc1|rgba8][_linear]");
+		std::println("       vk_cooker glsl <vertex.glsl>");
+		std::println("       vk_cooker bench [input.obj...]");
+	}
+	catch (std::exception& ex)
+	{
+		std::println("{}", ex.what());
+	}
+	return 1;
+}
\ No newline at end of file
@@ -1,11 +1,9 @@
 #include "window/input.hpp"
 #include "window/window.hpp"
+#include "core/profiler.hpp"
 
 #include <print>
 
-#define TRACY_ENABLE
-#include <tracy/Tracy.hpp>
-
 Input::Input(Window& window) : m_window{ window }, m_keyStates{}
 {
 	auto* gwindow = m_window.getWindow();
@@ -86,4 +84,4 @@ void Input::setCursorPos(glm::dvec2 cursorPos)
 {
 	m_cursorDelta = cursorPos - m_lastCursorPos;
 	m_lastCursorPos = cursorPos;
-}
+}
\ No newline at end of file